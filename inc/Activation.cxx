@@ -0,0 +1,474 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: Activation.cxx                                                      //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  The activation functions used by Neuron and CompiledNetwork. Functions    //
+//  are identified by an enum, so that no strings are compared per call, and  //
+//  the value and derivative are always computed together.                    //
+//                                                                            //
+//  evaluateLayer() processes a whole layer of sums with AVX-512 or AVX2      //
+//  kernels when the CPU supports them, with a scalar fallback. exp(), sin()  //
+//  and cos() are evaluated with the same polynomial algorithms in all of the //
+//  kernels, operation by operation, so a given sum produces bit-identical    //
+//  results whichever kernel (or lane) handles it. Per-event, batched and     //
+//  graph evaluation therefore agree exactly.                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Activation.h"
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define ACTIVATION_X86
+#include <immintrin.h>
+// GCC warns about _mm512_undefined_pd() inside its own min/max intrinsics:
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// exp(x) = 2^n * exp(r), with n = round(x / ln2) and |r| <= ln2 / 2:
+static const double kExpMax = 708.0;
+static const double kLog2E = 1.4426950408889634;
+static const double kLn2Hi = 6.93145751953125e-1;
+static const double kLn2Lo = 1.42860682030941723212e-6;
+static const double kRoundMagic = 6755399441055744.0;// 2^52 + 2^51
+static const int kNExpTerms = 14;
+static const double kExpTerms[kNExpTerms] = {
+  1.0, 1.0, 1.0/2.0, 1.0/6.0, 1.0/24.0, 1.0/120.0, 1.0/720.0, 1.0/5040.0,
+  1.0/40320.0, 1.0/362880.0, 1.0/3628800.0, 1.0/39916800.0,
+  1.0/479001600.0, 1.0/6227020800.0
+};
+
+// sin(y) and cos(y) Taylor series in y^2, for |y| <= pi/2:
+static const double kHalfPi = 1.5707963267948966;
+static const int kNSinTerms = 11;
+static const double kSinTerms[kNSinTerms] = {
+  1.0, -1.0/6.0, 1.0/120.0, -1.0/5040.0, 1.0/362880.0, -1.0/39916800.0,
+  1.0/6227020800.0, -1.0/1307674368000.0, 1.0/355687428096000.0,
+  -1.0/121645100408832000.0, 1.0/51090942171709440000.0
+};
+static const int kNCosTerms = 12;
+static const double kCosTerms[kNCosTerms] = {
+  1.0, -1.0/2.0, 1.0/24.0, -1.0/720.0, 1.0/40320.0, -1.0/3628800.0,
+  1.0/479001600.0, -1.0/87178291200.0, 1.0/20922789888000.0,
+  -1.0/6402373705728000.0, 1.0/2432902008176640000.0,
+  -1.0/1124000727777607680000.0
+};
+
+/**
+   -----------------------------------------------------------------------------
+   Scalar exponential. Mirrors the vector kernels below operation by operation.
+*/
+static inline double expScalar(double x) {
+  x = (x < kExpMax) ? x : kExpMax;
+  x = (x > -kExpMax) ? x : -kExpMax;
+  double t = x * kLog2E + kRoundMagic;
+  double n = t - kRoundMagic;
+  double r = x - n * kLn2Hi;
+  r = r - n * kLn2Lo;
+  double p = kExpTerms[kNExpTerms-1];
+  for (int i_t = kNExpTerms-2; i_t >= 0; i_t--) p = p * r + kExpTerms[i_t];
+  long long tBits, magicBits;
+  memcpy(&tBits, &t, sizeof(double));
+  memcpy(&magicBits, &kRoundMagic, sizeof(double));
+  long long scaleBits = ((tBits - magicBits) + 1023) << 52;
+  double scale;
+  memcpy(&scale, &scaleBits, sizeof(double));
+  return p * scale;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Scalar value and derivative of an activation function.
+*/
+static inline void evaluateScalar(ActivationFunction function, double sum,
+				  double &value, double &derivative) {
+  switch (function) {
+  case kSigmoid: {
+    value = 1.0 / (1.0 + expScalar(-sum));
+    derivative = value * (1.0 - value);
+    break;
+  }
+  case kTanh: {
+    double e = expScalar(sum + sum);
+    value = 1.0 - 2.0 / (e + 1.0);
+    derivative = 1.0 - value * value;
+    break;
+  }
+  case kSine: {
+    double x = (sum < 1.0) ? sum : 1.0;
+    x = (x > -1.0) ? x : -1.0;
+    double y = x * kHalfPi;
+    double y2 = y * y;
+    double s = kSinTerms[kNSinTerms-1];
+    for (int i_t = kNSinTerms-2; i_t >= 0; i_t--) s = s * y2 + kSinTerms[i_t];
+    double c = kCosTerms[kNCosTerms-1];
+    for (int i_t = kNCosTerms-2; i_t >= 0; i_t--) c = c * y2 + kCosTerms[i_t];
+    value = y * s;
+    derivative = kHalfPi * c;
+    if (sum < -1.0) { value = -1.0; derivative = 0.0; }
+    if (sum > 1.0) { value = 1.0; derivative = 0.0; }
+    break;
+  }
+  default: {
+    value = (sum < 1.0) ? sum : 1.0;
+    value = (value > -1.0) ? value : -1.0;
+    derivative = 1.0;
+    break;
+  }
+  }
+}
+
+#ifdef ACTIVATION_X86
+
+/**
+   -----------------------------------------------------------------------------
+   AVX2 kernels, 4 doubles per register.
+*/
+__attribute__((target("avx2")))
+static inline __m256d expAVX2(__m256d x) {
+  x = _mm256_min_pd(x, _mm256_set1_pd(kExpMax));
+  x = _mm256_max_pd(x, _mm256_set1_pd(-kExpMax));
+  __m256d magic = _mm256_set1_pd(kRoundMagic);
+  __m256d t = _mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(kLog2E)), magic);
+  __m256d n = _mm256_sub_pd(t, magic);
+  __m256d r = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(kLn2Hi)));
+  r = _mm256_sub_pd(r, _mm256_mul_pd(n, _mm256_set1_pd(kLn2Lo)));
+  __m256d p = _mm256_set1_pd(kExpTerms[kNExpTerms-1]);
+  for (int i_t = kNExpTerms-2; i_t >= 0; i_t--) {
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(kExpTerms[i_t]));
+  }
+  __m256i bits = _mm256_sub_epi64(_mm256_castpd_si256(t),
+				  _mm256_castpd_si256(magic));
+  bits = _mm256_slli_epi64(_mm256_add_epi64(bits, _mm256_set1_epi64x(1023)),
+			   52);
+  return _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+}
+
+__attribute__((target("avx2")))
+static int evaluateLayerAVX2(ActivationFunction function, const double *sums,
+			     int n, double *values, double *derivatives) {
+  __m256d one = _mm256_set1_pd(1.0);
+  __m256d minusOne = _mm256_set1_pd(-1.0);
+  int i_n = 0;
+  for (; i_n + 4 <= n; i_n += 4) {
+    __m256d sum = _mm256_loadu_pd(&sums[i_n]);
+    __m256d value, derivative;
+    switch (function) {
+    case kSigmoid: {
+      value = _mm256_div_pd(one, _mm256_add_pd(one, expAVX2(_mm256_sub_pd
+							(_mm256_setzero_pd(),
+							 sum))));
+      derivative = _mm256_mul_pd(value, _mm256_sub_pd(one, value));
+      break;
+    }
+    case kTanh: {
+      __m256d e = expAVX2(_mm256_add_pd(sum, sum));
+      value = _mm256_sub_pd(one, _mm256_div_pd(_mm256_set1_pd(2.0),
+					       _mm256_add_pd(e, one)));
+      derivative = _mm256_sub_pd(one, _mm256_mul_pd(value, value));
+      break;
+    }
+    case kSine: {
+      __m256d x = _mm256_max_pd(_mm256_min_pd(sum, one), minusOne);
+      __m256d y = _mm256_mul_pd(x, _mm256_set1_pd(kHalfPi));
+      __m256d y2 = _mm256_mul_pd(y, y);
+      __m256d s = _mm256_set1_pd(kSinTerms[kNSinTerms-1]);
+      for (int i_t = kNSinTerms-2; i_t >= 0; i_t--) {
+	s = _mm256_add_pd(_mm256_mul_pd(s, y2), _mm256_set1_pd(kSinTerms[i_t]));
+      }
+      __m256d c = _mm256_set1_pd(kCosTerms[kNCosTerms-1]);
+      for (int i_t = kNCosTerms-2; i_t >= 0; i_t--) {
+	c = _mm256_add_pd(_mm256_mul_pd(c, y2), _mm256_set1_pd(kCosTerms[i_t]));
+      }
+      value = _mm256_mul_pd(y, s);
+      derivative = _mm256_mul_pd(_mm256_set1_pd(kHalfPi), c);
+      __m256d below = _mm256_cmp_pd(sum, minusOne, _CMP_LT_OQ);
+      __m256d above = _mm256_cmp_pd(sum, one, _CMP_GT_OQ);
+      value = _mm256_blendv_pd(value, minusOne, below);
+      value = _mm256_blendv_pd(value, one, above);
+      derivative = _mm256_andnot_pd(_mm256_or_pd(below, above), derivative);
+      break;
+    }
+    default: {
+      value = _mm256_max_pd(_mm256_min_pd(sum, one), minusOne);
+      derivative = one;
+      break;
+    }
+    }
+    _mm256_storeu_pd(&values[i_n], value);
+    if (derivatives) _mm256_storeu_pd(&derivatives[i_n], derivative);
+  }
+  return i_n;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   AVX-512 kernels, 8 doubles per register. AVX-512F implies FMA, so the
+   contraction of mul + add is disabled to stay bit-identical to the scalar code.
+*/
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+static inline __m512d expAVX512(__m512d x) {
+  x = _mm512_min_pd(x, _mm512_set1_pd(kExpMax));
+  x = _mm512_max_pd(x, _mm512_set1_pd(-kExpMax));
+  __m512d magic = _mm512_set1_pd(kRoundMagic);
+  __m512d t = _mm512_add_pd(_mm512_mul_pd(x, _mm512_set1_pd(kLog2E)), magic);
+  __m512d n = _mm512_sub_pd(t, magic);
+  __m512d r = _mm512_sub_pd(x, _mm512_mul_pd(n, _mm512_set1_pd(kLn2Hi)));
+  r = _mm512_sub_pd(r, _mm512_mul_pd(n, _mm512_set1_pd(kLn2Lo)));
+  __m512d p = _mm512_set1_pd(kExpTerms[kNExpTerms-1]);
+  for (int i_t = kNExpTerms-2; i_t >= 0; i_t--) {
+    p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(kExpTerms[i_t]));
+  }
+  __m512i bits = _mm512_sub_epi64(_mm512_castpd_si512(t),
+				  _mm512_castpd_si512(magic));
+  bits = _mm512_slli_epi64(_mm512_add_epi64(bits, _mm512_set1_epi64(1023)),
+			   52);
+  return _mm512_mul_pd(p, _mm512_castsi512_pd(bits));
+}
+
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+static int evaluateLayerAVX512(ActivationFunction function, const double *sums,
+			       int n, double *values, double *derivatives) {
+  __m512d one = _mm512_set1_pd(1.0);
+  __m512d minusOne = _mm512_set1_pd(-1.0);
+  int i_n = 0;
+  for (; i_n + 8 <= n; i_n += 8) {
+    __m512d sum = _mm512_loadu_pd(&sums[i_n]);
+    __m512d value, derivative;
+    switch (function) {
+    case kSigmoid: {
+      value = _mm512_div_pd(one, _mm512_add_pd(one, expAVX512(_mm512_sub_pd
+							  (_mm512_setzero_pd(),
+							   sum))));
+      derivative = _mm512_mul_pd(value, _mm512_sub_pd(one, value));
+      break;
+    }
+    case kTanh: {
+      __m512d e = expAVX512(_mm512_add_pd(sum, sum));
+      value = _mm512_sub_pd(one, _mm512_div_pd(_mm512_set1_pd(2.0),
+					       _mm512_add_pd(e, one)));
+      derivative = _mm512_sub_pd(one, _mm512_mul_pd(value, value));
+      break;
+    }
+    case kSine: {
+      __m512d x = _mm512_max_pd(_mm512_min_pd(sum, one), minusOne);
+      __m512d y = _mm512_mul_pd(x, _mm512_set1_pd(kHalfPi));
+      __m512d y2 = _mm512_mul_pd(y, y);
+      __m512d s = _mm512_set1_pd(kSinTerms[kNSinTerms-1]);
+      for (int i_t = kNSinTerms-2; i_t >= 0; i_t--) {
+	s = _mm512_add_pd(_mm512_mul_pd(s, y2), _mm512_set1_pd(kSinTerms[i_t]));
+      }
+      __m512d c = _mm512_set1_pd(kCosTerms[kNCosTerms-1]);
+      for (int i_t = kNCosTerms-2; i_t >= 0; i_t--) {
+	c = _mm512_add_pd(_mm512_mul_pd(c, y2), _mm512_set1_pd(kCosTerms[i_t]));
+      }
+      value = _mm512_mul_pd(y, s);
+      derivative = _mm512_mul_pd(_mm512_set1_pd(kHalfPi), c);
+      __mmask8 below = _mm512_cmp_pd_mask(sum, minusOne, _CMP_LT_OQ);
+      __mmask8 above = _mm512_cmp_pd_mask(sum, one, _CMP_GT_OQ);
+      value = _mm512_mask_blend_pd(below, value, minusOne);
+      value = _mm512_mask_blend_pd(above, value, one);
+      derivative = _mm512_mask_blend_pd((__mmask8)(below | above), derivative,
+					_mm512_setzero_pd());
+      break;
+    }
+    default: {
+      value = _mm512_max_pd(_mm512_min_pd(sum, one), minusOne);
+      derivative = one;
+      break;
+    }
+    }
+    _mm512_storeu_pd(&values[i_n], value);
+    if (derivatives) _mm512_storeu_pd(&derivatives[i_n], derivative);
+  }
+  return i_n;
+}
+
+#endif
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The best instruction set supported by the CPU.
+*/
+static InstructionSet detectInstructionSet() {
+#ifdef ACTIVATION_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return kAVX512;
+  if (__builtin_cpu_supports("avx2")) return kAVX2;
+#endif
+  return kScalar;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The supported instruction set (detected once).
+*/
+static InstructionSet supportedInstructionSet() {
+  static InstructionSet supported = detectInstructionSet();
+  return supported;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - A reference to the instruction set currently in use.
+*/
+static InstructionSet& currentInstructionSet() {
+  static InstructionSet current = supportedInstructionSet();
+  return current;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Evaluate the activation function of a single sum.
+   @param function - The activation function.
+   @param sum - The weighted sum of the inputs.
+   @returns - The response for the given sum.
+*/
+double Activation::evaluate(ActivationFunction function, double sum) {
+  double value, derivative;
+  evaluateScalar(function, sum, value, derivative);
+  return value;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Evaluate the activation function and its derivative for a single sum.
+   @param function - The activation function.
+   @param sum - The weighted sum of the inputs.
+   @param value - The response for the given sum (output).
+   @param derivative - The derivative of the response (output).
+*/
+void Activation::evaluate(ActivationFunction function, double sum,
+			  double &value, double &derivative) {
+  evaluateScalar(function, sum, value, derivative);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Evaluate the activation function and its derivative for a whole layer of
+   sums, using the widest available vector kernel and scalar code for the
+   remainder.
+   @param function - The activation function.
+   @param sums - The n weighted sums.
+   @param n - The number of nodes.
+   @param values - The n responses (output, may be the same array as sums).
+   @param derivatives - The n derivatives (output), or NULL if not needed.
+*/
+void Activation::evaluateLayer(ActivationFunction function, const double *sums,
+			       int n, double *values, double *derivatives) {
+  int i_n = 0;
+#ifdef ACTIVATION_X86
+  InstructionSet instructionSet = currentInstructionSet();
+  if (instructionSet == kAVX512) {
+    i_n = evaluateLayerAVX512(function, sums, n, values, derivatives);
+  }
+  if (instructionSet >= kAVX2) {
+    i_n += evaluateLayerAVX2(function, &sums[i_n], n - i_n, &values[i_n],
+			     derivatives ? &derivatives[i_n] : NULL);
+  }
+#endif
+  for (; i_n < n; i_n++) {
+    double derivative;
+    evaluateScalar(function, sums[i_n], values[i_n], derivative);
+    if (derivatives) derivatives[i_n] = derivative;
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   As above, for single-precision sums. The functions are evaluated in double
+   precision by the kernels above, in chunks on the stack, and the results are
+   rounded to float. No memory is allocated.
+   @param function - The activation function.
+   @param sums - The n weighted sums.
+   @param n - The number of nodes.
+   @param values - The n responses (output, may be the same array as sums).
+   @param derivatives - The n derivatives (output), or NULL if not needed.
+*/
+void Activation::evaluateLayer(ActivationFunction function, const float *sums,
+			       int n, float *values, float *derivatives) {
+  const int chunkSize = 64;
+  double chunkValues[chunkSize];
+  double chunkDerivatives[chunkSize];
+  for (int i_c = 0; i_c < n; i_c += chunkSize) {
+    int nChunk = (n - i_c < chunkSize) ? (n - i_c) : chunkSize;
+    for (int i_n = 0; i_n < nChunk; i_n++) chunkValues[i_n] = sums[i_c + i_n];
+    evaluateLayer(function, chunkValues, nChunk, chunkValues,
+		  derivatives ? chunkDerivatives : NULL);
+    for (int i_n = 0; i_n < nChunk; i_n++) {
+      values[i_c + i_n] = (float)chunkValues[i_n];
+    }
+    for (int i_n = 0; i_n < nChunk && derivatives; i_n++) {
+      derivatives[i_c + i_n] = (float)chunkDerivatives[i_n];
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Translate an activation function name into an ActivationFunction.
+   @param name - The name of the function ("sigmoid", "tanh", ...).
+   @returns - The corresponding ActivationFunction.
+*/
+ActivationFunction Activation::fromName(std::string name) {
+  if (name == "sigmoid") return kSigmoid;
+  else if (name == "tanh") return kTanh;
+  else if (name == "linear") return kLinear;
+  else if (name == "sine") return kSine;
+  else {
+    std::cout << "Activation: improperly assigned threshold function " << name
+	      << std::endl;
+    exit(0);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The instruction set used by evaluateLayer().
+*/
+InstructionSet Activation::getInstructionSet() {
+  return currentInstructionSet();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The name of the instruction set used by evaluateLayer().
+*/
+std::string Activation::getInstructionSetName() {
+  switch (currentInstructionSet()) {
+  case kAVX512: return "avx512";
+  case kAVX2: return "avx2";
+  default: return "scalar";
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @param function - An activation function.
+   @returns - The name of the activation function.
+*/
+std::string Activation::getName(ActivationFunction function) {
+  switch (function) {
+  case kSigmoid: return "sigmoid";
+  case kTanh: return "tanh";
+  case kSine: return "sine";
+  default: return "linear";
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Limit the kernels used by evaluateLayer(), for instance to compare them.
+   Requests beyond what the CPU supports fall back to the best supported set.
+   Not thread-safe: call before starting any worker threads.
+   @param instructionSet - The widest instruction set to use.
+*/
+void Activation::setInstructionSet(InstructionSet instructionSet) {
+  InstructionSet supported = supportedInstructionSet();
+  currentInstructionSet()
+    = (instructionSet < supported) ? instructionSet : supported;
+}
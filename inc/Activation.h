@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: Activation.h                                                        //
+//  Class: Activation.cxx                                                     //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef Activation_h
+#define Activation_h
+
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+
+// Activation functions, all defined for x:[-1,+1], y:[-1,+1]:
+enum ActivationFunction { kLinear, kSigmoid, kTanh, kSine };
+
+// Instruction sets for the layer kernels, in increasing order:
+enum InstructionSet { kScalar, kAVX2, kAVX512 };
+
+namespace Activation {
+
+  // Names:
+  ActivationFunction fromName(std::string name);
+  std::string getName(ActivationFunction function);
+
+  // Single values:
+  double evaluate(ActivationFunction function, double sum);
+  void evaluate(ActivationFunction function, double sum, double &value,
+		double &derivative);
+
+  // Whole layers (values may alias sums, derivatives may be NULL):
+  void evaluateLayer(ActivationFunction function, const double *sums, int n,
+		     double *values, double *derivatives);
+  void evaluateLayer(ActivationFunction function, const float *sums, int n,
+		     float *values, float *derivatives);
+
+  // Kernel dispatch:
+  InstructionSet getInstructionSet();
+  std::string getInstructionSetName();
+  void setInstructionSet(InstructionSet instructionSet);
+
+}
+
+#endif
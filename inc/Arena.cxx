@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: Arena.cxx                                                           //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class is a simple bump allocator. Memory is handed out sequentially  //
+//  from a few large blocks, so objects created one after the other are       //
+//  contiguous in memory. Nothing is freed individually: all blocks are       //
+//  released at once when the Arena is destroyed. The owner must call the     //
+//  destructors of the objects it placed in the Arena before that.           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Arena.h"
+
+/**
+   -----------------------------------------------------------------------------
+   Arena constructor. No memory is reserved until the first allocation.
+   @param blockSize - The default size in bytes of each block.
+*/
+Arena::Arena(size_t blockSize) {
+  m_blocks.clear();
+  m_blockSize = blockSize;
+  m_blockUsed = 0;
+  m_blockCapacity = 0;
+  m_nBytesReserved = 0;
+  m_nBytesUsed = 0;
+  return;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Arena destructor. Releases all blocks at once.
+*/
+Arena::~Arena() {
+  for (std::vector<char*>::iterator blockIter = m_blocks.begin();
+       blockIter != m_blocks.end(); blockIter++) {
+    ::operator delete(*blockIter);
+  }
+  m_blocks.clear();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Allocate memory from the current block, starting a new block if the
+   current one is full.
+   @param size - The number of bytes to allocate.
+   @param alignment - The required alignment (a power of two).
+   @returns - A pointer to uninitialized memory owned by the Arena.
+*/
+void* Arena::allocate(size_t size, size_t alignment) {
+  size_t padding = 0;
+  if (!m_blocks.empty()) {
+    size_t address = (size_t)(m_blocks.back() + m_blockUsed);
+    padding = (alignment - (address % alignment)) % alignment;
+  }
+  if (m_blocks.empty() || m_blockUsed + padding + size > m_blockCapacity) {
+    reserve(size + alignment);
+    size_t address = (size_t)(m_blocks.back() + m_blockUsed);
+    padding = (alignment - (address % alignment)) % alignment;
+  }
+  void *result = m_blocks.back() + m_blockUsed + padding;
+  m_blockUsed += (padding + size);
+  m_nBytesUsed += (padding + size);
+  return result;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of blocks allocated so far.
+*/
+size_t Arena::getNBlocks() {
+  return m_blocks.size();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The total size in bytes of all blocks.
+*/
+size_t Arena::getNBytesReserved() {
+  return m_nBytesReserved;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of bytes handed out, including alignment padding.
+*/
+size_t Arena::getNBytesUsed() {
+  return m_nBytesUsed;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Make sure that the next size bytes can be allocated contiguously. Starts a
+   new block (of at least the default block size) if the current block does not
+   have enough room left.
+   @param size - The number of bytes needed.
+*/
+void Arena::reserve(size_t size) {
+  if (!m_blocks.empty() && m_blockUsed + size <= m_blockCapacity) return;
+  size_t capacity = (size > m_blockSize) ? size : m_blockSize;
+  char *block = (char*)::operator new(capacity);
+  m_blocks.push_back(block);
+  m_blockUsed = 0;
+  m_blockCapacity = capacity;
+  m_nBytesReserved += capacity;
+}
@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: Arena.h                                                             //
+//  Class: Arena.cxx                                                          //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef Arena_h
+#define Arena_h
+
+#include <cstddef>
+#include <iostream>
+#include <new>
+#include <stdlib.h>
+#include <vector>
+
+class Arena {
+  
+ public:
+  
+  Arena(size_t blockSize);
+  ~Arena();
+  
+  // Public Accessors:
+  size_t getNBlocks();
+  size_t getNBytesReserved();
+  size_t getNBytesUsed();
+  
+  // Public Mutators:
+  void* allocate(size_t size, size_t alignment);
+  void reserve(size_t size);
+  
+ private:
+  
+  // Member objects:
+  std::vector<char*> m_blocks;
+  size_t m_blockSize;
+  size_t m_blockUsed;
+  size_t m_blockCapacity;
+  size_t m_nBytesReserved;
+  size_t m_nBytesUsed;
+  
+};
+
+#endif
@@ -24,9 +24,59 @@ Axon::Axon(double weight, Neuron *originNeuron, Neuron *terminalNeuron) {
   setOriginNeuron(originNeuron);
   setTerminalNeuron(terminalNeuron);
   setWeight(weight);
+  clearGradient();
   return;
 }
 
+/**
+   -----------------------------------------------------------------------------
+   Axon destructor. The connected Neurons are owned by the NeuralNetwork.
+*/
+Axon::~Axon() {
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Add the error gradient of the current event, dE/dW_ij = delta_j * o_i, to the
+   gradient buffer. The weight itself is not changed until applyGradient().
+   Relies on previous neuron's response and subsequent neuron's delta.
+*/
+void Axon::accumulateGradient() {
+  double o_i = m_originNeuron->getResponse();//o_i
+  double delta_j = m_terminalNeuron->getDelta();//delta_j
+  m_gradient += (delta_j * o_i);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Update the weight using the mean of the accumulated gradients, then clear the
+   gradient buffer. With nEvents = 1 this is identical to trainWeight().
+   @param nEvents - The number of events accumulated since the last update.
+*/
+void Axon::applyGradient(int nEvents) {
+  if (nEvents <= 0) return;
+  double deltaW_ij = -1.0 * m_rate * m_gradient / ((double)nEvents);
+  m_weight += deltaW_ij;
+  clearGradient();
+  NN_COUNT(kWeightUpdates);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Clear the accumulated gradient.
+*/
+void Axon::clearGradient() {
+  m_gradient = 0.0;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The gradient accumulated since the last update.
+*/
+double Axon::getGradient() {
+  return m_gradient;
+}
+
 /**
    -----------------------------------------------------------------------------
    Get the learning rate (the rate at which the gradient descent will be 
@@ -116,5 +166,6 @@ double Axon::trainWeight() {
   double delta_j = m_terminalNeuron->getDelta();//delta_j
   double deltaW_ij = -1.0 * m_rate * delta_j * o_i;
   m_weight += deltaW_ij;
+  NN_COUNT(kWeightUpdates);
   return m_weight;
 }
@@ -26,12 +26,16 @@ class Axon {
   ~Axon();
   
   // Public Accessors:
+  double getGradient();
   double getLearningRate();
   Neuron* getOriginNeuron();
   Neuron* getTerminalNeuron();
   double getWeight();
   
   // Public Mutators:
+  void accumulateGradient();
+  void applyGradient(int nEvents);
+  void clearGradient();
   void setLearningRate(double rate);
   void setOriginNeuron(Neuron *neuron);
   void setTerminalNeuron(Neuron *neuron);
@@ -43,6 +47,7 @@ class Axon {
   // Member objects:
   double m_rate;
   double m_weight;
+  double m_gradient;
   Neuron *m_originNeuron;
   Neuron *m_terminalNeuron;
   
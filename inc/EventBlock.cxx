@@ -0,0 +1,260 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: EventBlock.cxx                                                      //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class is a view of a block of events that does not own or copy any   //
+//  data. Each input variable, each target and the optional event weight is   //
+//  a column of float or double values with a byte stride, so the same class  //
+//  describes the columns of a memory-mapped EventFile (stride = value size)  //
+//  as well as an ordinary row-major array of events (stride = row size).     //
+//  Values are converted to double only when they are read.                  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "EventBlock.h"
+
+/**
+   -----------------------------------------------------------------------------
+   Read one value of a column.
+   @param column - The column.
+   @param event - The index of the event in the column.
+   @returns - The value as a double.
+*/
+static inline double readValue(const EventColumn &column, long event) {
+  const char *address = column.data + event * column.stride;
+  if (column.type == kFloatColumn) return (double)(*((const float*)address));
+  else return *((const double*)address);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   EventBlock constructor for an empty block.
+*/
+EventBlock::EventBlock() {
+  clear();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   EventBlock constructor for a view of row-major arrays of events.
+   @param variables - Row-major [nEvents x nVariables] matrix of variables.
+   @param targets - Row-major [nEvents x nTargets] matrix of targets, or NULL.
+   @param nEvents - The number of events.
+   @param nVariables - The number of input variables per event.
+   @param nTargets - The number of targets per event.
+*/
+EventBlock::EventBlock(const double *variables, const double *targets,
+		       int nEvents, int nVariables, int nTargets) {
+  clear();
+  m_nEvents = nEvents;
+  for (int i_v = 0; i_v < nVariables; i_v++) {
+    addVariable(&variables[i_v], kDoubleColumn, nVariables * sizeof(double));
+  }
+  if (targets) {
+    for (int i_t = 0; i_t < nTargets; i_t++) {
+      addTarget(&targets[i_t], kDoubleColumn, nTargets * sizeof(double));
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   EventBlock destructor. The block does not own any event data.
+*/
+EventBlock::~EventBlock() {
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Add a target column. The targets of an event are in the order they were
+   added.
+   @param data - The address of the value of the first event.
+   @param type - The storage type of the values.
+   @param stride - The number of bytes between the values of adjacent events.
+*/
+void EventBlock::addTarget(const void *data, ColumnType type, long stride) {
+  EventColumn column;
+  column.data = (const char*)data;
+  column.type = type;
+  column.stride = stride;
+  m_targets.push_back(column);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Add an input variable column. The variables of an event are in the order
+   they were added.
+   @param data - The address of the value of the first event.
+   @param type - The storage type of the values.
+   @param stride - The number of bytes between the values of adjacent events.
+*/
+void EventBlock::addVariable(const void *data, ColumnType type, long stride) {
+  EventColumn column;
+  column.data = (const char*)data;
+  column.type = type;
+  column.stride = stride;
+  m_variables.push_back(column);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Remove all columns.
+*/
+void EventBlock::clear() {
+  m_nEvents = 0;
+  m_variables.clear();
+  m_targets.clear();
+  m_weights.data = NULL;
+  m_weights.type = kDoubleColumn;
+  m_weights.stride = 0;
+  m_hasWeights = false;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Make a view of a contiguous range of the events in this block. Nothing is
+   copied, and no memory is allocated once the columns of the target block have
+   reached their final size.
+   @param firstEvent - The index of the first event of the range.
+   @param nEvents - The number of events in the range.
+   @param block - The block to fill with the view.
+*/
+void EventBlock::getBlock(int firstEvent, int nEvents,
+			  EventBlock &block) const {
+  if (firstEvent < 0 || nEvents < 0 || firstEvent + nEvents > m_nEvents) {
+    std::cout << "EventBlock: ERROR! Events " << firstEvent << " to "
+	      << firstEvent + nEvents << " are out of range." << std::endl;
+    exit(0);
+  }
+  block.m_nEvents = nEvents;
+  block.m_variables = m_variables;
+  block.m_targets = m_targets;
+  block.m_weights = m_weights;
+  block.m_hasWeights = m_hasWeights;
+  for (int i_v = 0; i_v < (int)block.m_variables.size(); i_v++) {
+    block.m_variables[i_v].data += firstEvent * block.m_variables[i_v].stride;
+  }
+  for (int i_t = 0; i_t < (int)block.m_targets.size(); i_t++) {
+    block.m_targets[i_t].data += firstEvent * block.m_targets[i_t].stride;
+  }
+  if (m_hasWeights) block.m_weights.data += firstEvent * m_weights.stride;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Read the values of one input variable for a range of events.
+   @param variableIndex - The index of the input variable.
+   @param firstEvent - The index of the first event.
+   @param nEvents - The number of events.
+   @param values - Buffer for the nEvents values.
+*/
+void EventBlock::getColumn(int variableIndex, int firstEvent, int nEvents,
+			   double *values) const {
+  const EventColumn &column = m_variables[variableIndex];
+  const char *address = column.data + (long)firstEvent * column.stride;
+  if (column.type == kDoubleColumn && column.stride == sizeof(double)) {
+    const double *source = (const double*)address;
+    for (int i_e = 0; i_e < nEvents; i_e++) values[i_e] = source[i_e];
+  }
+  else if (column.type == kFloatColumn && column.stride == sizeof(float)) {
+    const float *source = (const float*)address;
+    for (int i_e = 0; i_e < nEvents; i_e++) values[i_e] = (double)source[i_e];
+  }
+  else {
+    for (int i_e = 0; i_e < nEvents; i_e++) {
+      values[i_e] = readValue(column, firstEvent + i_e);
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Read the input variables of one event.
+   @param event - The index of the event in the block.
+   @param variables - Buffer for the getNVariables() values.
+*/
+void EventBlock::getEvent(int event, double *variables) const {
+  for (int i_v = 0; i_v < (int)m_variables.size(); i_v++) {
+    variables[i_v] = readValue(m_variables[i_v], event);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of events in the block.
+*/
+int EventBlock::getNEvents() const {
+  return m_nEvents;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of targets per event.
+*/
+int EventBlock::getNTargets() const {
+  return (int)m_targets.size();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of input variables per event.
+*/
+int EventBlock::getNVariables() const {
+  return (int)m_variables.size();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Read the targets of one event.
+   @param event - The index of the event in the block.
+   @param targets - Buffer for the getNTargets() values.
+*/
+void EventBlock::getTargets(int event, double *targets) const {
+  for (int i_t = 0; i_t < (int)m_targets.size(); i_t++) {
+    targets[i_t] = readValue(m_targets[i_t], event);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @param event - The index of the event in the block.
+   @returns - The weight of the event (1 if the block has no weights).
+*/
+double EventBlock::getWeight(int event) const {
+  if (!m_hasWeights) return 1.0;
+  return readValue(m_weights, event);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - True iff the block has an event weight column.
+*/
+bool EventBlock::hasWeights() const {
+  return m_hasWeights;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @param nEvents - The number of events in every column.
+*/
+void EventBlock::setNEvents(int nEvents) {
+  m_nEvents = nEvents;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the event weight column.
+   @param data - The address of the weight of the first event.
+   @param type - The storage type of the weights.
+   @param stride - The number of bytes between the weights of adjacent events.
+*/
+void EventBlock::setWeights(const void *data, ColumnType type, long stride) {
+  m_weights.data = (const char*)data;
+  m_weights.type = type;
+  m_weights.stride = stride;
+  m_hasWeights = true;
+}
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: EventBlock.h                                                        //
+//  Class: EventBlock.cxx                                                     //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef EventBlock_h
+#define EventBlock_h
+
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+// Storage types of a column:
+enum ColumnType { kFloatColumn, kDoubleColumn };
+
+// One column of values: value i is at data + i * stride (in bytes).
+struct EventColumn {
+  const char *data;
+  ColumnType type;
+  long stride;
+};
+
+class EventBlock {
+
+ public:
+
+  EventBlock();
+  EventBlock(const double *variables, const double *targets, int nEvents,
+	     int nVariables, int nTargets);
+  ~EventBlock();
+
+  // Public Accessors:
+  void getBlock(int firstEvent, int nEvents, EventBlock &block) const;
+  void getColumn(int variableIndex, int firstEvent, int nEvents,
+		 double *values) const;
+  void getEvent(int event, double *variables) const;
+  int getNEvents() const;
+  int getNTargets() const;
+  int getNVariables() const;
+  void getTargets(int event, double *targets) const;
+  double getWeight(int event) const;
+  bool hasWeights() const;
+
+  // Public Mutators:
+  void addTarget(const void *data, ColumnType type, long stride);
+  void addVariable(const void *data, ColumnType type, long stride);
+  void clear();
+  void setNEvents(int nEvents);
+  void setWeights(const void *data, ColumnType type, long stride);
+
+ private:
+
+  // Member objects:
+  int m_nEvents;
+  std::vector<EventColumn> m_variables;
+  std::vector<EventColumn> m_targets;
+  EventColumn m_weights;
+  bool m_hasWeights;
+
+};
+
+#endif
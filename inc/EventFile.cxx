@@ -0,0 +1,322 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: EventFile.cxx                                                       //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class reads a columnar binary file of events through a read-only    //
+//  memory map, so that the same (possibly very large) sample can be used     //
+//  for every epoch without parsing or copying it. getBlock() returns an      //
+//  EventBlock that points directly into the mapped file.                     //
+//                                                                            //
+//  File layout (native byte order):                                          //
+//  - EventFileHeader: magic "NNEVENTS", version, nColumns, nEvents           //
+//  - nColumns EventFileColumn descriptors: name, type, role, offset          //
+//  - the columns, each nEvents contiguous float or double values, starting   //
+//    on a 64 byte boundary                                                   //
+//  The columns are the input variables, the targets (labels) and at most    //
+//  one event weight, in any order.                                           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "EventFile.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char kEventFileMagic[8] = {'N','N','E','V','E','N','T','S'};
+static const uint32_t kEventFileVersion = 1;
+static const uint64_t kColumnAlignment = 64;
+
+/**
+   -----------------------------------------------------------------------------
+   @param type - The storage type of a column.
+   @returns - The size in bytes of one value.
+*/
+static size_t getValueSize(uint32_t type) {
+  return (type == kFloatColumn) ? sizeof(float) : sizeof(double);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Write values to a file being created, and give up if they do not all fit
+   (e.g. on a full disk), since the header already claims every column.
+   @param file - The file.
+   @param data - The values.
+   @param valueSize - The size of one value in bytes.
+   @param nValues - The number of values.
+   @param fileName - The name of the file, for the error message.
+*/
+static void writeValues(FILE *file, const void *data, size_t valueSize,
+			size_t nValues, const std::string &fileName) {
+  if (fwrite(data, valueSize, nValues, file) != nValues) {
+    std::cout << "EventFile: ERROR! Failed to write " << fileName << std::endl;
+    fclose(file);
+    exit(0);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   EventFile constructor. Maps the file and checks the header and the columns.
+   @param fileName - The name of the event file.
+*/
+EventFile::EventFile(std::string fileName) {
+  m_fileName = fileName;
+  m_fileDescriptor = open(fileName.c_str(), O_RDONLY);
+  if (m_fileDescriptor < 0) {
+    std::cout << "EventFile: ERROR! Cannot open " << fileName << std::endl;
+    exit(0);
+  }
+  struct stat fileStatus;
+  fstat(m_fileDescriptor, &fileStatus);
+  m_size = (size_t)fileStatus.st_size;
+  if (m_size < sizeof(EventFileHeader)) {
+    std::cout << "EventFile: ERROR! " << fileName << " is too short."
+	      << std::endl;
+    exit(0);
+  }
+  m_data = (char*)mmap(NULL, m_size, PROT_READ, MAP_SHARED, m_fileDescriptor,
+		       0);
+  if (m_data == MAP_FAILED) {
+    std::cout << "EventFile: ERROR! Cannot map " << fileName << std::endl;
+    exit(0);
+  }
+  // Epochs stream through the events in order:
+  madvise(m_data, m_size, MADV_SEQUENTIAL);
+
+  // Check the header:
+  const EventFileHeader *header = (const EventFileHeader*)m_data;
+  if (memcmp(header->magic, kEventFileMagic, sizeof(kEventFileMagic)) != 0 ||
+      header->version != kEventFileVersion || header->nEvents > INT_MAX) {
+    std::cout << "EventFile: ERROR! " << fileName
+	      << " is not a version " << kEventFileVersion << " event file."
+	      << std::endl;
+    exit(0);
+  }
+  if (sizeof(EventFileHeader) + header->nColumns * sizeof(EventFileColumn)
+      > m_size) {
+    std::cout << "EventFile: ERROR! " << fileName << " is truncated."
+	      << std::endl;
+    exit(0);
+  }
+
+  // Build a view of all events, column by column:
+  m_events.clear();
+  m_events.setNEvents((int)header->nEvents);
+  m_variableNames.clear();
+  const EventFileColumn *columns
+    = (const EventFileColumn*)(m_data + sizeof(EventFileHeader));
+  for (uint32_t i_c = 0; i_c < header->nColumns; i_c++) {
+    const EventFileColumn &column = columns[i_c];
+    size_t valueSize = getValueSize(column.type);
+    // Written so that a corrupt offset cannot wrap around; a column of an
+    // empty file may start at the end of the file:
+    if (column.type > kDoubleColumn || column.offset % valueSize != 0 ||
+	column.offset > m_size ||
+	header->nEvents > (m_size - column.offset) / valueSize) {
+      std::cout << "EventFile: ERROR! Column " << i_c << " of " << fileName
+		<< " is out of bounds." << std::endl;
+      exit(0);
+    }
+    const char *data = m_data + column.offset;
+    ColumnType type = (ColumnType)column.type;
+    if (column.role == kVariableColumn) {
+      m_events.addVariable(data, type, valueSize);
+      m_variableNames.push_back(std::string(column.name,
+					    strnlen(column.name,
+						    sizeof(column.name))));
+    }
+    else if (column.role == kTargetColumn) {
+      m_events.addTarget(data, type, valueSize);
+    }
+    else if (column.role == kWeightColumn && !m_events.hasWeights()) {
+      m_events.setWeights(data, type, valueSize);
+    }
+    else {
+      std::cout << "EventFile: ERROR! Column " << i_c << " of " << fileName
+		<< " has an unknown role." << std::endl;
+      exit(0);
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   EventFile destructor. Unmaps the file. Blocks handed out by getBlock() must
+   not be used afterwards.
+*/
+EventFile::~EventFile() {
+  munmap(m_data, m_size);
+  close(m_fileDescriptor);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Get a view of a contiguous range of events. Nothing is copied: the block
+   points into the mapped file, and pages are read from disk (once) when the
+   events are first used.
+   @param firstEvent - The index of the first event of the range.
+   @param nEvents - The number of events in the range.
+   @param block - The block to fill with the view.
+*/
+void EventFile::getBlock(int firstEvent, int nEvents, EventBlock &block) const {
+  m_events.getBlock(firstEvent, nEvents, block);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The name of the event file.
+*/
+std::string EventFile::getFileName() const {
+  return m_fileName;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of events in the file.
+*/
+int EventFile::getNEvents() const {
+  return m_events.getNEvents();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of targets per event.
+*/
+int EventFile::getNTargets() const {
+  return m_events.getNTargets();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of input variables per event.
+*/
+int EventFile::getNVariables() const {
+  return m_events.getNVariables();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The names of the input variables, in column order.
+*/
+std::vector<std::string> EventFile::getVariableNames() const {
+  return m_variableNames;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - True iff the file has an event weight column.
+*/
+bool EventFile::hasWeights() const {
+  return m_events.hasWeights();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Write a block of events to a new event file. The input variables are stored
+   with the given type, the targets and the weights (if any) as doubles.
+   @param fileName - The name of the file to create.
+   @param block - The events, for instance a view of row-major arrays.
+   @param variableNames - The names of the input variables (up to 47 chars).
+   @param variableType - The storage type of the input variables.
+*/
+void EventFile::write(std::string fileName, const EventBlock &block,
+		      std::vector<std::string> variableNames,
+		      ColumnType variableType) {
+  if ((int)variableNames.size() != block.getNVariables()) {
+    std::cout << "EventFile: ERROR! Need one name per variable." << std::endl;
+    exit(0);
+  }
+  int nEvents = block.getNEvents();
+  int nVariables = block.getNVariables();
+  int nTargets = block.getNTargets();
+  int nColumns = nVariables + nTargets + (block.hasWeights() ? 1 : 0);
+
+  // Describe the columns, each aligned to kColumnAlignment:
+  EventFileHeader header;
+  memcpy(header.magic, kEventFileMagic, sizeof(kEventFileMagic));
+  header.version = kEventFileVersion;
+  header.nColumns = nColumns;
+  header.nEvents = nEvents;
+  std::vector<EventFileColumn> columns(nColumns);
+  uint64_t offset = sizeof(EventFileHeader) + nColumns*sizeof(EventFileColumn);
+  for (int i_c = 0; i_c < nColumns; i_c++) {
+    EventFileColumn &column = columns[i_c];
+    memset(column.name, 0, sizeof(column.name));
+    if (i_c < nVariables) {
+      strncpy(column.name, variableNames[i_c].c_str(), sizeof(column.name)-1);
+      column.type = variableType;
+      column.role = kVariableColumn;
+    }
+    else if (i_c < nVariables + nTargets) {
+      snprintf(column.name, sizeof(column.name), "target%d", i_c - nVariables);
+      column.type = kDoubleColumn;
+      column.role = kTargetColumn;
+    }
+    else {
+      snprintf(column.name, sizeof(column.name), "weight");
+      column.type = kDoubleColumn;
+      column.role = kWeightColumn;
+    }
+    offset = ((offset + kColumnAlignment - 1) / kColumnAlignment)
+      * kColumnAlignment;
+    column.offset = offset;
+    offset += nEvents * getValueSize(column.type);
+  }
+
+  FILE *file = fopen(fileName.c_str(), "wb");
+  if (!file) {
+    std::cout << "EventFile: ERROR! Cannot create " << fileName << std::endl;
+    exit(0);
+  }
+  writeValues(file, &header, sizeof(EventFileHeader), 1, fileName);
+  writeValues(file, &columns[0], sizeof(EventFileColumn), nColumns, fileName);
+
+  // Then write the columns one after the other. The padding is written even
+  // without events, so that the columns of an empty file end at its end:
+  std::vector<double> values(nEvents);
+  std::vector<float> floatValues(nEvents);
+  std::vector<double> targets(nTargets);
+  const char padding[kColumnAlignment] = {0};
+  for (int i_c = 0; i_c < nColumns; i_c++) {
+    long position = ftell(file);
+    if (position < 0 || (uint64_t)position > columns[i_c].offset) {
+      std::cout << "EventFile: ERROR! Failed to write " << fileName
+		<< std::endl;
+      fclose(file);
+      exit(0);
+    }
+    writeValues(file, padding, 1, columns[i_c].offset - position, fileName);
+    if (nEvents == 0) continue;
+    if (i_c < nVariables) block.getColumn(i_c, 0, nEvents, &values[0]);
+    for (int i_e = 0; i_e < nEvents && i_c >= nVariables; i_e++) {
+      if (i_c < nVariables + nTargets) {
+	block.getTargets(i_e, &targets[0]);
+	values[i_e] = targets[i_c - nVariables];
+      }
+      else {
+	values[i_e] = block.getWeight(i_e);
+      }
+    }
+    if (columns[i_c].type == kFloatColumn) {
+      for (int i_e = 0; i_e < nEvents; i_e++) {
+	floatValues[i_e] = (float)values[i_e];
+      }
+      writeValues(file, &floatValues[0], sizeof(float), nEvents, fileName);
+    }
+    else {
+      writeValues(file, &values[0], sizeof(double), nEvents, fileName);
+    }
+  }
+  if (fclose(file) != 0) {
+    std::cout << "EventFile: ERROR! Failed to write " << fileName << std::endl;
+    exit(0);
+  }
+}
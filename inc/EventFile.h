@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: EventFile.h                                                         //
+//  Class: EventFile.cxx                                                      //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef EventFile_h
+#define EventFile_h
+
+#include "EventBlock.h"
+#include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+// Roles of the columns in a file:
+enum ColumnRole { kVariableColumn, kTargetColumn, kWeightColumn };
+
+// File header, at offset 0:
+struct EventFileHeader {
+  char magic[8];// "NNEVENTS"
+  uint32_t version;
+  uint32_t nColumns;
+  uint64_t nEvents;
+};
+
+// Column descriptors, one per column, directly after the header:
+struct EventFileColumn {
+  char name[48];
+  uint32_t type;// ColumnType
+  uint32_t role;// ColumnRole
+  uint64_t offset;// Of the first value, from the start of the file
+};
+
+class EventFile {
+
+ public:
+
+  EventFile(std::string fileName);
+  ~EventFile();
+
+  // Public Accessors:
+  void getBlock(int firstEvent, int nEvents, EventBlock &block) const;
+  std::string getFileName() const;
+  int getNEvents() const;
+  int getNTargets() const;
+  int getNVariables() const;
+  std::vector<std::string> getVariableNames() const;
+  bool hasWeights() const;
+
+  // Static functions:
+  static void write(std::string fileName, const EventBlock &block,
+		    std::vector<std::string> variableNames,
+		    ColumnType variableType);
+
+ private:
+
+  // Not copyable (owns the file descriptor and the mapping):
+  EventFile(const EventFile&);
+  EventFile& operator=(const EventFile&);
+
+  // Member objects:
+  std::string m_fileName;
+  int m_fileDescriptor;
+  char *m_data;
+  size_t m_size;
+  EventBlock m_events;
+  std::vector<std::string> m_variableNames;
+
+};
+
+#endif
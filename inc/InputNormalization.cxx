@@ -0,0 +1,328 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: InputNormalization.cxx                                              //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class maps the input variables of a network onto [-1,+1]. It is     //
+//  filled in one streaming pass over the training data, then finalized,     //
+//  and is then stored with the network (see NeuralNetwork and                //
+//  CompiledNetwork), which apply it to the raw variables as they are loaded  //
+//  into the input layer. No normalized copy of the data is ever written.     //
+//                                                                            //
+//  - kRangeNormalization maps [min,max] linearly onto [-1,+1].               //
+//  - kQuantileNormalization maps the quantiles of each variable onto equally //
+//    spaced points of [-1,+1], interpolating linearly in between, so that    //
+//    the transformed variables are roughly uniform. The quantiles are taken  //
+//    from a fixed-size reservoir sample of the events, so memory does not    //
+//    grow with the data; the extrema are always exact.                       //
+//                                                                            //
+//  Values outside of the range seen in training are clamped to -1 or +1.    //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "InputNormalization.h"
+
+// Number of events kept for the quantile estimates:
+static const int kReservoirSize = 20000;
+
+/**
+   -----------------------------------------------------------------------------
+   Piecewise-linear map of a value through a list of knots.
+   @param knots - The nSegments+1 knots, in increasing order.
+   @param nSegments - The number of segments.
+   @param value - The value to transform.
+   @returns - The value mapped onto [-1,+1].
+*/
+static inline double interpolate(const double *knots, int nSegments,
+				 double value) {
+  if (knots[0] == knots[nSegments]) return 0.0;
+  if (!(value > knots[0])) return -1.0;
+  if (!(value < knots[nSegments])) return 1.0;
+  // Here knots[low] <= value < knots[high]:
+  int low = 0;
+  int high = nSegments;
+  while (high - low > 1) {
+    int middle = (low + high) / 2;
+    if (knots[middle] <= value) low = middle;
+    else high = middle;
+  }
+  double fraction = (value - knots[low]) / (knots[high] - knots[low]);
+  return (-1.0 + (2.0 * (low + fraction) / nSegments));
+}
+
+/**
+   -----------------------------------------------------------------------------
+   InputNormalization constructor for the identity transform.
+*/
+InputNormalization::InputNormalization() {
+  m_type = kNoNormalization;
+  m_nVariables = 0;
+  m_nSegments = 1;
+  m_isFinal = true;
+  m_nFilled = 0;
+  m_randomState = 1;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   InputNormalization constructor.
+   @param nVariables - The number of input variables.
+   @param type - The transform to use.
+   @param nQuantiles - The number of quantile intervals (for the quantile
+   transform only; the range transform always uses 1).
+*/
+InputNormalization::InputNormalization(int nVariables, NormalizationType type,
+				       int nQuantiles) {
+  if (nVariables < 0 || (type == kQuantileNormalization && nQuantiles < 1)) {
+    std::cout << "InputNormalization: ERROR! Bad configuration." << std::endl;
+    exit(0);
+  }
+  m_type = type;
+  m_nVariables = nVariables;
+  m_nSegments = (type == kQuantileNormalization) ? nQuantiles : 1;
+  m_isFinal = (type == kNoNormalization);
+  m_nFilled = 0;
+  m_randomState = 1;
+  m_minima.assign(m_nVariables, 0.0);
+  m_maxima.assign(m_nVariables, 0.0);
+  m_samples.clear();
+  m_knots.assign(m_nVariables * (m_nSegments+1), 0.0);
+  m_scales.assign(m_nVariables, 0.0);
+  m_offsets.assign(m_nVariables, 0.0);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   InputNormalization destructor.
+*/
+InputNormalization::~InputNormalization() {
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Add one event to the statistics.
+   @param vars - The getNVariables() raw input variables.
+*/
+void InputNormalization::fill(const double *vars) {
+  if (m_isFinal) {
+    std::cout << "InputNormalization: ERROR! Already finalized." << std::endl;
+    exit(0);
+  }
+  for (int i_v = 0; i_v < m_nVariables; i_v++) {
+    if (m_nFilled == 0 || vars[i_v] < m_minima[i_v]) m_minima[i_v] = vars[i_v];
+    if (m_nFilled == 0 || vars[i_v] > m_maxima[i_v]) m_maxima[i_v] = vars[i_v];
+  }
+
+  // Reservoir sampling: event n replaces a random slot with probability k/n.
+  if (m_type == kQuantileNormalization) {
+    long slot = m_nFilled;
+    if (m_nFilled >= kReservoirSize) {
+      m_randomState = (m_randomState * 6364136223846793005ULL
+		       + 1442695040888963407ULL);
+      slot = (long)((m_randomState >> 33) % (unsigned long long)(m_nFilled+1));
+    }
+    else {
+      m_samples.resize((m_nFilled+1) * m_nVariables);
+    }
+    if (slot < kReservoirSize) {
+      for (int i_v = 0; i_v < m_nVariables; i_v++) {
+	m_samples[slot * m_nVariables + i_v] = vars[i_v];
+      }
+    }
+  }
+  m_nFilled++;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Add all events of a block, such as an EventFile, to the statistics.
+   @param block - The events.
+*/
+void InputNormalization::fill(const EventBlock &block) {
+  if (block.getNVariables() != m_nVariables) {
+    std::cout << "InputNormalization: ERROR! Wrong number of variables."
+	      << std::endl;
+    exit(0);
+  }
+  std::vector<double> vars(m_nVariables);
+  for (int i_e = 0; i_e < block.getNEvents(); i_e++) {
+    block.getEvent(i_e, &vars[0]);
+    fill(&vars[0]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Compute the transform from the statistics. The sample is released.
+*/
+void InputNormalization::finalize() {
+  if (m_isFinal) return;
+  int nKnots = m_nSegments + 1;
+  int nSamples = (int)(m_samples.size() / (m_nVariables > 0 ? m_nVariables : 1));
+  std::vector<double> column(nSamples);
+  for (int i_v = 0; i_v < m_nVariables; i_v++) {
+    double *knots = &m_knots[i_v * nKnots];
+    knots[0] = m_minima[i_v];
+    knots[m_nSegments] = m_maxima[i_v];
+    if (m_type == kQuantileNormalization && nSamples > 0) {
+      for (int i_s = 0; i_s < nSamples; i_s++) {
+	column[i_s] = m_samples[i_s * m_nVariables + i_v];
+      }
+      std::sort(column.begin(), column.end());
+      for (int i_k = 1; i_k < m_nSegments; i_k++) {
+	int index = (int)(((long)i_k * (nSamples-1)) / m_nSegments);
+	knots[i_k] = column[index];
+      }
+    }
+    updateRange(i_v);
+  }
+  m_samples.clear();
+  std::vector<double>().swap(m_samples);
+  m_isFinal = true;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @param variableIndex - The index of the input variable.
+   @returns - The getNSegments()+1 knots of the variable.
+*/
+std::vector<double> InputNormalization::getKnots(int variableIndex) const {
+  int nKnots = m_nSegments + 1;
+  return std::vector<double>(m_knots.begin() + variableIndex * nKnots,
+			     m_knots.begin() + (variableIndex+1) * nKnots);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of linear segments per variable.
+*/
+int InputNormalization::getNSegments() const {
+  return m_nSegments;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of input variables.
+*/
+int InputNormalization::getNVariables() const {
+  return m_nVariables;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The type of transform.
+*/
+NormalizationType InputNormalization::getType() const {
+  return m_type;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - True iff the transform is finalized and is not the identity.
+*/
+bool InputNormalization::isActive() const {
+  return (m_type != kNoNormalization && m_isFinal);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the knots of one variable directly, for instance when reading a stored
+   network. The transform is final once the knots are set.
+   @param variableIndex - The index of the input variable.
+   @param knots - The getNSegments()+1 knots, in increasing order.
+*/
+void InputNormalization::setKnots(int variableIndex, std::vector<double> knots) {
+  if (variableIndex < 0 || variableIndex >= m_nVariables ||
+      (int)knots.size() != m_nSegments + 1) {
+    std::cout << "InputNormalization: ERROR! Bad knots for variable "
+	      << variableIndex << std::endl;
+    exit(0);
+  }
+  for (int i_k = 0; i_k <= m_nSegments; i_k++) {
+    m_knots[variableIndex * (m_nSegments+1) + i_k] = knots[i_k];
+  }
+  updateRange(variableIndex);
+  m_samples.clear();
+  m_isFinal = true;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Transform the input variables of one event.
+   @param vars - The getNVariables() raw input variables.
+   @param values - Buffer for the normalized variables (may alias vars).
+*/
+void InputNormalization::transform(const double *vars, double *values) const {
+  for (int i_v = 0; i_v < m_nVariables; i_v++) {
+    values[i_v] = transformValue(i_v, vars[i_v]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Transform many values of one variable, e.g. a column of a block of events.
+   The range transform is a branch-free loop that the compiler vectorizes.
+   @param variableIndex - The index of the input variable.
+   @param values - The n raw values.
+   @param n - The number of values.
+   @param normalized - Buffer for the n normalized values (may alias values).
+*/
+void InputNormalization::transformColumn(int variableIndex,
+					 const double *values, int n,
+					 double *normalized) const {
+  if (m_type == kNoNormalization) {
+    for (int i_n = 0; i_n < n; i_n++) normalized[i_n] = values[i_n];
+  }
+  else if (m_type == kRangeNormalization) {
+    double scale = m_scales[variableIndex];
+    double offset = m_offsets[variableIndex];
+    double minimum = m_knots[variableIndex * 2];
+    for (int i_n = 0; i_n < n; i_n++) {
+      double value = (values[i_n] - minimum) * scale + offset;
+      value = (value < 1.0) ? value : 1.0;
+      normalized[i_n] = (value > -1.0) ? value : -1.0;
+    }
+  }
+  else {
+    const double *knots = &m_knots[variableIndex * (m_nSegments+1)];
+    for (int i_n = 0; i_n < n; i_n++) {
+      normalized[i_n] = interpolate(knots, m_nSegments, values[i_n]);
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Transform a single value. Gives the same result as transformColumn().
+   @param variableIndex - The index of the input variable.
+   @param value - The raw value.
+   @returns - The normalized value.
+*/
+double InputNormalization::transformValue(int variableIndex,
+					  double value) const {
+  double normalized;
+  transformColumn(variableIndex, &value, 1, &normalized);
+  return normalized;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Store the linear range transform of a variable as a scale and an offset. A
+   constant variable is mapped onto 0.
+   @param variableIndex - The index of the input variable.
+*/
+void InputNormalization::updateRange(int variableIndex) {
+  double minimum = m_knots[variableIndex * (m_nSegments+1)];
+  double maximum = m_knots[variableIndex * (m_nSegments+1) + m_nSegments];
+  if (maximum > minimum) {
+    m_scales[variableIndex] = 2.0 / (maximum - minimum);
+    m_offsets[variableIndex] = -1.0;
+  }
+  else {
+    m_scales[variableIndex] = 0.0;
+    m_offsets[variableIndex] = 0.0;
+  }
+}
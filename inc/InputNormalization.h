@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: InputNormalization.h                                                //
+//  Class: InputNormalization.cxx                                             //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef InputNormalization_h
+#define InputNormalization_h
+
+#include "EventBlock.h"
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+// Transforms of the input variables onto [-1,+1]:
+enum NormalizationType {
+  kNoNormalization,// Identity
+  kRangeNormalization,// Linear map of [min,max]
+  kQuantileNormalization// Piecewise-linear map of the quantiles (uniformizing)
+};
+
+class InputNormalization {
+
+ public:
+
+  InputNormalization();
+  InputNormalization(int nVariables, NormalizationType type, int nQuantiles);
+  ~InputNormalization();
+
+  // Public Accessors:
+  std::vector<double> getKnots(int variableIndex) const;
+  int getNSegments() const;
+  int getNVariables() const;
+  NormalizationType getType() const;
+  bool isActive() const;
+  void transform(const double *vars, double *values) const;
+  void transformColumn(int variableIndex, const double *values, int n,
+		       double *normalized) const;
+  double transformValue(int variableIndex, double value) const;
+
+  // Public Mutators:
+  void fill(const double *vars);
+  void fill(const EventBlock &block);
+  void finalize();
+  void setKnots(int variableIndex, std::vector<double> knots);
+
+ private:
+
+  // Private functions:
+  void updateRange(int variableIndex);
+
+  // Configuration:
+  NormalizationType m_type;
+  int m_nVariables;
+  int m_nSegments;
+  bool m_isFinal;
+
+  // Streaming statistics: exact extrema and a reservoir sample of events
+  // (row-major [slot x variable]) for the quantiles:
+  long m_nFilled;
+  std::vector<double> m_minima;
+  std::vector<double> m_maxima;
+  std::vector<double> m_samples;
+  unsigned long long m_randomState;
+
+  // Result: variable v maps m_knots[v*(m_nSegments+1) + k] onto
+  // -1 + 2k/m_nSegments, linearly in between. The range transform is also
+  // stored as value * scale + offset for the vectorized fast path.
+  std::vector<double> m_knots;
+  std::vector<double> m_scales;
+  std::vector<double> m_offsets;
+
+};
+
+#endif
@@ -0,0 +1,300 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: Instrumentation.cxx                                                 //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class collects hot-path statistics of a network: cumulative timers   //
+//  for the phases of each event, the numbers of Neuron::getResponse() and    //
+//  Neuron::getDelta() calls and of the memoized hits among them, the         //
+//  maximum recursion depth, and the heap allocations per event.              //
+//                                                                            //
+//  The hooks in the hot paths are the NN_ macros of Instrumentation.h, which //
+//  only exist when NN_INSTRUMENTATION is defined at compile time (make       //
+//  INSTRUMENTATION=1). Otherwise they are compiled out entirely and all      //
+//  statistics read zero. In an instrumented build the global operator new is //
+//  replaced by a counting one, and the array operator new and every form of  //
+//  operator delete by matching ones.                                         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Instrumentation.h"
+#include <new>
+#include <stdlib.h>
+
+// The Instrumentation that receives the counts of the calling thread:
+static thread_local Instrumentation *t_current = NULL;
+
+// The number of heap allocations made by the calling thread:
+static thread_local long t_nAllocations = 0;
+
+#ifdef NN_INSTRUMENTATION
+
+/**
+   -----------------------------------------------------------------------------
+   Counting replacement of the global operator new. The nothrow forms of the
+   standard library call this one.
+*/
+void* operator new(size_t size) {
+  t_nAllocations++;
+  void *memory = malloc(size ? size : 1);
+  if (!memory) throw std::bad_alloc();
+  return memory;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Replacement of the global array operator new, counted by operator new.
+*/
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Replacement of the global operator delete, matching operator new. The
+   sized and array forms below forward to it.
+*/
+void operator delete(void *memory) noexcept {
+  free(memory);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Replacement of the global sized operator delete (C++14).
+*/
+void operator delete(void *memory, size_t) noexcept {
+  operator delete(memory);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Replacement of the global array operator delete.
+*/
+void operator delete[](void *memory) noexcept {
+  operator delete(memory);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Replacement of the global sized array operator delete (C++14).
+*/
+void operator delete[](void *memory, size_t) noexcept {
+  operator delete(memory);
+}
+
+#endif
+
+/**
+   -----------------------------------------------------------------------------
+   Instrumentation constructor. All statistics start at zero.
+*/
+Instrumentation::Instrumentation() {
+  reset();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Instrumentation destructor.
+*/
+Instrumentation::~Instrumentation() {
+  if (t_current == this) t_current = NULL;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Add heap allocations to the statistics.
+   @param nAllocations - The number of allocations.
+*/
+void Instrumentation::addAllocations(long nAllocations) {
+  m_counts[kAllocations] += nAllocations;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Add time to a phase timer.
+   @param phase - The phase.
+   @param seconds - The time to add.
+*/
+void Instrumentation::addSeconds(InstrumentationPhase phase, double seconds) {
+  m_seconds[phase] += seconds;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The mean number of heap allocations per forward pass.
+*/
+double Instrumentation::getAllocationsPerEvent() const {
+  if (m_counts[kEventCount] == 0) return 0.0;
+  return (m_counts[kAllocations] / ((double)m_counts[kEventCount]));
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @param counter - The counter.
+   @returns - The value of the counter.
+*/
+long Instrumentation::getCount(InstrumentationCounter counter) const {
+  return m_counts[counter];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The Instrumentation receiving the counts of the calling thread.
+*/
+Instrumentation* Instrumentation::getCurrent() {
+  return t_current;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The deepest nesting of recursive getResponse(), getDelta() and
+   backPropagation() evaluations. 1 means that nothing recursed.
+*/
+int Instrumentation::getMaxRecursionDepth() const {
+  return m_maxDepth;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of heap allocations made by the calling thread so far
+   (always 0 unless NN_INSTRUMENTATION is defined).
+*/
+long Instrumentation::getNAllocations() {
+  return t_nAllocations;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - A human-readable summary of all statistics.
+*/
+std::string Instrumentation::getReport() const {
+  const char *phaseNames[kNPhases] = {"clear", "forward", "delta", "gradient",
+				      "update"};
+  std::ostringstream report;
+  report << "Instrumentation report" << std::endl;
+  if (!isEnabled()) {
+    report << "  Disabled: compile with -DNN_INSTRUMENTATION." << std::endl;
+    return report.str();
+  }
+  double totalSeconds = 0.0;
+  for (int i_p = 0; i_p < kNPhases; i_p++) totalSeconds += m_seconds[i_p];
+  char line[256];
+  snprintf(line, sizeof(line), "  %-10s %12s %8s\n", "phase", "seconds", "%");
+  report << line;
+  for (int i_p = 0; i_p < kNPhases; i_p++) {
+    double fraction = (totalSeconds > 0.0) ?
+      (100.0 * m_seconds[i_p] / totalSeconds) : 0.0;
+    snprintf(line, sizeof(line), "  %-10s %12.6f %8.2f\n", phaseNames[i_p],
+	     m_seconds[i_p], fraction);
+    report << line;
+  }
+  snprintf(line, sizeof(line), "  events %ld\n", m_counts[kEventCount]);
+  report << line;
+  snprintf(line, sizeof(line), "  getResponse calls %ld memoized %ld\n",
+	   m_counts[kResponseCalls], m_counts[kResponseHits]);
+  report << line;
+  snprintf(line, sizeof(line), "  getDelta calls %ld memoized %ld\n",
+	   m_counts[kDeltaCalls], m_counts[kDeltaHits]);
+  report << line;
+  snprintf(line, sizeof(line), "  weight updates %ld\n",
+	   m_counts[kWeightUpdates]);
+  report << line;
+  snprintf(line, sizeof(line), "  max recursion depth %d\n", m_maxDepth);
+  report << line;
+  snprintf(line, sizeof(line), "  heap allocations %ld (%.3g per event)\n",
+	   m_counts[kAllocations], getAllocationsPerEvent());
+  report << line;
+  return report.str();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @param phase - The phase.
+   @returns - The cumulative time spent in the phase.
+*/
+double Instrumentation::getSeconds(InstrumentationPhase phase) const {
+  return m_seconds[phase];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - True if the hooks were compiled in (NN_INSTRUMENTATION).
+*/
+bool Instrumentation::isEnabled() {
+#ifdef NN_INSTRUMENTATION
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set all statistics to zero.
+*/
+void Instrumentation::reset() {
+  for (int i_c = 0; i_c < kNCounters; i_c++) m_counts[i_c] = 0;
+  for (int i_p = 0; i_p < kNPhases; i_p++) m_seconds[i_p] = 0.0;
+  m_depth = 0;
+  m_maxDepth = 0;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the Instrumentation receiving the counts of the calling thread.
+   @param instrumentation - The Instrumentation, or NULL for none.
+*/
+void Instrumentation::setCurrent(Instrumentation *instrumentation) {
+  t_current = instrumentation;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   InstrumentationScope constructor. Makes the Instrumentation current.
+   @param instrumentation - The Instrumentation.
+*/
+InstrumentationScope::InstrumentationScope(Instrumentation *instrumentation) {
+  m_instrumentation = instrumentation;
+  m_previous = Instrumentation::getCurrent();
+  m_nAllocations = Instrumentation::getNAllocations();
+  Instrumentation::setCurrent(instrumentation);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   InstrumentationScope destructor. Adds the allocations made in the scope and
+   restores the previous Instrumentation.
+*/
+InstrumentationScope::~InstrumentationScope() {
+  if (m_previous != m_instrumentation) {
+    m_instrumentation->addAllocations(Instrumentation::getNAllocations() -
+				      m_nAllocations);
+  }
+  Instrumentation::setCurrent(m_previous);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   InstrumentationTimer constructor. Starts the timer.
+   @param phase - The phase to which the time is added.
+*/
+InstrumentationTimer::InstrumentationTimer(InstrumentationPhase phase) {
+  m_phase = phase;
+  m_start = std::chrono::steady_clock::now();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   InstrumentationTimer destructor. Adds the elapsed time to the phase of the
+   current Instrumentation.
+*/
+InstrumentationTimer::~InstrumentationTimer() {
+  Instrumentation *current = Instrumentation::getCurrent();
+  if (current) {
+    current->addSeconds(m_phase, std::chrono::duration<double>
+			(std::chrono::steady_clock::now() - m_start).count());
+  }
+}
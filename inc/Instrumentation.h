@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: Instrumentation.h                                                   //
+//  Class: Instrumentation.cxx                                                //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef Instrumentation_h
+#define Instrumentation_h
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
+#include <string>
+
+// Phases of an event with cumulative timers:
+enum InstrumentationPhase {
+  kClearPhase,// Clearing the responses and deltas
+  kForwardPhase,// Evaluating the responses
+  kDeltaPhase,// Evaluating the deltas
+  kGradientPhase,// Accumulating the weight gradients
+  kUpdatePhase,// Updating the weights
+  kNPhases
+};
+
+// Event counters:
+enum InstrumentationCounter {
+  kEventCount,// Forward passes
+  kResponseCalls,// Neuron::getResponse() invocations
+  kResponseHits,// ... returning a memoized response
+  kDeltaCalls,// Neuron::getDelta() invocations
+  kDeltaHits,// ... returning a memoized delta
+  kWeightUpdates,// Axon weight updates
+  kAllocations,// Heap allocations
+  kNCounters
+};
+
+class Instrumentation
+{
+
+ public:
+
+  Instrumentation();
+  ~Instrumentation();
+
+  // Accessors:
+  double getAllocationsPerEvent() const;
+  long getCount(InstrumentationCounter counter) const;
+  int getMaxRecursionDepth() const;
+  std::string getReport() const;
+  double getSeconds(InstrumentationPhase phase) const;
+
+  // Mutators:
+  void reset();
+
+  // Static functions:
+  static bool isEnabled();
+
+  // Hooks for the NN_ macros below. Counts go to the Instrumentation that is
+  // current on the calling thread (set by InstrumentationScope), if any:
+  static Instrumentation* getCurrent();
+  static long getNAllocations();
+  static void setCurrent(Instrumentation *instrumentation);
+  static inline void count(InstrumentationCounter counter) {
+    Instrumentation *current = getCurrent();
+    if (current) current->m_counts[counter]++;
+  }
+  static inline void enterRecursion() {
+    Instrumentation *current = getCurrent();
+    if (current && ++current->m_depth > current->m_maxDepth) {
+      current->m_maxDepth = current->m_depth;
+    }
+  }
+  static inline void exitRecursion() {
+    Instrumentation *current = getCurrent();
+    if (current) current->m_depth--;
+  }
+  void addAllocations(long nAllocations);
+  void addSeconds(InstrumentationPhase phase, double seconds);
+
+ private:
+
+  // Member objects:
+  long m_counts[kNCounters];
+  double m_seconds[kNPhases];
+  int m_depth;
+  int m_maxDepth;
+
+};
+
+// Makes an Instrumentation current for the lifetime of the scope, and adds
+// the heap allocations made meanwhile to it. Nested scopes of the same
+// Instrumentation are ignored, so each allocation is counted once:
+class InstrumentationScope
+{
+
+ public:
+
+  InstrumentationScope(Instrumentation *instrumentation);
+  ~InstrumentationScope();
+
+ private:
+
+  Instrumentation *m_instrumentation;
+  Instrumentation *m_previous;
+  long m_nAllocations;
+
+};
+
+// Adds the lifetime of the scope to a phase timer of the current
+// Instrumentation:
+class InstrumentationTimer
+{
+
+ public:
+
+  InstrumentationTimer(InstrumentationPhase phase);
+  ~InstrumentationTimer();
+
+ private:
+
+  InstrumentationPhase m_phase;
+  std::chrono::steady_clock::time_point m_start;
+
+};
+
+// The hooks used in the hot paths. Unless NN_INSTRUMENTATION is defined at
+// compile time they expand to nothing, and cost nothing:
+#ifdef NN_INSTRUMENTATION
+#define NN_SCOPE(instrumentation)					\
+  InstrumentationScope nnInstrumentationScope(instrumentation)
+#define NN_TIME(phase) InstrumentationTimer nnInstrumentationTimer(phase)
+#define NN_COUNT(counter) Instrumentation::count(counter)
+#define NN_ENTER_RECURSION() Instrumentation::enterRecursion()
+#define NN_EXIT_RECURSION() Instrumentation::exitRecursion()
+#else
+#define NN_SCOPE(instrumentation)
+#define NN_TIME(phase)
+#define NN_COUNT(counter)
+#define NN_ENTER_RECURSION()
+#define NN_EXIT_RECURSION()
+#endif
+
+#endif
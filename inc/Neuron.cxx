@@ -19,7 +19,8 @@
    Neuron constructor, with option to set the threshold function:
    @param layerIndex - The index of the layer in which this Neuron resides.
    @param function - The activation function for the neuron: "sigmoid", "tanh",
-   "linear", all defined for x:[-1,+1], y:[-1,+1].
+   "linear", "sine", all defined for x:[-1,+1], y:[-1,+1]. The name is resolved
+   to an ActivationFunction once, here.
 */
 Neuron::Neuron(int layerIndex, std::string function) {
   setBiasNode(false);
@@ -31,12 +32,19 @@ Neuron::Neuron(int layerIndex, std::string function) {
   m_delta = 0.0;
   m_downstreamConnections.clear();
   m_upstreamConnections.clear();
-  m_function = function;
+  m_activation = Activation::fromName(function);
   m_target = 0.0;
   setLayerIndex(layerIndex);
   return;
 }
 
+/**
+   -----------------------------------------------------------------------------
+   Neuron destructor. The connections are owned by the NeuralNetwork.
+*/
+Neuron::~Neuron() {
+}
+
 /**
    -----------------------------------------------------------------------------
    Add a single downstream connection.
@@ -98,11 +106,11 @@ void Neuron::addUpstreamConnection(std::vector<Axon*> axons) {
    -----------------------------------------------------------------------------
    This algorithm recursively calls itself on ancestor (upstream) Neurons. Once
    it reaches a bias node or input node with no prior weights or nodes, it 
-   calls the getDelta() function, which recursively updates the weights and 
-   deltas for the following graph. Flags prevent duplication of calculation and
-   also conflicts arising from weight reassignment. 
+   calls the getDelta() function, which recursively calculates the deltas for
+   the following graph. Flags prevent duplication of calculation.
 */
 void Neuron::backPropagation() {
+  NN_ENTER_RECURSION();
   if (isBiasNode() || isInputNode()) {
     getDelta();
   }
@@ -114,25 +122,18 @@ void Neuron::backPropagation() {
       ((*axonIter)->getOriginNeuron())->backPropagation();
     }
   }
+  NN_EXIT_RECURSION();
 }
 
 /**
    -----------------------------------------------------------------------------
-   Clears the delta value information, which is stored for speed. Note: this 
-   algorithm is recursive. It will clear the delta values for all downstream 
-   (predecessor) Neurons.
+   Clears the delta value information, which is stored for speed. Only this
+   Neuron is cleared: the NeuralNetwork clears all of its Neurons in one flat
+   loop, instead of recursing through the downstream graph.
 */
 void Neuron::clearDelta() {
-  if (m_hasDelta) {
-    m_hasDelta = false;
-    m_delta = 0.0;
-    // Then recursively clear predecesor Neurons' deltas:
-    std::vector<Axon*> predecessorConnections = getDownstreamConnections();
-    for (std::vector<Axon*>::iterator axonIter = predecessorConnections.begin();
-	 axonIter != predecessorConnections.end(); axonIter++) {
-      ((*axonIter)->getTerminalNeuron())->clearDelta();
-    }
-  }
+  m_hasDelta = false;
+  m_delta = 0.0;
 }
 
 /**
@@ -153,20 +154,32 @@ void Neuron::clearResponse() {
 //  m_sumOfResponses = 0.0;
 //}
 
+/**
+   -----------------------------------------------------------------------------
+   @returns - The activation function of the Neuron.
+*/
+ActivationFunction Neuron::getActivation() {
+  return m_activation;
+}
+
 /**
    -----------------------------------------------------------------------------
    Get the delta value associated with this Neuron for back-propagation. Relies
-   on the downstream connection weights and downstream connection deltas.
+   on the downstream connection weights and downstream connection deltas. The
+   weights are not modified here: see Axon::accumulateGradient().
    
    MUST BE MODIFIED TO USE SUM! AND SUM FOR DERIVATIVE!
 */
 double Neuron::getDelta() {
-  m_delta = 0.0;
-  double derivative = getResponseDerivative();
+  NN_COUNT(kDeltaCalls);
   if (m_hasDelta) {
+    NN_COUNT(kDeltaHits);
     return m_delta;
   }
-  else if (isOutputNode()) {
+  NN_ENTER_RECURSION();
+  m_delta = 0.0;
+  double derivative = getResponseDerivative();
+  if (isOutputNode()) {
     m_delta = ((m_response - m_target) * derivative);
   }
   else {
@@ -182,11 +195,7 @@ double Neuron::getDelta() {
     m_delta = (currSum * derivative);
   }
   m_hasDelta = true;
-  // Then update the downstream weights:
-  for (std::vector<Axon*>::iterator axonIter = m_downstreamConnections.begin(); 
-       axonIter != m_downstreamConnections.end(); axonIter++) {
-    (*axonIter)->trainWeight();
-  }
+  NN_EXIT_RECURSION();
   return m_delta;
 }
 
@@ -198,6 +207,14 @@ std::vector<Axon*> Neuron::getDownstreamConnections() {
   return m_downstreamConnections;
 }
 
+/**
+   -----------------------------------------------------------------------------
+   @returns - The name of the activation function for the Neuron.
+*/
+std::string Neuron::getFunction() {
+  return Activation::getName(m_activation);
+}
+
 /**
    -----------------------------------------------------------------------------
    Get the layer index.
@@ -230,7 +247,9 @@ int Neuron::getNUpstreamConnections() {
    for input nodes, and is variable for all other nodes. 
 */
 double Neuron::getResponse() {
+  NN_COUNT(kResponseCalls);
   if (!m_hasResponse) {
+    NN_ENTER_RECURSION();
     // Set the response to 1 for bias nodes:
     if (isBiasNode()) {
       m_response = 1.0;
@@ -253,12 +272,16 @@ double Neuron::getResponse() {
 	double inputResponse = ((*axonIter)->getOriginNeuron())->getResponse();
 	currSum += (inputWeight * inputResponse);
       }
-      // Then get the result of the threshold function:
-      m_response = thresholdFunction(currSum);
-      m_responseDerivative = thresholdDerivative(currSum);
+      // Then get the result of the threshold function and its derivative:
+      Activation::evaluate(m_activation, currSum, m_response,
+			   m_responseDerivative);
       //m_sumOfResponses += currSum;
     }
     m_hasResponse = true;
+    NN_EXIT_RECURSION();
+  }
+  else {
+    NN_COUNT(kResponseHits);
   }
   return m_response;
 }
@@ -348,8 +371,7 @@ void Neuron::setLayerIndex(int layerIndex) {
    @param sum - The new sum of inputs to the Neuron.
 */
 void Neuron::setResponseWithSum(double sum) {
-  m_response = thresholdFunction(sum);
-  m_responseDerivative = thresholdDerivative(sum);
+  Activation::evaluate(m_activation, sum, m_response, m_responseDerivative);
   m_hasResponse = true;
 }
 
@@ -371,61 +393,3 @@ void Neuron::setTarget(double target) {
   }
   m_target = target;
 }
-
-/**
-   -----------------------------------------------------------------------------
-   Evaluate the derivative of the specified threshold function for a given sum.
-   @param sum - The sum of weights of the input connections.
-   @returns - The derivative of the response for a given sum.
-*/
-double Neuron::thresholdDerivative(double sum) {
-  if (m_function == "sigmoid") {
-    return (thresholdFunction(sum) * (1.0 - thresholdFunction(sum)));
-  }
-  else if (m_function == "tanh") {
-    return (-1.0 * thresholdFunction(sum) * thresholdFunction(sum));
-  }
-  else if (m_function == "linear") {
-    return 1.0;
-  }
-  else if (m_function == "sine") {
-    return ((3.141592653/2.0) * thresholdFunction(1.0 - sum));
-  }
-  else {
-    std::cout << "Neuron: must define derivative for function " << m_function 
-	      << std::endl;
-    exit(0);
-  }
-}
-
-/**
-   -----------------------------------------------------------------------------
-   Evaluate the threshold function to see whether the neuron should fire. The
-   threshold functions are defined to be on an interval x:[-1,+1] with an output
-   y:[-1,+1].
-   @param sum - The sum of weights of the input connections.
-   @returns - The response for a given sum.
-*/
-double Neuron::thresholdFunction(double sum) {
-  if (m_function == "sigmoid") {
-    return (1.0 / (1 + exp(-1.0*sum)));
-  }
-  else if (m_function == "tanh") {
-    return ((exp(sum) - exp(-1.0*sum)) / (exp(sum) + exp(-1.0*sum)));
-  }
-  else if (m_function == "linear") {
-    if (sum < -1.0) return -1.0;
-    else if (sum > 1.0) return 1.0;
-    else return sum;
-  }
-  else if (m_function == "sine") {
-    if (sum < 1.0) return -1.0;
-    else if (sum > 1.0) return 1.0;
-    else return sin(3.141592653*sum/2.0);
-  }
-  else {
-    std::cout << "Neuron: improperly assigned threshold function " << m_function
-	      << std::endl;
-    exit(0);
-  }
-}
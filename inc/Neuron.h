@@ -12,7 +12,9 @@
 #ifndef Neuron_h
 #define Neuron_h
 
+#include "Activation.h"
 #include "Axon.h"
+#include "Instrumentation.h"
 #include <iostream>
 #include <fstream>
 #include <math.h>
@@ -31,7 +33,9 @@ class Neuron {
   ~Neuron();
   
   // Public Accessors:
+  ActivationFunction getActivation();
   double getDelta();
+  std::string getFunction();
   int getLayerIndex();
   double getResponse();
   double getResponseDerivative();
@@ -60,14 +64,10 @@ class Neuron {
   
  private:
   
-  // Private functions:
-  double thresholdDerivative(double sum);
-  double thresholdFunction(double sum);
-  
   // Member objects:
   std::vector<Axon*> m_downstreamConnections;
   std::vector<Axon*> m_upstreamConnections;
-  std::string m_function;
+  ActivationFunction m_activation;
   
   int m_layerIndex;
   bool m_biasNode;
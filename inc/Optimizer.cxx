@@ -0,0 +1,521 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: Optimizer.cxx                                                       //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Weight-update rules for a contiguous block of parameters: plain SGD,      //
+//  momentum, Nesterov momentum, RMSProp and Adam. The optimizer state        //
+//  (velocities, first and second moments) is stored in arrays parallel to   //
+//  the parameters, and each step updates the state and the parameters in a  //
+//  single fused pass, with AVX-512 or AVX2 kernels when the CPU supports     //
+//  them (following Activation::getInstructionSet()) and a scalar fallback.   //
+//  All kernels perform the same operations in the same order, so their       //
+//  results are bit-identical.                                                //
+//                                                                            //
+//  With g = gradient / nEvents, lr the learning rate and t the step count:  //
+//                                                                            //
+//  - SGD:      w -= lr * g                                                   //
+//  - Momentum: v = mu * v + g;  w -= lr * v                                  //
+//  - Nesterov: v = mu * v + g;  w -= lr * (g + mu * v)                       //
+//  - RMSProp:  s = rho * s + (1 - rho) * g^2;  w -= lr * g / (sqrt(s) + eps) //
+//  - Adam:     m = b1 * m + (1 - b1) * g;  s = b2 * s + (1 - b2) * g^2;      //
+//              w -= lr * sqrt(1 - b2^t) / (1 - b1^t) * m / (sqrt(s) + eps)   //
+//                                                                            //
+//  A step over several slices of the parameters (e.g. one per thread) calls  //
+//  beginStep() once and then update() for each slice.                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Optimizer.h"
+#include <math.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define OPTIMIZER_X86
+#include <immintrin.h>
+#endif
+
+// The per-step constants of the update rules:
+struct UpdateCoefficients {
+  double sgdStep;// -lr / nEvents
+  double gradientScale;// 1 / nEvents
+  double step;// -lr, with the Adam bias correction
+  double decay;// mu, rho or b2
+  double decayComplement;// 1 - rho or 1 - b2
+  double beta1;
+  double beta1Complement;
+  double epsilon;
+};
+
+/**
+   -----------------------------------------------------------------------------
+   Scalar update of one parameter.
+*/
+static inline void updateScalar(OptimizerType type, const UpdateCoefficients &c,
+				double gradient, double &parameter,
+				double *firstMoment, double *secondMoment) {
+  double g = gradient * c.gradientScale;
+  switch (type) {
+  case kMomentum: {
+    *firstMoment = c.decay * (*firstMoment) + g;
+    parameter += c.step * (*firstMoment);
+    break;
+  }
+  case kNesterov: {
+    *firstMoment = c.decay * (*firstMoment) + g;
+    parameter += c.step * (g + c.decay * (*firstMoment));
+    break;
+  }
+  case kRMSProp: {
+    *secondMoment = c.decay * (*secondMoment) + c.decayComplement * (g * g);
+    parameter += c.step * (g / (sqrt(*secondMoment) + c.epsilon));
+    break;
+  }
+  case kAdam: {
+    *firstMoment = c.beta1 * (*firstMoment) + c.beta1Complement * g;
+    *secondMoment = c.decay * (*secondMoment) + c.decayComplement * (g * g);
+    parameter += c.step * (*firstMoment / (sqrt(*secondMoment) + c.epsilon));
+    break;
+  }
+  default: {
+    parameter += c.sgdStep * gradient;
+    break;
+  }
+  }
+}
+
+#ifdef OPTIMIZER_X86
+
+/**
+   -----------------------------------------------------------------------------
+   AVX2 kernel, 4 parameters per register.
+   @returns - The index of the first parameter that was not updated.
+*/
+__attribute__((target("avx2")))
+static int updateAVX2(OptimizerType type, const UpdateCoefficients &c,
+		      const double *gradient, double *parameters,
+		      double *firstMoments, double *secondMoments,
+		      int first, int last) {
+  __m256d sgdStep = _mm256_set1_pd(c.sgdStep);
+  __m256d gradientScale = _mm256_set1_pd(c.gradientScale);
+  __m256d step = _mm256_set1_pd(c.step);
+  __m256d decay = _mm256_set1_pd(c.decay);
+  __m256d decayComplement = _mm256_set1_pd(c.decayComplement);
+  __m256d beta1 = _mm256_set1_pd(c.beta1);
+  __m256d beta1Complement = _mm256_set1_pd(c.beta1Complement);
+  __m256d epsilon = _mm256_set1_pd(c.epsilon);
+  int i_p = first;
+  for (; i_p + 4 <= last; i_p += 4) {
+    __m256d rawGradient = _mm256_loadu_pd(&gradient[i_p]);
+    __m256d g = _mm256_mul_pd(rawGradient, gradientScale);
+    __m256d parameter = _mm256_loadu_pd(&parameters[i_p]);
+    switch (type) {
+    case kMomentum: {
+      __m256d v = _mm256_add_pd(_mm256_mul_pd(decay, _mm256_loadu_pd
+					      (&firstMoments[i_p])), g);
+      _mm256_storeu_pd(&firstMoments[i_p], v);
+      parameter = _mm256_add_pd(parameter, _mm256_mul_pd(step, v));
+      break;
+    }
+    case kNesterov: {
+      __m256d v = _mm256_add_pd(_mm256_mul_pd(decay, _mm256_loadu_pd
+					      (&firstMoments[i_p])), g);
+      _mm256_storeu_pd(&firstMoments[i_p], v);
+      parameter = _mm256_add_pd(parameter, _mm256_mul_pd
+				(step, _mm256_add_pd(g, _mm256_mul_pd(decay, v))));
+      break;
+    }
+    case kRMSProp: {
+      __m256d s = _mm256_add_pd(_mm256_mul_pd(decay, _mm256_loadu_pd
+					      (&secondMoments[i_p])),
+				_mm256_mul_pd(decayComplement,
+					      _mm256_mul_pd(g, g)));
+      _mm256_storeu_pd(&secondMoments[i_p], s);
+      __m256d denominator = _mm256_add_pd(_mm256_sqrt_pd(s), epsilon);
+      parameter = _mm256_add_pd(parameter, _mm256_mul_pd
+				(step, _mm256_div_pd(g, denominator)));
+      break;
+    }
+    case kAdam: {
+      __m256d m = _mm256_add_pd(_mm256_mul_pd(beta1, _mm256_loadu_pd
+					      (&firstMoments[i_p])),
+				_mm256_mul_pd(beta1Complement, g));
+      __m256d s = _mm256_add_pd(_mm256_mul_pd(decay, _mm256_loadu_pd
+					      (&secondMoments[i_p])),
+				_mm256_mul_pd(decayComplement,
+					      _mm256_mul_pd(g, g)));
+      _mm256_storeu_pd(&firstMoments[i_p], m);
+      _mm256_storeu_pd(&secondMoments[i_p], s);
+      __m256d denominator = _mm256_add_pd(_mm256_sqrt_pd(s), epsilon);
+      parameter = _mm256_add_pd(parameter, _mm256_mul_pd
+				(step, _mm256_div_pd(m, denominator)));
+      break;
+    }
+    default: {
+      parameter = _mm256_add_pd(parameter, _mm256_mul_pd(sgdStep, rawGradient));
+      break;
+    }
+    }
+    _mm256_storeu_pd(&parameters[i_p], parameter);
+  }
+  return i_p;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   AVX-512 kernel, 8 parameters per register. The contraction of mul + add is
+   disabled to stay bit-identical to the scalar code.
+   @returns - The index of the first parameter that was not updated.
+*/
+__attribute__((target("avx512f"), optimize("fp-contract=off")))
+static int updateAVX512(OptimizerType type, const UpdateCoefficients &c,
+			const double *gradient, double *parameters,
+			double *firstMoments, double *secondMoments,
+			int first, int last) {
+  __m512d sgdStep = _mm512_set1_pd(c.sgdStep);
+  __m512d gradientScale = _mm512_set1_pd(c.gradientScale);
+  __m512d step = _mm512_set1_pd(c.step);
+  __m512d decay = _mm512_set1_pd(c.decay);
+  __m512d decayComplement = _mm512_set1_pd(c.decayComplement);
+  __m512d beta1 = _mm512_set1_pd(c.beta1);
+  __m512d beta1Complement = _mm512_set1_pd(c.beta1Complement);
+  __m512d epsilon = _mm512_set1_pd(c.epsilon);
+  int i_p = first;
+  for (; i_p + 8 <= last; i_p += 8) {
+    __m512d rawGradient = _mm512_loadu_pd(&gradient[i_p]);
+    __m512d g = _mm512_mul_pd(rawGradient, gradientScale);
+    __m512d parameter = _mm512_loadu_pd(&parameters[i_p]);
+    switch (type) {
+    case kMomentum: {
+      __m512d v = _mm512_add_pd(_mm512_mul_pd(decay, _mm512_loadu_pd
+					      (&firstMoments[i_p])), g);
+      _mm512_storeu_pd(&firstMoments[i_p], v);
+      parameter = _mm512_add_pd(parameter, _mm512_mul_pd(step, v));
+      break;
+    }
+    case kNesterov: {
+      __m512d v = _mm512_add_pd(_mm512_mul_pd(decay, _mm512_loadu_pd
+					      (&firstMoments[i_p])), g);
+      _mm512_storeu_pd(&firstMoments[i_p], v);
+      parameter = _mm512_add_pd(parameter, _mm512_mul_pd
+				(step, _mm512_add_pd(g, _mm512_mul_pd(decay, v))));
+      break;
+    }
+    case kRMSProp: {
+      __m512d s = _mm512_add_pd(_mm512_mul_pd(decay, _mm512_loadu_pd
+					      (&secondMoments[i_p])),
+				_mm512_mul_pd(decayComplement,
+					      _mm512_mul_pd(g, g)));
+      _mm512_storeu_pd(&secondMoments[i_p], s);
+      // The all-lanes masked sqrt is _mm512_sqrt_pd without an undefined
+      // pass-through operand (which gcc warns about):
+      __m512d denominator
+	= _mm512_add_pd(_mm512_maskz_sqrt_pd(0xFF, s), epsilon);
+      parameter = _mm512_add_pd(parameter, _mm512_mul_pd
+				(step, _mm512_div_pd(g, denominator)));
+      break;
+    }
+    case kAdam: {
+      __m512d m = _mm512_add_pd(_mm512_mul_pd(beta1, _mm512_loadu_pd
+					      (&firstMoments[i_p])),
+				_mm512_mul_pd(beta1Complement, g));
+      __m512d s = _mm512_add_pd(_mm512_mul_pd(decay, _mm512_loadu_pd
+					      (&secondMoments[i_p])),
+				_mm512_mul_pd(decayComplement,
+					      _mm512_mul_pd(g, g)));
+      _mm512_storeu_pd(&firstMoments[i_p], m);
+      _mm512_storeu_pd(&secondMoments[i_p], s);
+      __m512d denominator
+	= _mm512_add_pd(_mm512_maskz_sqrt_pd(0xFF, s), epsilon);
+      parameter = _mm512_add_pd(parameter, _mm512_mul_pd
+				(step, _mm512_div_pd(m, denominator)));
+      break;
+    }
+    default: {
+      parameter = _mm512_add_pd(parameter, _mm512_mul_pd(sgdStep, rawGradient));
+      break;
+    }
+    }
+    _mm512_storeu_pd(&parameters[i_p], parameter);
+  }
+  return i_p;
+}
+
+#endif
+
+/**
+   -----------------------------------------------------------------------------
+   Optimizer constructor. The state starts at zero.
+   @param type - The update rule.
+   @param nParameters - The number of parameters to optimize.
+*/
+Optimizer::Optimizer(OptimizerType type, int nParameters) {
+  m_type = type;
+  m_nParameters = nParameters;
+  m_rate = 0.01;
+  m_momentum = 0.9;
+  m_decay = 0.9;
+  m_beta1 = 0.9;
+  m_beta2 = 0.999;
+  m_epsilon = 1e-8;
+  reset();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Optimizer destructor.
+*/
+Optimizer::~Optimizer() {
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Start a new step: advance the step count used by the Adam bias correction.
+   Call once per step, before update() of the slices of the parameters.
+*/
+void Optimizer::beginStep() {
+  m_nSteps++;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Get the update rule from its name.
+   @param name - "sgd", "momentum", "nesterov", "rmsprop" or "adam".
+   @returns - The update rule.
+*/
+OptimizerType Optimizer::fromName(std::string name) {
+  if (name == "sgd") return kSGD;
+  if (name == "momentum") return kMomentum;
+  if (name == "nesterov") return kNesterov;
+  if (name == "rmsprop") return kRMSProp;
+  if (name == "adam") return kAdam;
+  std::cout << "Optimizer: ERROR! Unknown optimizer " << name << std::endl;
+  exit(0);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The exponential decay of the Adam first moment.
+*/
+double Optimizer::getBeta1() {
+  return m_beta1;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The exponential decay of the Adam second moment.
+*/
+double Optimizer::getBeta2() {
+  return m_beta2;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The exponential decay of the RMSProp mean square.
+*/
+double Optimizer::getDecay() {
+  return m_decay;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The regulator of the RMSProp and Adam denominators.
+*/
+double Optimizer::getEpsilon() {
+  return m_epsilon;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The learning rate.
+*/
+double Optimizer::getLearningRate() {
+  return m_rate;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The momentum (momentum and Nesterov).
+*/
+double Optimizer::getMomentum() {
+  return m_momentum;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of parameters.
+*/
+int Optimizer::getNParameters() {
+  return m_nParameters;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of steps taken.
+*/
+int Optimizer::getNSteps() {
+  return m_nSteps;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The name of the update rule.
+*/
+std::string Optimizer::getName() {
+  return getName(m_type);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @param type - An update rule.
+   @returns - The name of the update rule.
+*/
+std::string Optimizer::getName(OptimizerType type) {
+  switch (type) {
+  case kMomentum: return "momentum";
+  case kNesterov: return "nesterov";
+  case kRMSProp: return "rmsprop";
+  case kAdam: return "adam";
+  default: return "sgd";
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The update rule.
+*/
+OptimizerType Optimizer::getType() {
+  return m_type;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Clear the optimizer state and the step count.
+*/
+void Optimizer::reset() {
+  m_nSteps = 0;
+  bool hasFirst = (m_type == kMomentum || m_type == kNesterov ||
+		   m_type == kAdam);
+  bool hasSecond = (m_type == kRMSProp || m_type == kAdam);
+  m_firstMoments.assign(hasFirst ? m_nParameters : 0, 0.0);
+  m_secondMoments.assign(hasSecond ? m_nParameters : 0, 0.0);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the exponential decay of the Adam first moment.
+   @param beta1 - The decay, in [0,1).
+*/
+void Optimizer::setBeta1(double beta1) {
+  m_beta1 = beta1;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the exponential decay of the Adam second moment.
+   @param beta2 - The decay, in [0,1).
+*/
+void Optimizer::setBeta2(double beta2) {
+  m_beta2 = beta2;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the exponential decay of the RMSProp mean square.
+   @param decay - The decay, in [0,1).
+*/
+void Optimizer::setDecay(double decay) {
+  m_decay = decay;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the regulator of the RMSProp and Adam denominators.
+   @param epsilon - The regulator.
+*/
+void Optimizer::setEpsilon(double epsilon) {
+  m_epsilon = epsilon;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the learning rate.
+   @param rate - The learning rate.
+*/
+void Optimizer::setLearningRate(double rate) {
+  m_rate = rate;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the momentum (momentum and Nesterov).
+   @param momentum - The momentum, in [0,1).
+*/
+void Optimizer::setMomentum(double momentum) {
+  m_momentum = momentum;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Take a whole step: beginStep(), then update all of the parameters.
+   @param parameters - The parameters (updated in place).
+   @param gradient - The gradient, summed over nEvents events.
+   @param nEvents - The number of events in the gradient.
+*/
+void Optimizer::update(double *parameters, const double *gradient,
+		       int nEvents) {
+  beginStep();
+  update(parameters, gradient, nEvents, 0, m_nParameters);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Update a slice of the parameters and of the optimizer state in one pass.
+   Different slices of the same step may be updated concurrently.
+   @param parameters - The parameters (updated in place).
+   @param gradient - The gradient, summed over nEvents events.
+   @param nEvents - The number of events in the gradient.
+   @param firstParameter - The index of the first parameter of the slice.
+   @param lastParameter - One past the index of the last parameter.
+*/
+void Optimizer::update(double *parameters, const double *gradient,
+		       int nEvents, int firstParameter, int lastParameter) {
+  if (nEvents <= 0 || firstParameter >= lastParameter) return;
+  UpdateCoefficients c;
+  c.sgdStep = -1.0 * m_rate / ((double)nEvents);
+  c.gradientScale = 1.0 / ((double)nEvents);
+  c.step = -1.0 * m_rate;
+  c.decay = (m_type == kRMSProp) ? m_decay :
+    ((m_type == kAdam) ? m_beta2 : m_momentum);
+  c.decayComplement = 1.0 - c.decay;
+  c.beta1 = m_beta1;
+  c.beta1Complement = 1.0 - m_beta1;
+  c.epsilon = m_epsilon;
+  if (m_type == kAdam) {
+    int nSteps = (m_nSteps > 0) ? m_nSteps : 1;
+    c.step *= (sqrt(1.0 - pow(m_beta2, nSteps)) /
+	       (1.0 - pow(m_beta1, nSteps)));
+  }
+  double *firstMoments = m_firstMoments.data();
+  double *secondMoments = m_secondMoments.data();
+
+  int i_p = firstParameter;
+#ifdef OPTIMIZER_X86
+  InstructionSet instructionSet = Activation::getInstructionSet();
+  if (instructionSet == kAVX512) {
+    i_p = updateAVX512(m_type, c, gradient, parameters, firstMoments,
+		       secondMoments, i_p, lastParameter);
+  }
+  else if (instructionSet == kAVX2) {
+    i_p = updateAVX2(m_type, c, gradient, parameters, firstMoments,
+		     secondMoments, i_p, lastParameter);
+  }
+#endif
+  for (; i_p < lastParameter; i_p++) {
+    updateScalar(m_type, c, gradient[i_p], parameters[i_p],
+		 firstMoments ? &firstMoments[i_p] : NULL,
+		 secondMoments ? &secondMoments[i_p] : NULL);
+  }
+}
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: Optimizer.h                                                         //
+//  Class: Optimizer.cxx                                                      //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef Optimizer_h
+#define Optimizer_h
+
+#include "Activation.h"
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+// Weight-update rules:
+enum OptimizerType { kSGD, kMomentum, kNesterov, kRMSProp, kAdam };
+
+class Optimizer
+{
+
+ public:
+
+  Optimizer(OptimizerType type, int nParameters);
+  ~Optimizer();
+
+  // Accessors:
+  double getBeta1();
+  double getBeta2();
+  double getDecay();
+  double getEpsilon();
+  double getLearningRate();
+  double getMomentum();
+  int getNParameters();
+  int getNSteps();
+  std::string getName();
+  OptimizerType getType();
+
+  // Mutators:
+  void beginStep();
+  void reset();
+  void setBeta1(double beta1);
+  void setBeta2(double beta2);
+  void setDecay(double decay);
+  void setEpsilon(double epsilon);
+  void setLearningRate(double rate);
+  void setMomentum(double momentum);
+  void update(double *parameters, const double *gradient, int nEvents);
+  void update(double *parameters, const double *gradient, int nEvents,
+	      int firstParameter, int lastParameter);
+
+  // Static functions:
+  static OptimizerType fromName(std::string name);
+  static std::string getName(OptimizerType type);
+
+ private:
+
+  // Member objects:
+  OptimizerType m_type;
+  int m_nParameters;
+  int m_nSteps;
+  double m_rate;
+  double m_momentum;// Momentum and Nesterov
+  double m_decay;// RMSProp
+  double m_beta1;
+  double m_beta2;
+  double m_epsilon;
+
+  // Optimizer state, parallel to the parameters: the velocity (momentum,
+  // Nesterov) or first moment (Adam), and the mean square (RMSProp) or
+  // second moment (Adam):
+  std::vector<double> m_firstMoments;
+  std::vector<double> m_secondMoments;
+
+};
+
+#endif
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: SeparationMetrics.cxx                                               //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Measures of how well the first output of a network separates signal from  //
+//  background, for comparing the scores of the same events in different      //
+//  precisions or after pruning. Events with a first target > 0 are signal,   //
+//  and the outputs are row-major, nOutputs per event, as returned by         //
+//  getBatchResponse().                                                       //
+//                                                                            //
+//  - The ROC area is the fraction of signal/background pairs in which the    //
+//    signal event has the higher score, with a tied pair counting 1/2, so    //
+//    that it does not depend on the order of events with equal scores        //
+//    (quantized scores have many ties).                                      //
+//  - The separation is the TMVA <S^2> of the weighted, normalized score      //
+//    distributions in 100 bins over [-1,1].                                  //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "SeparationMetrics.h"
+
+/**
+   -----------------------------------------------------------------------------
+   The area under the ROC curve of the first output. The events are sorted by
+   score and each run of equal scores is counted at once: a signal event in the
+   run is above every background event below the run and tied with those in it.
+   @param block - The events.
+   @param outputs - The network outputs of the events.
+   @param nOutputs - The number of outputs per event.
+   @returns - The ROC area, from 0 to 1.
+*/
+double SeparationMetrics::getROCArea(const EventBlock &block,
+				     const std::vector<double> &outputs,
+				     int nOutputs) {
+  std::vector<std::pair<double,int> > scores;
+  std::vector<double> targets(block.getNTargets());
+  for (int i_e = 0; i_e < block.getNEvents(); i_e++) {
+    block.getTargets(i_e, &targets[0]);
+    scores.push_back(std::make_pair(outputs[i_e * nOutputs],
+				    (targets[0] > 0.0) ? 1 : 0));
+  }
+  std::sort(scores.begin(), scores.end());
+  double nSignal = 0.0;
+  double nBackground = 0.0;
+  double area = 0.0;
+  int runStart = 0;
+  while (runStart < (int)scores.size()) {
+    double nRunSignal = 0.0;
+    double nRunBackground = 0.0;
+    int runEnd = runStart;
+    while (runEnd < (int)scores.size() &&
+	   scores[runEnd].first == scores[runStart].first) {
+      if (scores[runEnd].second == 1) nRunSignal++;
+      else nRunBackground++;
+      runEnd++;
+    }
+    area += nRunSignal * (nBackground + 0.5 * nRunBackground);
+    nSignal += nRunSignal;
+    nBackground += nRunBackground;
+    runStart = runEnd;
+  }
+  if (nSignal == 0.0 || nBackground == 0.0) {
+    std::cout << "SeparationMetrics: ERROR! The ROC area needs signal and "
+	      << "background events." << std::endl;
+    exit(0);
+  }
+  return (area / (nSignal * nBackground));
+}
+
+/**
+   -----------------------------------------------------------------------------
+   The TMVA separation <S^2> of the first output over [-1,1], using 100 bins:
+   0.5 * sum (s - b)^2 / (s + b) for the normalized, weighted distributions.
+   Scores outside the range are put in the first or last bin.
+   @param block - The events.
+   @param outputs - The network outputs of the events.
+   @param nOutputs - The number of outputs per event.
+   @returns - The separation, from 0 (identical) to 1 (disjoint).
+*/
+double SeparationMetrics::getSeparation(const EventBlock &block,
+					const std::vector<double> &outputs,
+					int nOutputs) {
+  const int nBins = 100;
+  std::vector<double> signal(nBins, 0.0), background(nBins, 0.0);
+  std::vector<double> targets(block.getNTargets());
+  double sumSignal = 0.0;
+  double sumBackground = 0.0;
+  for (int i_e = 0; i_e < block.getNEvents(); i_e++) {
+    block.getTargets(i_e, &targets[0]);
+    int bin = (int)((outputs[i_e * nOutputs] + 1.0) * 0.5 * nBins);
+    bin = std::max(0, std::min(nBins - 1, bin));
+    if (targets[0] > 0.0) {
+      signal[bin] += block.getWeight(i_e);
+      sumSignal += block.getWeight(i_e);
+    }
+    else {
+      background[bin] += block.getWeight(i_e);
+      sumBackground += block.getWeight(i_e);
+    }
+  }
+  if (sumSignal <= 0.0 || sumBackground <= 0.0) {
+    std::cout << "SeparationMetrics: ERROR! The separation needs signal and "
+	      << "background events." << std::endl;
+    exit(0);
+  }
+  double separation = 0.0;
+  for (int i_b = 0; i_b < nBins; i_b++) {
+    double s = signal[i_b] / sumSignal;
+    double b = background[i_b] / sumBackground;
+    if (s + b > 0.0) separation += 0.5 * (s - b) * (s - b) / (s + b);
+  }
+  return separation;
+}
@@ -0,0 +1,35 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: SeparationMetrics.h                                                 //
+//  Class: SeparationMetrics.cxx                                              //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SeparationMetrics_h
+#define SeparationMetrics_h
+
+#include "EventBlock.h"
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+class SeparationMetrics
+{
+
+ public:
+
+  // Static functions:
+  static double getROCArea(const EventBlock &block,
+			   const std::vector<double> &outputs, int nOutputs);
+  static double getSeparation(const EventBlock &block,
+			      const std::vector<double> &outputs,
+			      int nOutputs);
+
+};
+
+#endif
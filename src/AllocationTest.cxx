@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: AllocationTest.cxx                                                  //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Checks that NeuralNetwork::getNetworkResponse(const double*, double*)     //
+//  makes no heap allocation, for a network with one heap allocation per      //
+//  Neuron and Axon and for one in an Arena. 1000 events are scored in each   //
+//  mode while the counting operator new of an instrumented build is          //
+//  watching. The program prints one line per mode and exits with status 1 if //
+//  any allocation happens. In a build that is not instrumented it prints     //
+//  that it is skipped and exits with status 0.                               //
+//                                                                            //
+//  Usage: make test INSTRUMENTATION=1                                        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Instrumentation.h"
+#include "NeuralNetwork.h"
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/**
+   -----------------------------------------------------------------------------
+   Score events with a new network and count the heap allocations.
+   @param useArena - True to allocate the Neurons and Axons in an Arena.
+   @param nEvents - The number of events.
+   @returns - The number of heap allocations while scoring.
+*/
+long countAllocations(bool useArena, int nEvents) {
+  const int nInputs = 10;
+  const int nOutputs = 2;
+  NeuralNetwork network(nInputs, nOutputs, 3, 16, useArena);
+  network.randomizeNetworkWeights(1);
+  std::vector<double> events(nEvents * nInputs);
+  for (int i_v = 0; i_v < nEvents * nInputs; i_v++) {
+    events[i_v] = (i_v % 17) / 8.0 - 1.0;
+  }
+  std::vector<double> outputs(nEvents * nOutputs);
+  long nAllocations = Instrumentation::getNAllocations();
+  for (int i_e = 0; i_e < nEvents; i_e++) {
+    network.getNetworkResponse(&events[i_e * nInputs],
+			       &outputs[i_e * nOutputs]);
+  }
+  return (Instrumentation::getNAllocations() - nAllocations);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Main method: score events in heap and arena mode.
+*/
+int main() {
+  if (!Instrumentation::isEnabled()) {
+    std::cout << "AllocationTest: skipped, allocations are only counted in a "
+	      << "build with INSTRUMENTATION=1." << std::endl;
+    return 0;
+  }
+  const int nEvents = 1000;
+  long heapAllocations = countAllocations(false, nEvents);
+  long arenaAllocations = countAllocations(true, nEvents);
+  printf("AllocationTest: heap mode %ld allocations in %d events\n",
+	 heapAllocations, nEvents);
+  printf("AllocationTest: arena mode %ld allocations in %d events\n",
+	 arenaAllocations, nEvents);
+  if (heapAllocations != 0 || arenaAllocations != 0) {
+    std::cout << "AllocationTest: FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "AllocationTest: passed" << std::endl;
+  return 0;
+}
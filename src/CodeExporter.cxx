@@ -0,0 +1,387 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: CodeExporter.cxx                                                    //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class turns a trained network into standalone C++ inference code:   //
+//  a single header with the weights as constexpr arrays and one inline       //
+//  evaluate() function in which every layer is written out node by node. It  //
+//  needs nothing but a C++11 compiler, so it can be dropped into trigger or  //
+//  skimming code that cannot link this project (or ROOT).                    //
+//                                                                            //
+//  The generated code repeats the arithmetic of CompiledNetwork in the same  //
+//  order (inputs summed in ascending order, then the bias) and carries its   //
+//  own copy of the scalar activation functions of Activation.cxx, so its     //
+//  responses are identical to getNetworkResponse(). Weights are printed with //
+//  17 significant digits, which reproduces every double exactly.             //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CodeExporter.h"
+#include <ctype.h>
+#include <fstream>
+#include <math.h>
+#include <stdio.h>
+
+// Number of values or terms per line of generated code:
+static const int kValuesPerLine = 3;
+
+// The activation functions and the normalization transforms of the generated
+// code. These must stay in step with Activation.cxx and InputNormalization.cxx.
+static const char kGeneratedFunctions[] = R"CODE(
+// Activation functions, as in Activation.cxx. exp(x) = 2^n * exp(r), with
+// n = round(x / ln2) and |r| <= ln2 / 2:
+constexpr double kExpMax = 708.0;
+constexpr double kLog2E = 1.4426950408889634;
+constexpr double kLn2Hi = 6.93145751953125e-1;
+constexpr double kLn2Lo = 1.42860682030941723212e-6;
+constexpr double kRoundMagic = 6755399441055744.0;
+constexpr int kNExpTerms = 14;
+constexpr double kExpTerms[kNExpTerms] = {
+  1.0, 1.0, 1.0/2.0, 1.0/6.0, 1.0/24.0, 1.0/120.0, 1.0/720.0, 1.0/5040.0,
+  1.0/40320.0, 1.0/362880.0, 1.0/3628800.0, 1.0/39916800.0,
+  1.0/479001600.0, 1.0/6227020800.0
+};
+constexpr double kHalfPi = 1.5707963267948966;
+constexpr int kNSinTerms = 11;
+constexpr double kSinTerms[kNSinTerms] = {
+  1.0, -1.0/6.0, 1.0/120.0, -1.0/5040.0, 1.0/362880.0, -1.0/39916800.0,
+  1.0/6227020800.0, -1.0/1307674368000.0, 1.0/355687428096000.0,
+  -1.0/121645100408832000.0, 1.0/51090942171709440000.0
+};
+
+inline double exponential(double x) {
+  x = (x < kExpMax) ? x : kExpMax;
+  x = (x > -kExpMax) ? x : -kExpMax;
+  double t = x * kLog2E + kRoundMagic;
+  double n = t - kRoundMagic;
+  double r = x - n * kLn2Hi;
+  r = r - n * kLn2Lo;
+  double p = kExpTerms[kNExpTerms-1];
+  for (int i_t = kNExpTerms-2; i_t >= 0; i_t--) p = p * r + kExpTerms[i_t];
+  long long tBits, magicBits;
+  memcpy(&tBits, &t, sizeof(double));
+  memcpy(&magicBits, &kRoundMagic, sizeof(double));
+  long long scaleBits = ((tBits - magicBits) + 1023) << 52;
+  double scale;
+  memcpy(&scale, &scaleBits, sizeof(double));
+  return p * scale;
+}
+
+inline double linear(double sum) {
+  double value = (sum < 1.0) ? sum : 1.0;
+  return (value > -1.0) ? value : -1.0;
+}
+
+inline double sigmoid(double sum) {
+  return 1.0 / (1.0 + exponential(-sum));
+}
+
+inline double hyperbolicTangent(double sum) {
+  double e = exponential(sum + sum);
+  return 1.0 - 2.0 / (e + 1.0);
+}
+
+inline double sine(double sum) {
+  if (sum < -1.0) return -1.0;
+  if (sum > 1.0) return 1.0;
+  double x = (sum < 1.0) ? sum : 1.0;
+  x = (x > -1.0) ? x : -1.0;
+  double y = x * kHalfPi;
+  double y2 = y * y;
+  double s = kSinTerms[kNSinTerms-1];
+  for (int i_t = kNSinTerms-2; i_t >= 0; i_t--) s = s * y2 + kSinTerms[i_t];
+  return y * s;
+}
+
+// Input normalization, as in InputNormalization.cxx:
+inline double rangeNormalize(double value, double minimum, double scale) {
+  value = (value - minimum) * scale + (scale != 0.0 ? -1.0 : 0.0);
+  value = (value < 1.0) ? value : 1.0;
+  return (value > -1.0) ? value : -1.0;
+}
+
+inline double quantileNormalize(double value, const double *knots,
+				int nSegments) {
+  if (knots[0] == knots[nSegments]) return 0.0;
+  if (!(value > knots[0])) return -1.0;
+  if (!(value < knots[nSegments])) return 1.0;
+  int low = 0;
+  int high = nSegments;
+  while (high - low > 1) {
+    int middle = (low + high) / 2;
+    if (knots[middle] <= value) low = middle;
+    else high = middle;
+  }
+  double fraction = (value - knots[low]) / (knots[high] - knots[low]);
+  return (-1.0 + (2.0 * (low + fraction) / nSegments));
+}
+)CODE";
+
+/**
+   -----------------------------------------------------------------------------
+   @param function - An activation function.
+   @returns - The name of the function that evaluates it in generated code.
+*/
+static std::string getGeneratedName(ActivationFunction function) {
+  switch (function) {
+  case kSigmoid: return "sigmoid";
+  case kTanh: return "hyperbolicTangent";
+  case kSine: return "sine";
+  default: return "linear";
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   CodeExporter constructor.
+   @param network - The compiled network to export. It must outlive the
+   exporter.
+*/
+CodeExporter::CodeExporter(CompiledNetwork *network) {
+  m_network = network;
+  m_ownsNetwork = false;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   CodeExporter constructor. Compiles the network once; the exporter does not
+   see later changes to its weights.
+   @param network - The trained network to export.
+*/
+CodeExporter::CodeExporter(NeuralNetwork *network) {
+  m_network = new CompiledNetwork(network);
+  m_ownsNetwork = true;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   CodeExporter destructor.
+*/
+CodeExporter::~CodeExporter() {
+  if (m_ownsNetwork) delete m_network;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Generate the inference code. The header defines namespace <name> with
+   kNInputs, kNOutputs and
+     inline void evaluate(const double *vars, double *outputs);
+   plus, for a single output, inline double evaluate(const double *vars).
+   @param name - The namespace and include guard of the code (an identifier).
+   @returns - The text of the header.
+*/
+std::string CodeExporter::getCode(std::string name) {
+  bool isIdentifier = (name.size() > 0 && !isdigit(name[0]));
+  for (int i_c = 0; i_c < (int)name.size(); i_c++) {
+    if (!isalnum(name[i_c]) && name[i_c] != '_') isIdentifier = false;
+  }
+  if (!isIdentifier) {
+    std::cout << "CodeExporter: ERROR! " << name << " is not an identifier."
+	      << std::endl;
+    exit(0);
+  }
+  int nLayers = m_network->getNLayers();
+  int nOutputs = m_network->getNOutputs();
+  std::ostringstream topology;
+  for (int i_l = 0; i_l < nLayers; i_l++) {
+    topology << (i_l > 0 ? "-" : "") << m_network->getLayerSize(i_l);
+  }
+
+  std::ostringstream code;
+  code << "// " << name << ".h" << std::endl
+       << "//" << std::endl
+       << "// Generated by CodeExporter from a network with layer sizes "
+       << topology.str() << "." << std::endl
+       << "// Standalone: needs only a C++11 compiler. The responses are "
+       << "identical to" << std::endl
+       << "// NeuralNetwork::getNetworkResponse() as long as floating-point "
+       << "contraction" << std::endl
+       << "// is off (add -ffp-contract=off when compiling for FMA targets)."
+       << std::endl
+       << "//" << std::endl
+       << "//   double outputs[" << name << "::kNOutputs];" << std::endl
+       << "//   " << name << "::evaluate(vars, outputs);" << std::endl
+       << std::endl
+       << "#ifndef " << name << "_h" << std::endl
+       << "#define " << name << "_h" << std::endl
+       << std::endl
+       << "#include <string.h>" << std::endl
+       << std::endl
+       << "namespace " << name << " {" << std::endl
+       << std::endl
+       << "const int kNInputs = " << m_network->getNInputs() << ";" << std::endl
+       << "const int kNOutputs = " << nOutputs << ";" << std::endl
+       << kGeneratedFunctions << std::endl;
+
+  // The parameters:
+  writeNormalization(code);
+  std::vector<double> parameters = m_network->getParameters();
+  for (int i_l = 1; i_l < nLayers; i_l++) {
+    std::ostringstream weightName, biasName;
+    weightName << "kWeights" << i_l;
+    biasName << "kBiases" << i_l;
+    code << "// Layer " << i_l << ": " << m_network->getLayerSize(i_l) << " "
+	 << Activation::getName(m_network->getLayerFunction(i_l))
+	 << " nodes, weights [node x input]:" << std::endl;
+    writeArray(code, weightName.str(),
+	       &parameters[m_network->getWeightOffset(i_l)],
+	       m_network->getLayerSize(i_l) * m_network->getLayerSize(i_l-1));
+    writeArray(code, biasName.str(),
+	       &parameters[m_network->getBiasOffset(i_l)],
+	       m_network->getLayerSize(i_l));
+  }
+
+  // The network, one statement per node:
+  code << "inline void evaluate(const double *vars, double *outputs) {"
+       << std::endl;
+  for (int i_l = 0; i_l < nLayers; i_l++) writeLayer(code, i_l);
+  for (int i_o = 0; i_o < nOutputs; i_o++) {
+    code << "  outputs[" << i_o << "] = a" << nLayers-1 << "[" << i_o << "];"
+	 << std::endl;
+  }
+  code << "}" << std::endl << std::endl;
+  if (nOutputs == 1) {
+    code << "inline double evaluate(const double *vars) {" << std::endl
+	 << "  double output;" << std::endl
+	 << "  evaluate(vars, &output);" << std::endl
+	 << "  return output;" << std::endl
+	 << "}" << std::endl << std::endl;
+  }
+  code << "}" << std::endl << std::endl
+       << "#endif" << std::endl;
+  return code.str();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Generate the inference code and save it as a header.
+   @param fileName - The name of the header to create.
+   @param name - The namespace and include guard of the code (an identifier).
+*/
+void CodeExporter::write(std::string fileName, std::string name) {
+  std::string code = getCode(name);
+  std::ofstream file(fileName.c_str());
+  if (!file) {
+    std::cout << "CodeExporter: ERROR! Cannot create " << fileName << std::endl;
+    exit(0);
+  }
+  file << code;
+  file.close();
+  if (file.fail()) {
+    std::cout << "CodeExporter: ERROR! Failed to write " << fileName
+	      << std::endl;
+    exit(0);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Write a constexpr array with enough digits to reproduce every value exactly.
+   @param code - The code being generated.
+   @param arrayName - The name of the array.
+   @param values - The values.
+   @param n - The number of values.
+*/
+void CodeExporter::writeArray(std::ostringstream &code, std::string arrayName,
+			      const double *values, int n) {
+  code << "constexpr double " << arrayName << "[" << n << "] = {";
+  for (int i_v = 0; i_v < n; i_v++) {
+    if (!isfinite(values[i_v])) {
+      std::cout << "CodeExporter: ERROR! " << arrayName << " is not finite."
+		<< std::endl;
+      exit(0);
+    }
+    char text[32];
+    snprintf(text, sizeof(text), "%.17g", values[i_v]);
+    code << ((i_v % kValuesPerLine == 0) ? "\n  " : " ") << text
+	 << ((i_v < n-1) ? "," : "");
+  }
+  code << std::endl << "};" << std::endl << std::endl;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Write the statements that fill the responses a<layerIndex>[] of one layer.
+   Each node sums its inputs in ascending order and then adds its bias, exactly
+   as CompiledNetwork does; the input layer loads (and normalizes) the vars.
+   @param code - The code being generated.
+   @param layerIndex - The index of the layer.
+*/
+void CodeExporter::writeLayer(std::ostringstream &code, int layerIndex) {
+  int nNodes = m_network->getLayerSize(layerIndex);
+  std::string function
+    = getGeneratedName(m_network->getLayerFunction(layerIndex));
+  code << "  double a" << layerIndex << "[" << nNodes << "];" << std::endl;
+  if (layerIndex == 0) {
+    const InputNormalization &normalization
+      = m_network->getInputNormalization();
+    for (int i_n = 0; i_n < nNodes; i_n++) {
+      code << "  a0[" << i_n << "] = " << function << "(";
+      if (!normalization.isActive()) {
+	code << "vars[" << i_n << "]";
+      }
+      else if (normalization.getType() == kRangeNormalization) {
+	code << "rangeNormalize(vars[" << i_n << "], kInputMinima[" << i_n
+	     << "], kInputScales[" << i_n << "])";
+      }
+      else {
+	code << "quantileNormalize(vars[" << i_n << "], &kInputKnots["
+	     << i_n * (normalization.getNSegments()+1) << "], kNSegments)";
+      }
+      code << ");" << std::endl;
+    }
+    return;
+  }
+  int nInputs = m_network->getLayerSize(layerIndex-1);
+  for (int i_n = 0; i_n < nNodes; i_n++) {
+    code << "  a" << layerIndex << "[" << i_n << "] = " << function
+	 << "(0.0";
+    for (int i_i = 0; i_i < nInputs; i_i++) {
+      code << (((i_i+1) % kValuesPerLine == 0) ? "\n    " : " ")
+	   << "+ kWeights" << layerIndex << "[" << i_n * nInputs + i_i
+	   << "] * a" << layerIndex-1 << "[" << i_i << "]";
+    }
+    code << "\n    + kBiases" << layerIndex << "[" << i_n << "]);"
+	 << std::endl;
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Write the constants of the input normalization, if there is one. The range
+   transform is stored as the minimum and the scale of each variable, the
+   quantile transform as the knots.
+   @param code - The code being generated.
+*/
+void CodeExporter::writeNormalization(std::ostringstream &code) {
+  const InputNormalization &normalization = m_network->getInputNormalization();
+  if (!normalization.isActive()) return;
+  int nInputs = m_network->getNInputs();
+  int nSegments = normalization.getNSegments();
+  if (normalization.getType() == kRangeNormalization) {
+    std::vector<double> minima(nInputs), scales(nInputs);
+    for (int i_v = 0; i_v < nInputs; i_v++) {
+      std::vector<double> knots = normalization.getKnots(i_v);
+      minima[i_v] = knots[0];
+      scales[i_v] = (knots[1] > knots[0]) ? 2.0 / (knots[1] - knots[0]) : 0.0;
+    }
+    code << "// Input normalization onto [-1,+1]:" << std::endl;
+    writeArray(code, "kInputMinima", &minima[0], nInputs);
+    writeArray(code, "kInputScales", &scales[0], nInputs);
+  }
+  else {
+    std::vector<double> knots;
+    for (int i_v = 0; i_v < nInputs; i_v++) {
+      std::vector<double> variableKnots = normalization.getKnots(i_v);
+      knots.insert(knots.end(), variableKnots.begin(), variableKnots.end());
+    }
+    code << "// Input normalization onto [-1,+1], " << nSegments
+	 << " quantiles per variable:" << std::endl
+	 << "const int kNSegments = " << nSegments << ";" << std::endl;
+    writeArray(code, "kInputKnots", &knots[0], (int)knots.size());
+  }
+}
@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: CodeExporter.h                                                      //
+//  Class: CodeExporter.cxx                                                   //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CodeExporter_h
+#define CodeExporter_h
+
+#include "Activation.h"
+#include "CompiledNetwork.h"
+#include "InputNormalization.h"
+#include "NeuralNetwork.h"
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+class CodeExporter
+{
+
+ public:
+
+  CodeExporter(CompiledNetwork *network);
+  CodeExporter(NeuralNetwork *network);
+  ~CodeExporter();
+
+  // Accessors:
+  std::string getCode(std::string name);
+  void write(std::string fileName, std::string name);
+
+ private:
+
+  // Private functions:
+  void writeArray(std::ostringstream &code, std::string arrayName,
+		  const double *values, int n);
+  void writeLayer(std::ostringstream &code, int layerIndex);
+  void writeNormalization(std::ostringstream &code);
+
+  // Member objects:
+  CompiledNetwork *m_network;
+  bool m_ownsNetwork;
+
+};
+
+#endif
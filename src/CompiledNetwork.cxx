@@ -0,0 +1,951 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: CompiledNetwork.cxx                                                 //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class "compiles" a NeuralNetwork built from Neuron and Axon objects  //
+//  into contiguous per-layer weight matrices and bias vectors. The forward   //
+//  pass then walks the layers in order over flat arrays instead of chasing   //
+//  Axon pointers through the graph. The Neuron/Axon graph remains the source //
+//  of truth: call compile() again after the graph weights change.            //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CompiledNetwork.h"
+
+const int CompiledNetwork::kBlockSize;
+
+/**
+   -----------------------------------------------------------------------------
+   CompiledNetwork constructor. Compiles the given network immediately.
+   @param network - The NeuralNetwork to compile.
+*/
+CompiledNetwork::CompiledNetwork(NeuralNetwork *network) {
+  m_nLayers = 0;
+  m_nParameters = 0;
+  m_parameterData = NULL;
+  m_precision = kDoublePrecision;
+  compile(network);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   CompiledNetwork constructor from a stored topology and parameter block, such
+   as a ModelFile. With shareParameters the network evaluates directly from the
+   given block, which must outlive the network and is never written (the
+   network is read-only and cannot be trained). Otherwise the block is copied.
+   @param layerSizes - The number of nodes per layer (index 0 is the input).
+   @param layerFunctions - The activation function of each layer.
+   @param layerHasBias - True for the layers with a bias vector.
+   @param normalization - The transform of the raw input variables.
+   @param parameters - The weights and biases, laid out like getParameters().
+   @param shareParameters - True to use the parameters in place.
+*/
+CompiledNetwork::CompiledNetwork(std::vector<int> layerSizes,
+				 std::vector<ActivationFunction> layerFunctions,
+				 std::vector<bool> layerHasBias,
+				 const InputNormalization &normalization,
+				 const double *parameters,
+				 bool shareParameters) {
+  if (layerSizes.size() < 2 || layerFunctions.size() != layerSizes.size() ||
+      layerHasBias.size() != layerSizes.size()) {
+    std::cout << "CompiledNetwork: ERROR! Inconsistent topology." << std::endl;
+    exit(0);
+  }
+  m_normalization = normalization;
+  m_precision = kDoublePrecision;
+  setTopology(layerSizes, layerFunctions);
+  m_layerHasBias = layerHasBias;
+  if (shareParameters) {
+    std::vector<double>().swap(m_parameters);
+    m_parameterData = parameters;
+  }
+  else {
+    for (int i_p = 0; i_p < m_nParameters; i_p++) {
+      m_parameters[i_p] = parameters[i_p];
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   CompiledNetwork destructor. All storage is owned by member vectors.
+*/
+CompiledNetwork::~CompiledNetwork() {
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Back-propagate the errors of one event and add the resulting gradient of
+   E = 0.5 * sum (response - target)^2 to the gradient buffer of the state. The
+   weights are not modified, and all scratch lives in the state, so several
+   threads may call this concurrently with their own NetworkState. Layers that
+   have no bias node upstream get no bias gradient. With kSinglePrecision the
+   event is back-propagated in float (see the float overload below).
+   @param vars - The nInputs input variables.
+   @param targets - The nOutputs target values.
+   @param state - The scratch and gradient buffer to use.
+   @returns - The loss of the event.
+*/
+double CompiledNetwork::accumulateGradient(const double *vars,
+					   const double *targets,
+					   NetworkState *state) const {
+  if (m_precision == kSinglePrecision) {
+    return accumulateGradient(vars, targets, 1.0, state,
+			      &m_floatParameters[0]);
+  }
+  return accumulateGradient(vars, targets, state, m_parameterData);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   As above, but evaluate the network with a different set of weights laid out
+   like getParameters(), such as a thread-local replica.
+   @param vars - The nInputs input variables.
+   @param targets - The nOutputs target values.
+   @param state - The scratch and gradient buffer to use.
+   @param parameters - The weights and biases to use.
+   @returns - The loss of the event.
+*/
+double CompiledNetwork::accumulateGradient(const double *vars,
+					   const double *targets,
+					   NetworkState *state,
+					   const double *parameters) const {
+  return accumulateGradient(vars, targets, 1.0, state, parameters);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   As above, for a weighted event: the loss and the gradient of the event are
+   multiplied by its weight.
+   @param vars - The nInputs input variables.
+   @param targets - The nOutputs target values.
+   @param weight - The weight of the event.
+   @param state - The scratch and gradient buffer to use.
+   @param parameters - The weights and biases to use.
+   @returns - The weighted loss of the event.
+*/
+double CompiledNetwork::accumulateGradient(const double *vars,
+					   const double *targets, double weight,
+					   NetworkState *state,
+					   const double *parameters) const {
+  double loss = backPropagate(vars, targets, weight, parameters,
+			      &state->m_responses[0], &state->m_derivatives[0],
+			      &state->m_deltas[0], &state->m_gradient[0]);
+  state->m_loss += loss;
+  return loss;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   As above, in mixed precision: the event is propagated forwards and backwards
+   in float with a float copy of the weights, such as the replica kept by a
+   ParallelTrainer, while the gradient and the loss are still summed in double.
+   The float scratch of the state is allocated on the first call.
+   @param vars - The nInputs input variables.
+   @param targets - The nOutputs target values.
+   @param weight - The weight of the event.
+   @param state - The scratch and gradient buffer to use.
+   @param parameters - The float weights and biases to use.
+   @returns - The weighted loss of the event.
+*/
+double CompiledNetwork::accumulateGradient(const double *vars,
+					   const double *targets, double weight,
+					   NetworkState *state,
+					   const float *parameters) const {
+  if (state->m_floatResponses.size() != state->m_responses.size()) {
+    state->m_floatResponses.assign(state->m_responses.size(), 0.0);
+    state->m_floatDerivatives.assign(state->m_responses.size(), 0.0);
+    state->m_floatDeltas.assign(state->m_responses.size(), 0.0);
+  }
+  double loss = backPropagate(vars, targets, weight, parameters,
+			      &state->m_floatResponses[0],
+			      &state->m_floatDerivatives[0],
+			      &state->m_floatDeltas[0], &state->m_gradient[0]);
+  state->m_loss += loss;
+  return loss;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Back-propagate one weighted event and add its gradient to a buffer. The
+   products are formed in T, but the gradient is always summed in double.
+   @param vars - The nInputs input variables.
+   @param targets - The nOutputs target values.
+   @param weight - The weight of the event.
+   @param parameters - The weights and biases to use.
+   @param responses - Flat per-node response scratch.
+   @param derivatives - Flat per-node derivative scratch.
+   @param deltas - Flat per-node delta scratch.
+   @param gradient - The gradient buffer, laid out like the parameters.
+   @returns - The weighted loss of the event.
+*/
+template <typename T>
+double CompiledNetwork::backPropagate(const double *vars,
+				      const double *targets, double weight,
+				      const T *parameters, T *responses,
+				      T *derivatives, T *deltas,
+				      double *gradient) const {
+  loadInputs(vars, responses, derivatives);
+  forwardPass(parameters, responses, derivatives);
+
+  // Output layer deltas:
+  double loss = 0.0;
+  int outputOffset = m_responseOffsets[m_nLayers-1];
+  for (int i_o = 0; i_o < m_layerSizes[m_nLayers-1]; i_o++) {
+    double error = responses[outputOffset + i_o] - targets[i_o];
+    deltas[outputOffset + i_o]
+      = (T)(weight * error * derivatives[outputOffset + i_o]);
+    loss += weight * 0.5 * error * error;
+  }
+
+  // Walk backwards through the layers, accumulating the gradient dE/dW_ij =
+  // delta_j * o_i and computing the deltas of the preceding hidden layer:
+  for (int i_l = m_nLayers-1; i_l >= 1; i_l--) {
+    int nIn = m_layerSizes[i_l-1];
+    int nOut = m_layerSizes[i_l];
+    const T *input = &responses[m_responseOffsets[i_l-1]];
+    const T *delta = &deltas[m_responseOffsets[i_l]];
+    const T *weights = &parameters[m_weightOffsets[i_l]];
+    double *weightGradient = &gradient[m_weightOffsets[i_l]];
+    double *biasGradient = &gradient[m_biasOffsets[i_l]];
+    for (int i_o = 0; i_o < nOut; i_o++) {
+      double *row = &weightGradient[i_o * nIn];
+      for (int i_i = 0; i_i < nIn; i_i++) row[i_i] += (delta[i_o] * input[i_i]);
+      if (m_layerHasBias[i_l]) biasGradient[i_o] += delta[i_o];
+    }
+    if (i_l > 1) {
+      T *inputDelta = &deltas[m_responseOffsets[i_l-1]];
+      const T *inputDerivative = &derivatives[m_responseOffsets[i_l-1]];
+      for (int i_i = 0; i_i < nIn; i_i++) inputDelta[i_i] = 0.0;
+      for (int i_o = 0; i_o < nOut; i_o++) {
+	const T *row = &weights[i_o * nIn];
+	for (int i_i = 0; i_i < nIn; i_i++) {
+	  inputDelta[i_i] += (row[i_i] * delta[i_o]);
+	}
+      }
+      for (int i_i = 0; i_i < nIn; i_i++) inputDelta[i_i] *= inputDerivative[i_i];
+    }
+  }
+  return loss;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score a row-major block of events, using the given node-major block scratch
+   (laid out like m_blockResponses).
+   @param events - Row-major [nEvents x nInputs] matrix of input variables.
+   @param nEvents - The number of events.
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+   @param parameters - The weights and biases to use.
+   @param blockResponses - The block scratch to use.
+*/
+template <typename T>
+void CompiledNetwork::batchResponse(const double *events, int nEvents,
+				    double *outputs, const T *parameters,
+				    T *blockResponses) const {
+  int nInputs = getNInputs();
+  int nOutputs = getNOutputs();
+  const T *response = &blockResponses[m_blockOffsets[m_nLayers-1]];
+  double column[kBlockSize];
+  for (int i_b = 0; i_b < nEvents; i_b += kBlockSize) {
+    int nBlock = (nEvents - i_b < kBlockSize) ? (nEvents - i_b) : kBlockSize;
+    // Transpose the block of inputs into the node-major input layer:
+    const double *blockEvents = &events[(long)i_b * nInputs];
+    for (int i_i = 0; i_i < nInputs; i_i++) {
+      for (int i_e = 0; i_e < nBlock; i_e++) {
+	column[i_e] = blockEvents[i_e * nInputs + i_i];
+      }
+      loadInputColumn(i_i, column, nBlock, &blockResponses[i_i * kBlockSize]);
+    }
+    forwardBlock(parameters, blockResponses, nBlock);
+    // Transpose the output layer back into the row-major output buffer:
+    double *blockOutputs = &outputs[(long)i_b * nOutputs];
+    for (int i_e = 0; i_e < nBlock; i_e++) {
+      for (int i_o = 0; i_o < nOutputs; i_o++) {
+	blockOutputs[i_e * nOutputs + i_o] = response[i_o * kBlockSize + i_e];
+      }
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   As above, for a (possibly memory-mapped) EventBlock. Each input variable is
+   read straight from its column into the node-major input layer, so columnar
+   data needs no transpose.
+   @param block - The events.
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+   @param parameters - The weights and biases to use.
+   @param blockResponses - The block scratch to use.
+*/
+template <typename T>
+void CompiledNetwork::batchResponse(const EventBlock &block, double *outputs,
+				    const T *parameters,
+				    T *blockResponses) const {
+  if (block.getNVariables() != getNInputs()) {
+    std::cout << "CompiledNetwork: ERROR! Wrong number of variables in block."
+	      << std::endl;
+    exit(0);
+  }
+  int nEvents = block.getNEvents();
+  int nInputs = getNInputs();
+  int nOutputs = getNOutputs();
+  const T *response = &blockResponses[m_blockOffsets[m_nLayers-1]];
+  double column[kBlockSize];
+  for (int i_b = 0; i_b < nEvents; i_b += kBlockSize) {
+    int nBlock = (nEvents - i_b < kBlockSize) ? (nEvents - i_b) : kBlockSize;
+    for (int i_i = 0; i_i < nInputs; i_i++) {
+      block.getColumn(i_i, i_b, nBlock, column);
+      loadInputColumn(i_i, column, nBlock, &blockResponses[i_i * kBlockSize]);
+    }
+    forwardBlock(parameters, blockResponses, nBlock);
+    double *blockOutputs = &outputs[(long)i_b * nOutputs];
+    for (int i_e = 0; i_e < nBlock; i_e++) {
+      for (int i_o = 0; i_o < nOutputs; i_o++) {
+	blockOutputs[i_e * nOutputs + i_o] = response[i_o * kBlockSize + i_e];
+      }
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Read the topology, activation functions and weights of a NeuralNetwork into
+   flat arrays. Each layer must use a single activation function, and each
+   Neuron may only be connected to Neurons in the preceding layer. The bias node
+   of layer L-1 becomes the bias vector of layer L.
+   @param network - The NeuralNetwork to compile.
+*/
+void CompiledNetwork::compile(NeuralNetwork *network) {
+  if (!network) {
+    std::cout << "CompiledNetwork: ERROR! network is null." << std::endl;
+    exit(0);
+  }
+
+  int nLayers = network->getNLayers();
+  m_normalization = network->getInputNormalization();
+
+  // First pass: layer sizes and functions.
+  std::vector<int> layerSizes(nLayers, 0);
+  std::vector<ActivationFunction> layerFunctions(nLayers, kLinear);
+  for (int i_l = 0; i_l < nLayers; i_l++) {
+    std::vector<Neuron*> layer = network->getLayer(i_l);
+    bool hasFunction = false;
+    for (std::vector<Neuron*>::iterator neuroIter = layer.begin();
+	 neuroIter != layer.end(); neuroIter++) {
+      if ((*neuroIter)->isBiasNode()) continue;
+      ActivationFunction function = (*neuroIter)->getActivation();
+      if (hasFunction && function != layerFunctions[i_l]) {
+	std::cout << "CompiledNetwork: ERROR! Mixed activation functions in layer "
+		  << i_l << std::endl;
+	exit(0);
+      }
+      layerFunctions[i_l] = function;
+      hasFunction = true;
+      layerSizes[i_l]++;
+    }
+  }
+  setTopology(layerSizes, layerFunctions);
+
+  // Second pass: copy the Axon weights into the weight matrices.
+  std::map<Neuron*,int> previousIndices;
+  for (int i_l = 0; i_l < m_nLayers; i_l++) {
+    std::vector<Neuron*> layer = network->getLayer(i_l);
+    std::map<Neuron*,int> currentIndices;
+    int i_n = 0;
+    for (std::vector<Neuron*>::iterator neuroIter = layer.begin();
+	 neuroIter != layer.end(); neuroIter++) {
+      if ((*neuroIter)->isBiasNode()) continue;
+      currentIndices[*neuroIter] = i_n;
+      if (i_l > 0) {
+	double *weights = &m_parameters[m_weightOffsets[i_l]
+					+ i_n * m_layerSizes[i_l-1]];
+	double *bias = &m_parameters[m_biasOffsets[i_l] + i_n];
+	std::vector<Axon*> upstream = (*neuroIter)->getUpstreamConnections();
+	for (std::vector<Axon*>::iterator axonIter = upstream.begin();
+	     axonIter != upstream.end(); axonIter++) {
+	  Neuron *origin = (*axonIter)->getOriginNeuron();
+	  if (origin->isBiasNode() && origin->getLayerIndex() == i_l-1) {
+	    (*bias) += (*axonIter)->getWeight();
+	    m_layerHasBias[i_l] = true;
+	  }
+	  else if (previousIndices.count(origin) > 0) {
+	    weights[previousIndices[origin]] = (*axonIter)->getWeight();
+	  }
+	  else {
+	    std::cout << "CompiledNetwork: ERROR! Connection skips a layer."
+		      << std::endl;
+	    exit(0);
+	  }
+	}
+      }
+      i_n++;
+    }
+    previousIndices = currentIndices;
+  }
+  setPrecision(m_precision);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Copy the compiled weights and biases back into the Axons of a NeuralNetwork
+   with the same topology, for instance after training the compiled copy.
+   @param network - The NeuralNetwork to update.
+*/
+void CompiledNetwork::exportWeights(NeuralNetwork *network) {
+  if (!network || network->getNLayers() != m_nLayers) {
+    std::cout << "CompiledNetwork: ERROR! Cannot export to a different topology."
+	      << std::endl;
+    exit(0);
+  }
+  network->setInputNormalization(m_normalization);
+  std::map<Neuron*,int> previousIndices;
+  for (int i_l = 0; i_l < m_nLayers; i_l++) {
+    std::vector<Neuron*> layer = network->getLayer(i_l);
+    std::map<Neuron*,int> currentIndices;
+    int i_n = 0;
+    for (std::vector<Neuron*>::iterator neuroIter = layer.begin();
+	 neuroIter != layer.end(); neuroIter++) {
+      if ((*neuroIter)->isBiasNode()) continue;
+      if (i_n >= m_layerSizes[i_l]) {
+	std::cout << "CompiledNetwork: ERROR! Cannot export to a different "
+		  << "topology." << std::endl;
+	exit(0);
+      }
+      currentIndices[*neuroIter] = i_n;
+      if (i_l > 0) {
+	const double *weights = &m_parameterData[m_weightOffsets[i_l]
+						 + i_n * m_layerSizes[i_l-1]];
+	std::vector<Axon*> upstream = (*neuroIter)->getUpstreamConnections();
+	for (std::vector<Axon*>::iterator axonIter = upstream.begin();
+	     axonIter != upstream.end(); axonIter++) {
+	  Neuron *origin = (*axonIter)->getOriginNeuron();
+	  if (origin->isBiasNode()) {
+	    (*axonIter)->setWeight(m_parameterData[m_biasOffsets[i_l] + i_n]);
+	  }
+	  else if (previousIndices.count(origin) > 0) {
+	    (*axonIter)->setWeight(weights[previousIndices[origin]]);
+	  }
+	}
+      }
+      i_n++;
+    }
+    previousIndices = currentIndices;
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Propagate a block of input layer responses (already stored node-major in
+   blockResponses) through all subsequent layers. Each layer is evaluated as
+   a matrix-matrix product: every weight is loaded once and applied to all of
+   the events in the block. The inner loop runs over events, so it vectorizes,
+   while the sum for each event is accumulated in the same order as in
+   forwardPass(). This gives the same numbers as the per-event path.
+   @param parameters - The weights and biases to use.
+   @param blockResponses - Node-major block scratch, laid out like
+   m_blockResponses.
+   @param nEvents - The number of events in the block (<= kBlockSize).
+*/
+template <typename T>
+void CompiledNetwork::forwardBlock(const T *parameters, T *blockResponses,
+				   int nEvents) const {
+  for (int i_l = 1; i_l < m_nLayers; i_l++) {
+    int nIn = m_layerSizes[i_l-1];
+    int nOut = m_layerSizes[i_l];
+    ActivationFunction function = m_layerFunctions[i_l];
+    const T *input = &blockResponses[m_blockOffsets[i_l-1]];
+    T *output = &blockResponses[m_blockOffsets[i_l]];
+    const T *weights = &parameters[m_weightOffsets[i_l]];
+    const T *biases = &parameters[m_biasOffsets[i_l]];
+    for (int i_o = 0; i_o < nOut; i_o++) {
+      const T *row = &weights[i_o * nIn];
+      T *currSum = &output[i_o * kBlockSize];
+      // Sum into a local array, which cannot alias the inputs, with a constant
+      // trip count for full blocks, so that the compiler vectorizes at -O2:
+      T sums[kBlockSize];
+      for (int i_e = 0; i_e < kBlockSize; i_e++) sums[i_e] = 0.0;
+      for (int i_i = 0; i_i < nIn; i_i++) {
+	T currWeight = row[i_i];
+	const T *currInput = &input[i_i * kBlockSize];
+	if (nEvents == kBlockSize) {
+	  for (int i_e = 0; i_e < kBlockSize; i_e++) {
+	    sums[i_e] += (currWeight * currInput[i_e]);
+	  }
+	}
+	else {
+	  for (int i_e = 0; i_e < nEvents; i_e++) {
+	    sums[i_e] += (currWeight * currInput[i_e]);
+	  }
+	}
+      }
+      for (int i_e = 0; i_e < nEvents; i_e++) {
+	currSum[i_e] = sums[i_e] + biases[i_o];
+      }
+      Activation::evaluateLayer(function, currSum, nEvents, currSum,
+				(T*)NULL);
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Propagate the input layer responses (already stored in responses) through
+   all subsequent layers. The sum for each node adds the weighted inputs in
+   layer order and then the bias, matching the Axon order in the graph.
+   @param parameters - The weights and biases, laid out like getParameters().
+   @param responses - Flat per-node responses, laid out like m_responses.
+   @param derivatives - Flat per-node derivatives to fill, or NULL.
+*/
+template <typename T>
+void CompiledNetwork::forwardPass(const T *parameters, T *responses,
+				  T *derivatives) const {
+  for (int i_l = 1; i_l < m_nLayers; i_l++) {
+    int nIn = m_layerSizes[i_l-1];
+    int nOut = m_layerSizes[i_l];
+    ActivationFunction function = m_layerFunctions[i_l];
+    const T *input = &responses[m_responseOffsets[i_l-1]];
+    T *output = &responses[m_responseOffsets[i_l]];
+    const T *weights = &parameters[m_weightOffsets[i_l]];
+    const T *biases = &parameters[m_biasOffsets[i_l]];
+    for (int i_o = 0; i_o < nOut; i_o++) {
+      const T *row = &weights[i_o * nIn];
+      T currSum = 0.0;
+      for (int i_i = 0; i_i < nIn; i_i++) {
+	currSum += (row[i_i] * input[i_i]);
+      }
+      output[i_o] = currSum + biases[i_o];
+    }
+    Activation::evaluateLayer(function, output, nOut, output, derivatives ?
+			      &derivatives[m_responseOffsets[i_l]] : (T*)NULL);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @param layerIndex - The index of the layer (>= 1).
+   @returns - The offset of the layer bias vector in the parameter block.
+*/
+int CompiledNetwork::getBiasOffset(int layerIndex) const {
+  return m_biasOffsets[layerIndex];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Retrieve the network responses for a whole block of events in one call. The
+   events are processed in blocks of kBlockSize, layer by layer, so that the
+   weights stay hot in cache across events. No memory is allocated.
+   @param events - Row-major [nEvents x nInputs] matrix of input variables.
+   @param nEvents - The number of events.
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+*/
+void CompiledNetwork::getBatchResponse(const double *events, int nEvents,
+				       double *outputs) {
+  if (m_precision == kSinglePrecision) {
+    batchResponse(events, nEvents, outputs, &m_floatParameters[0],
+		  &m_floatBlockResponses[0]);
+  }
+  else {
+    batchResponse(events, nEvents, outputs, m_parameterData,
+		  &m_blockResponses[0]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   As above, but with the block scratch of a NetworkState, so that several
+   threads can score events concurrently against the same network. The scratch
+   is allocated on the first call with a given state.
+   @param events - Row-major [nEvents x nInputs] matrix of input variables.
+   @param nEvents - The number of events.
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+   @param state - The scratch to use.
+*/
+void CompiledNetwork::getBatchResponse(const double *events, int nEvents,
+				       double *outputs,
+				       NetworkState *state) const {
+  if (m_precision == kSinglePrecision) {
+    if (state->m_floatBlockResponses.size() != m_blockResponses.size()) {
+      state->m_floatBlockResponses.assign(m_blockResponses.size(), 0.0);
+    }
+    batchResponse(events, nEvents, outputs, &m_floatParameters[0],
+		  &state->m_floatBlockResponses[0]);
+  }
+  else {
+    if (state->m_blockResponses.size() != m_blockResponses.size()) {
+      state->m_blockResponses.assign(m_blockResponses.size(), 0.0);
+    }
+    batchResponse(events, nEvents, outputs, m_parameterData,
+		  &state->m_blockResponses[0]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Retrieve the network responses for all events of an EventBlock, for instance
+   a block of a memory-mapped EventFile. No memory is allocated.
+   @param block - The events.
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+*/
+void CompiledNetwork::getBatchResponse(const EventBlock &block,
+				       double *outputs) {
+  if (m_precision == kSinglePrecision) {
+    batchResponse(block, outputs, &m_floatParameters[0],
+		  &m_floatBlockResponses[0]);
+  }
+  else {
+    batchResponse(block, outputs, m_parameterData, &m_blockResponses[0]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   As above, but with the block scratch of a NetworkState (see above).
+   @param block - The events.
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+   @param state - The scratch to use.
+*/
+void CompiledNetwork::getBatchResponse(const EventBlock &block,
+				       double *outputs,
+				       NetworkState *state) const {
+  if (m_precision == kSinglePrecision) {
+    if (state->m_floatBlockResponses.size() != m_blockResponses.size()) {
+      state->m_floatBlockResponses.assign(m_blockResponses.size(), 0.0);
+    }
+    batchResponse(block, outputs, &m_floatParameters[0],
+		  &state->m_floatBlockResponses[0]);
+  }
+  else {
+    if (state->m_blockResponses.size() != m_blockResponses.size()) {
+      state->m_blockResponses.assign(m_blockResponses.size(), 0.0);
+    }
+    batchResponse(block, outputs, m_parameterData,
+		  &state->m_blockResponses[0]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The transform applied to the raw input variables.
+*/
+const InputNormalization& CompiledNetwork::getInputNormalization() const {
+  return m_normalization;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @param layerIndex - The index of the layer.
+   @returns - The activation function of the nodes in the layer.
+*/
+ActivationFunction CompiledNetwork::getLayerFunction(int layerIndex) const {
+  return m_layerFunctions[layerIndex];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @param layerIndex - The index of the layer.
+   @returns - The number of nodes in the layer, excluding the bias node.
+*/
+int CompiledNetwork::getLayerSize(int layerIndex) const {
+  return m_layerSizes[layerIndex];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Estimate the memory held by the network: the parameters (including an
+   external read-only block), the float copy, and the evaluation scratch.
+   Allocator overhead is not included.
+   @returns - The memory footprint in bytes.
+*/
+size_t CompiledNetwork::getMemoryFootprint() const {
+  size_t nBytes = sizeof(CompiledNetwork);
+  if (isReadOnly()) nBytes += m_nParameters * sizeof(double);
+  nBytes += ((m_parameters.capacity() + m_responses.capacity() +
+	      m_blockResponses.capacity()) * sizeof(double));
+  nBytes += ((m_floatParameters.capacity() + m_floatResponses.capacity() +
+	      m_floatBlockResponses.capacity()) * sizeof(float));
+  nBytes += ((m_layerSizes.capacity() + m_weightOffsets.capacity() +
+	      m_biasOffsets.capacity() + m_responseOffsets.capacity() +
+	      m_blockOffsets.capacity()) * sizeof(int));
+  nBytes += m_layerFunctions.capacity() * sizeof(ActivationFunction);
+  return nBytes;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of input variables.
+*/
+int CompiledNetwork::getNInputs() const {
+  return m_layerSizes[0];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of layers, including the input and output layers.
+*/
+int CompiledNetwork::getNLayers() const {
+  return m_nLayers;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of output variables.
+*/
+int CompiledNetwork::getNOutputs() const {
+  return m_layerSizes[m_nLayers-1];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The total number of weights and biases.
+*/
+int CompiledNetwork::getNParameters() const {
+  return m_nParameters;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Retrieve the network response based on the given inputs. Equivalent to
+   NeuralNetwork::getNetworkResponse() for the compiled weights.
+   @param vars - The input variables.
+   @returns - The responses of the output layer.
+*/
+std::vector<double> CompiledNetwork::getNetworkResponse(std::vector<double> vars) {
+  if ((int)vars.size() != getNInputs()) {
+    std::cout << "CompiledNetwork: ERROR! Wrong size of inputs." << std::endl;
+    exit(0);
+  }
+  std::vector<double> result(getNOutputs());
+  getNetworkResponse(&vars[0], &result[0]);
+  return result;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Retrieve the network response based on the given inputs, without any heap
+   allocation or copy of the inputs.
+   @param vars - The getNInputs() input variables.
+   @param outputs - Buffer for the getNOutputs() responses of the output layer.
+*/
+void CompiledNetwork::getNetworkResponse(const double *vars, double *outputs) {
+  if (m_precision == kSinglePrecision) {
+    networkResponse(vars, outputs, &m_floatParameters[0],
+		    &m_floatResponses[0]);
+  }
+  else {
+    networkResponse(vars, outputs, m_parameterData, &m_responses[0]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   As above, but with the scratch of a NetworkState. The network itself is not
+   modified, so any number of threads can score events concurrently against
+   one shared network, each with its own NetworkState. The single-precision
+   scratch of the state is allocated on the first call that needs it.
+   @param vars - The getNInputs() input variables.
+   @param outputs - Buffer for the getNOutputs() responses of the output layer.
+   @param state - The scratch to use.
+*/
+void CompiledNetwork::getNetworkResponse(const double *vars, double *outputs,
+					 NetworkState *state) const {
+  if (m_precision == kSinglePrecision) {
+    if (state->m_floatResponses.size() != state->m_responses.size()) {
+      state->m_floatResponses.assign(state->m_responses.size(), 0.0);
+    }
+    networkResponse(vars, outputs, &m_floatParameters[0],
+		    &state->m_floatResponses[0]);
+  }
+  else {
+    networkResponse(vars, outputs, m_parameterData, &state->m_responses[0]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - A pointer to the flat block of weights and biases, for in-place
+   updates by trainers. See getWeightOffset() and getBiasOffset() for layout.
+*/
+double* CompiledNetwork::getParameterData() {
+  if (isReadOnly()) {
+    std::cout << "CompiledNetwork: ERROR! The parameters are read-only."
+	      << std::endl;
+    exit(0);
+  }
+  return &m_parameters[0];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - A copy of the flat block of weights and biases.
+*/
+std::vector<double> CompiledNetwork::getParameters() {
+  return std::vector<double>(m_parameterData, m_parameterData + m_nParameters);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The precision of the arithmetic used for evaluation.
+*/
+Precision CompiledNetwork::getPrecision() const {
+  return m_precision;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @param layerIndex - The index of the layer (>= 1).
+   @returns - The offset of the layer weight matrix in the parameter block.
+*/
+int CompiledNetwork::getWeightOffset(int layerIndex) const {
+  return m_weightOffsets[layerIndex];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - True iff the network evaluates from a shared, read-only block of
+   parameters (see the constructor), so that it cannot be trained.
+*/
+bool CompiledNetwork::isReadOnly() const {
+  return (m_nParameters > 0 && m_parameters.empty());
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Check whether a layer receives a bias. The input layer has no bias node, so
+   the first hidden layer has no bias in networks built by NeuralNetwork.
+   @param layerIndex - The index of the layer.
+   @returns - True iff the preceding layer has a bias node.
+*/
+bool CompiledNetwork::layerHasBias(int layerIndex) const {
+  return m_layerHasBias[layerIndex];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Load one input variable of a block of events into the node-major input
+   layer: normalize the raw values (if the network has an InputNormalization)
+   and apply the input layer activation, both in double precision.
+   @param variableIndex - The index of the input variable.
+   @param values - The n raw values, overwritten with the double responses.
+   @param n - The number of events.
+   @param inputs - The n responses of the input node in the block scratch.
+*/
+template <typename T>
+void CompiledNetwork::loadInputColumn(int variableIndex, double *values,
+				      int n, T *inputs) const {
+  if (m_normalization.isActive()) {
+    m_normalization.transformColumn(variableIndex, values, n, values);
+  }
+  Activation::evaluateLayer(m_layerFunctions[0], values, n, values, NULL);
+  for (int i_e = 0; i_e < n; i_e++) inputs[i_e] = values[i_e];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Load the input layer of one event: normalize the raw variables (if the
+   network has an InputNormalization), then apply the input layer activation.
+   Both steps are done in double precision.
+   @param vars - The raw input variables.
+   @param responses - Flat per-node responses; the input layer is filled.
+   @param derivatives - Flat per-node derivatives to fill, or NULL.
+*/
+template <typename T>
+void CompiledNetwork::loadInputs(const double *vars, T *responses,
+				 T *derivatives) const {
+  for (int i_i = 0; i_i < m_layerSizes[0]; i_i++) {
+    double value = m_normalization.isActive() ?
+      m_normalization.transformValue(i_i, vars[i_i]) : vars[i_i];
+    double derivative;
+    Activation::evaluate(m_layerFunctions[0], value, value, derivative);
+    responses[i_i] = value;
+    if (derivatives) derivatives[i_i] = derivative;
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Evaluate one event with the given parameters and response scratch.
+   @param vars - The getNInputs() input variables.
+   @param outputs - Buffer for the getNOutputs() responses of the output layer.
+   @param parameters - The weights and biases to use.
+   @param responses - Flat per-node response scratch.
+*/
+template <typename T>
+void CompiledNetwork::networkResponse(const double *vars, double *outputs,
+				      const T *parameters,
+				      T *responses) const {
+  loadInputs(vars, responses, (T*)NULL);
+  forwardPass(parameters, responses, (T*)NULL);
+  const T *output = &responses[m_responseOffsets[m_nLayers-1]];
+  for (int i_o = 0; i_o < getNOutputs(); i_o++) outputs[i_o] = output[i_o];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the layer sizes and functions, compute the offsets of every layer in the
+   parameter block and the scratch, and allocate both. All parameters are zero
+   and no layer has a bias until they are filled.
+   @param layerSizes - The number of nodes per layer (index 0 is the input).
+   @param layerFunctions - The activation function of each layer.
+*/
+void CompiledNetwork::setTopology(const std::vector<int> &layerSizes,
+				  const std::vector<ActivationFunction>
+				  &layerFunctions) {
+  m_nLayers = (int)layerSizes.size();
+  m_layerSizes = layerSizes;
+  m_layerFunctions = layerFunctions;
+  m_layerHasBias.assign(m_nLayers, false);
+  m_weightOffsets.assign(m_nLayers, 0);
+  m_biasOffsets.assign(m_nLayers, 0);
+  m_responseOffsets.assign(m_nLayers, 0);
+  int nParameters = 0;
+  int nResponses = 0;
+  for (int i_l = 0; i_l < m_nLayers; i_l++) {
+    m_responseOffsets[i_l] = nResponses;
+    nResponses += m_layerSizes[i_l];
+    if (i_l > 0) {
+      m_weightOffsets[i_l] = nParameters;
+      nParameters += m_layerSizes[i_l] * m_layerSizes[i_l-1];
+      m_biasOffsets[i_l] = nParameters;
+      nParameters += m_layerSizes[i_l];
+    }
+  }
+  m_nParameters = nParameters;
+  m_parameters.assign(nParameters, 0.0);
+  m_parameterData = m_parameters.empty() ? NULL : &m_parameters[0];
+  m_responses.assign(nResponses, 0.0);
+  m_blockResponses.assign(nResponses * kBlockSize, 0.0);
+  m_blockOffsets.assign(m_nLayers, 0);
+  for (int i_l = 0; i_l < m_nLayers; i_l++) {
+    m_blockOffsets[i_l] = m_responseOffsets[i_l] * kBlockSize;
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Choose the precision of evaluation. kSinglePrecision takes a float copy of
+   the weights and runs getNetworkResponse(), getBatchResponse() and the
+   three-argument accumulateGradient() in float: this halves the memory
+   traffic for the weights and responses and doubles the SIMD width of the
+   layer loops. The inputs are still read, normalized and activated in double.
+   The float copy is refreshed by compile(); call setPrecision() again after
+   writing the weights through getParameterData().
+   @param precision - The precision to use.
+*/
+void CompiledNetwork::setPrecision(Precision precision) {
+  m_precision = precision;
+  if (m_precision == kSinglePrecision) {
+    m_floatParameters.assign(m_parameterData, m_parameterData + m_nParameters);
+    m_floatResponses.assign(m_responses.size(), 0.0);
+    m_floatBlockResponses.assign(m_blockResponses.size(), 0.0);
+  }
+  else {
+    std::vector<float>().swap(m_floatParameters);
+    std::vector<float>().swap(m_floatResponses);
+    std::vector<float>().swap(m_floatBlockResponses);
+  }
+}
@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: CompiledNetwork.h                                                   //
+//  Class: CompiledNetwork.cxx                                                //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CompiledNetwork_h
+#define CompiledNetwork_h
+
+#include "Activation.h"
+#include "EventBlock.h"
+#include "InputNormalization.h"
+#include "NeuralNetwork.h"
+#include "NetworkState.h"
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+// Floating-point precision of the network arithmetic:
+enum Precision {
+  kDoublePrecision,// Weights, responses and sums in double
+  kSinglePrecision// Float copy of the weights, responses and sums in float
+};
+
+class CompiledNetwork
+{
+
+ public:
+
+  CompiledNetwork(NeuralNetwork *network);
+  CompiledNetwork(std::vector<int> layerSizes,
+		  std::vector<ActivationFunction> layerFunctions,
+		  std::vector<bool> layerHasBias,
+		  const InputNormalization &normalization,
+		  const double *parameters, bool shareParameters);
+  ~CompiledNetwork();
+
+  // Accessors:
+  int getBiasOffset(int layerIndex) const;
+  void getBatchResponse(const double *events, int nEvents, double *outputs);
+  void getBatchResponse(const double *events, int nEvents, double *outputs,
+			NetworkState *state) const;
+  void getBatchResponse(const EventBlock &block, double *outputs);
+  void getBatchResponse(const EventBlock &block, double *outputs,
+			NetworkState *state) const;
+  const InputNormalization& getInputNormalization() const;
+  ActivationFunction getLayerFunction(int layerIndex) const;
+  int getLayerSize(int layerIndex) const;
+  size_t getMemoryFootprint() const;
+  int getNInputs() const;
+  int getNLayers() const;
+  int getNOutputs() const;
+  int getNParameters() const;
+  std::vector<double> getNetworkResponse(std::vector<double> vars);
+  void getNetworkResponse(const double *vars, double *outputs);
+  void getNetworkResponse(const double *vars, double *outputs,
+			  NetworkState *state) const;
+  double* getParameterData();
+  std::vector<double> getParameters();
+  Precision getPrecision() const;
+  int getWeightOffset(int layerIndex) const;
+  bool isReadOnly() const;
+  bool layerHasBias(int layerIndex) const;
+
+  // Mutators:
+  double accumulateGradient(const double *vars, const double *targets,
+			    NetworkState *state) const;
+  double accumulateGradient(const double *vars, const double *targets,
+			    NetworkState *state,
+			    const double *parameters) const;
+  double accumulateGradient(const double *vars, const double *targets,
+			    double weight, NetworkState *state,
+			    const double *parameters) const;
+  double accumulateGradient(const double *vars, const double *targets,
+			    double weight, NetworkState *state,
+			    const float *parameters) const;
+  void compile(NeuralNetwork *network);
+  void exportWeights(NeuralNetwork *network);
+  void setPrecision(Precision precision);
+
+ private:
+
+  // Private functions, for T = double or float arithmetic:
+  template <typename T>
+  double backPropagate(const double *vars, const double *targets,
+		       double weight, const T *parameters, T *responses,
+		       T *derivatives, T *deltas, double *gradient) const;
+  template <typename T>
+  void batchResponse(const double *events, int nEvents, double *outputs,
+		     const T *parameters, T *blockResponses) const;
+  template <typename T>
+  void batchResponse(const EventBlock &block, double *outputs,
+		     const T *parameters, T *blockResponses) const;
+  template <typename T>
+  void forwardBlock(const T *parameters, T *blockResponses,
+		    int nEvents) const;
+  template <typename T>
+  void forwardPass(const T *parameters, T *responses, T *derivatives) const;
+  template <typename T>
+  void loadInputColumn(int variableIndex, double *values, int n,
+		       T *inputs) const;
+  template <typename T>
+  void loadInputs(const double *vars, T *responses, T *derivatives) const;
+  template <typename T>
+  void networkResponse(const double *vars, double *outputs,
+		       const T *parameters, T *responses) const;
+  void setTopology(const std::vector<int> &layerSizes,
+		   const std::vector<ActivationFunction> &layerFunctions);
+
+  // Not copyable (m_parameterData may point into m_parameters):
+  CompiledNetwork(const CompiledNetwork&);
+  CompiledNetwork& operator=(const CompiledNetwork&);
+
+  // Transform of the raw input variables, fused into the input layer:
+  InputNormalization m_normalization;
+
+  // Topology (index 0 is the input layer):
+  int m_nLayers;
+  std::vector<int> m_layerSizes;
+  std::vector<ActivationFunction> m_layerFunctions;
+  std::vector<bool> m_layerHasBias;
+
+  // All weights and biases in one contiguous block. Layer L (L >= 1) stores a
+  // row-major [m_layerSizes[L] x m_layerSizes[L-1]] weight matrix starting at
+  // m_weightOffsets[L], followed by m_layerSizes[L] biases at m_biasOffsets[L].
+  // Evaluation reads m_parameterData, which points either into m_parameters
+  // or, for a read-only network, into an external block (e.g. a ModelFile).
+  std::vector<double> m_parameters;
+  const double *m_parameterData;
+  int m_nParameters;
+  std::vector<int> m_weightOffsets;
+  std::vector<int> m_biasOffsets;
+
+  // With kSinglePrecision, evaluation uses a float copy of the parameters and
+  // float scratch. The copy is taken by setPrecision() and compile():
+  Precision m_precision;
+  std::vector<float> m_floatParameters;
+  std::vector<float> m_floatResponses;
+  std::vector<float> m_floatBlockResponses;
+
+  // Flat response scratch for single-event evaluation:
+  std::vector<double> m_responses;
+  std::vector<int> m_responseOffsets;
+
+  // Node-major response scratch for a block of events: node i of a layer for
+  // event e lives at m_blockResponses[m_blockOffsets[L] + i*kBlockSize + e].
+  static const int kBlockSize = 64;
+  std::vector<double> m_blockResponses;
+  std::vector<int> m_blockOffsets;
+
+};
+
+#endif
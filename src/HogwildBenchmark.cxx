@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: HogwildBenchmark.cxx                                                //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Compares the convergence per wall-clock second of synchronous mini-batch  //
+//  training against the asynchronous (Hogwild-style) mode of the             //
+//  ParallelTrainer. Both modes train identical copies of a small, wide       //
+//  network on a toy signal/background sample. After every epoch the loss on //
+//  a separate validation sample is printed together with the elapsed time.  //
+//                                                                            //
+//  Usage: HogwildBenchmark <nThreads> <nEpochs> <nEvents>                    //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CompiledNetwork.h"
+#include "NeuralNetwork.h"
+#include "ParallelTrainer.h"
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/**
+   -----------------------------------------------------------------------------
+   Fill a toy sample: signal events (target +0.8) are centred at +0.3 and
+   background events (target -0.8) at -0.3 in every variable, with flat noise.
+   @param nEvents - The number of events to generate.
+   @param nInputs - The number of variables per event.
+   @param inputs - Row-major [nEvents x nInputs] variables (output).
+   @param targets - The nEvents target values (output).
+*/
+void generateSample(int nEvents, int nInputs, std::vector<double> &inputs,
+		    std::vector<double> &targets) {
+  inputs.resize(nEvents * nInputs);
+  targets.resize(nEvents);
+  for (int i_e = 0; i_e < nEvents; i_e++) {
+    bool isSignal = (rand() % 2 == 0);
+    for (int i_i = 0; i_i < nInputs; i_i++) {
+      double noise = ((double)(rand() % 1000) - 500.0) / 1000.0;
+      inputs[i_e * nInputs + i_i] = (isSignal ? 0.3 : -0.3) + noise;
+    }
+    targets[i_e] = isSignal ? 0.8 : -0.8;
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The mean loss 0.5 * (response - target)^2 of a sample.
+*/
+double validationLoss(CompiledNetwork *network, std::vector<double> &inputs,
+		      std::vector<double> &targets) {
+  int nEvents = (int)targets.size();
+  std::vector<double> outputs(nEvents);
+  network->getBatchResponse(&inputs[0], nEvents, &outputs[0]);
+  double loss = 0.0;
+  for (int i_e = 0; i_e < nEvents; i_e++) {
+    loss += 0.5 * (outputs[i_e] - targets[i_e]) * (outputs[i_e] - targets[i_e]);
+  }
+  return (loss / ((double)nEvents));
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Train one copy of the network and print one line per epoch:
+   mode nThreads epoch seconds validationLoss
+*/
+void runMode(bool asynchronous, int nThreads, int nEpochs,
+	     std::vector<double> &trainInputs, std::vector<double> &trainTargets,
+	     std::vector<double> &testInputs, std::vector<double> &testTargets) {
+  int nInputs = (int)(trainInputs.size() / trainTargets.size());
+  srand(1);
+  NeuralNetwork *network = new NeuralNetwork(nInputs, 1, 1, 64);
+  network->randomizeNetworkWeights();
+  ParallelTrainer *trainer = new ParallelTrainer(network, nThreads);
+  trainer->setAsynchronous(asynchronous);
+  trainer->setMiniBatchSize(asynchronous ? 8 : 8 * nThreads);
+  trainer->setLearningRate(0.05);
+
+  const char *mode = asynchronous ? "async" : "sync";
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  printf("%s %d %d %.4f %.6g\n", mode, nThreads, 0, 0.0,
+	 validationLoss(trainer->getCompiledNetwork(), testInputs, testTargets));
+  for (int i_e = 1; i_e <= nEpochs; i_e++) {
+    trainer->train(&trainInputs[0], &trainTargets[0], (int)trainTargets.size());
+    double seconds = std::chrono::duration<double>
+      (std::chrono::steady_clock::now() - start).count();
+    printf("%s %d %d %.4f %.6g\n", mode, nThreads, i_e, seconds,
+	   validationLoss(trainer->getCompiledNetwork(), testInputs,
+			  testTargets));
+  }
+  delete trainer;
+  delete network;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Main method: train the same network synchronously and asynchronously.
+*/
+int main(int argc, char **argv) {
+  if (argc < 4) {
+    std::cout << "Usage: " << argv[0] << " <nThreads> <nEpochs> <nEvents>"
+	      << std::endl;
+    exit(0);
+  }
+  int nThreads = atoi(argv[1]);
+  int nEpochs = atoi(argv[2]);
+  int nEvents = atoi(argv[3]);
+  int nInputs = 8;
+
+  srand(0);
+  std::vector<double> trainInputs, trainTargets, testInputs, testTargets;
+  generateSample(nEvents, nInputs, trainInputs, trainTargets);
+  generateSample(10000, nInputs, testInputs, testTargets);
+
+  printf("# mode nThreads epoch seconds validationLoss\n");
+  runMode(false, nThreads, nEpochs, trainInputs, trainTargets, testInputs,
+	  testTargets);
+  runMode(true, nThreads, nEpochs, trainInputs, trainTargets, testInputs,
+	  testTargets);
+  return 0;
+}
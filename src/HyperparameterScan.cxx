@@ -0,0 +1,555 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: HyperparameterScan.cxx                                              //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class scans network configurations (number of hidden layers, nodes   //
+//  per layer and learning rate) in one process. All of the trainings read    //
+//  the same training and validation EventBlocks, e.g. from a memory-mapped   //
+//  EventFile, so the data exist once however many configurations run.        //
+//                                                                            //
+//  The points are sorted by their number of weights and dealt out to one     //
+//  queue per worker thread, most expensive first. A worker takes points from //
+//  the front of its own queue and, once that is empty, steals from the back  //
+//  of the others, so the threads stay busy until the last point is taken.    //
+//  Each point trains its own NeuralNetwork with a NetworkTrainer for         //
+//  setNEpochs() epochs, and the validation loss is measured after every      //
+//  epoch with a CompiledNetwork copy.                                        //
+//                                                                            //
+//  Early termination follows the median stopping rule: after the grace       //
+//  period, a point whose best validation loss is worse than the median (or   //
+//  setTerminationQuantile()) of the losses of the other points at the same   //
+//  epoch is stopped. Which points stop can depend on the order in which the  //
+//  threads finish, but a point that runs to the end always gives the same    //
+//  result, since its weights and shuffling are seeded by its index.          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "HyperparameterScan.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+
+// The fewest losses of other points at an epoch for early termination:
+static const int kMinReports = 3;
+
+/**
+   -----------------------------------------------------------------------------
+   HyperparameterScan constructor. The data are not copied and must outlive
+   the scan.
+   @param training - The training events.
+   @param validation - The validation events.
+   @param nThreads - The number of configurations trained at once.
+*/
+HyperparameterScan::HyperparameterScan(const EventBlock &training,
+				       const EventBlock &validation,
+				       int nThreads) {
+  if (training.getNVariables() != validation.getNVariables() ||
+      training.getNTargets() != validation.getNTargets() ||
+      validation.getNEvents() < 1) {
+    std::cout << "HyperparameterScan: ERROR! The training and validation "
+	      << "data do not match." << std::endl;
+    exit(0);
+  }
+  if (nThreads < 1) {
+    std::cout << "HyperparameterScan: ERROR! Need at least one thread."
+	      << std::endl;
+    exit(0);
+  }
+  m_training = &training;
+  m_validation = &validation;
+  m_nThreads = nThreads;
+  m_miniBatchSize = 1;
+  m_nEpochs = 10;
+  m_seed = 1;
+  m_verbose = false;
+  m_earlyTermination = true;
+  m_gracePeriod = 2;
+  m_terminationQuantile = 0.5;
+  m_nSteals = 0;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   HyperparameterScan destructor.
+*/
+HyperparameterScan::~HyperparameterScan() {
+  for (int i_q = 0; i_q < (int)m_queues.size(); i_q++) delete m_queues[i_q];
+  m_queues.clear();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Add every combination of the given values to the scan.
+   @param nHiddenLayers - The numbers of hidden layers.
+   @param nNodesPerLayer - The numbers of nodes per hidden layer.
+   @param learningRates - The learning rates.
+*/
+void HyperparameterScan::addGrid(std::vector<int> nHiddenLayers,
+				 std::vector<int> nNodesPerLayer,
+				 std::vector<double> learningRates) {
+  for (int i_l = 0; i_l < (int)nHiddenLayers.size(); i_l++) {
+    for (int i_n = 0; i_n < (int)nNodesPerLayer.size(); i_n++) {
+      for (int i_r = 0; i_r < (int)learningRates.size(); i_r++) {
+	addPoint(nHiddenLayers[i_l], nNodesPerLayer[i_n], learningRates[i_r]);
+      }
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Add one configuration to the scan.
+   @param nHiddenLayers - The number of hidden layers.
+   @param nNodesPerLayer - The number of nodes per hidden layer.
+   @param learningRate - The learning rate.
+*/
+void HyperparameterScan::addPoint(int nHiddenLayers, int nNodesPerLayer,
+				  double learningRate) {
+  if (nHiddenLayers < 1 || nNodesPerLayer < 1 || learningRate <= 0.0) {
+    std::cout << "HyperparameterScan: ERROR! Point " << nHiddenLayers
+	      << " x " << nNodesPerLayer << ", rate " << learningRate
+	      << " is not allowed." << std::endl;
+    exit(0);
+  }
+  ScanPoint point;
+  point.nHiddenLayers = nHiddenLayers;
+  point.nNodesPerLayer = nNodesPerLayer;
+  point.learningRate = learningRate;
+  point.trainingLoss = 0.0;
+  point.bestLoss = HUGE_VAL;
+  point.bestEpoch = 0;
+  point.isTerminated = false;
+  point.seconds = 0.0;
+  m_points.push_back(point);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The point with the lowest validation loss.
+*/
+const ScanPoint& HyperparameterScan::getBestPoint() {
+  if (m_points.empty()) {
+    std::cout << "HyperparameterScan: ERROR! No points." << std::endl;
+    exit(0);
+  }
+  return m_points[getRanking()[0]];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of epochs every point trains before it can be stopped.
+*/
+int HyperparameterScan::getGracePeriod() {
+  return m_gracePeriod;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The mini-batch size of every point.
+*/
+int HyperparameterScan::getMiniBatchSize() {
+  return m_miniBatchSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The largest number of epochs of a point.
+*/
+int HyperparameterScan::getNEpochs() {
+  return m_nEpochs;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of configurations in the scan.
+*/
+int HyperparameterScan::getNPoints() {
+  return (int)m_points.size();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of points taken from another worker's queue in the
+   last run().
+*/
+int HyperparameterScan::getNSteals() {
+  return m_nSteals;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of configurations trained at once.
+*/
+int HyperparameterScan::getNThreads() {
+  return m_nThreads;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Get one configuration and its results.
+   @param pointIndex - The index of the point, in the order of addition.
+   @returns - The point.
+*/
+const ScanPoint& HyperparameterScan::getPoint(int pointIndex) {
+  if (pointIndex < 0 || pointIndex >= (int)m_points.size()) {
+    std::cout << "HyperparameterScan: ERROR! No point " << pointIndex
+	      << std::endl;
+    exit(0);
+  }
+  return m_points[pointIndex];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The point indices in order of increasing best validation loss.
+*/
+std::vector<int> HyperparameterScan::getRanking() {
+  std::vector<std::pair<double,int> > losses;
+  for (int i_p = 0; i_p < (int)m_points.size(); i_p++) {
+    losses.push_back(std::make_pair(m_points[i_p].bestLoss, i_p));
+  }
+  std::sort(losses.begin(), losses.end());
+  std::vector<int> ranking;
+  for (int i_p = 0; i_p < (int)losses.size(); i_p++) {
+    ranking.push_back(losses[i_p].second);
+  }
+  return ranking;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The quantile of the other points' losses a point must beat.
+*/
+double HyperparameterScan::getTerminationQuantile() {
+  return m_terminationQuantile;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - True if points that are clearly losing are stopped early.
+*/
+bool HyperparameterScan::hasEarlyTermination() {
+  return m_earlyTermination;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Report the validation loss of a point after an epoch and decide whether it
+   should stop.
+   @param epochIndex - The index of the epoch, from 0.
+   @param loss - The validation loss after the epoch.
+   @param bestLoss - The best validation loss of the point so far.
+   @returns - True if the point is losing.
+*/
+bool HyperparameterScan::isLosing(int epochIndex, double loss,
+				  double bestLoss) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::vector<double> &losses = m_epochLosses[epochIndex];
+  bool isLosing = false;
+  if (m_earlyTermination && epochIndex + 1 >= m_gracePeriod &&
+      (int)losses.size() >= kMinReports) {
+    std::vector<double> sorted = losses;
+    int index = (int)(m_terminationQuantile * (sorted.size() - 1));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    isLosing = (bestLoss > sorted[index]);
+  }
+  // A diverged point counts as the worst:
+  losses.push_back(isnan(loss) ? HUGE_VAL : loss);
+  return isLosing;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Take the next point for a worker: from the front of its own queue, or else
+   from the back of another worker's.
+   @param threadIndex - The index of the worker.
+   @returns - The index of the point, or -1 once all are taken.
+*/
+int HyperparameterScan::nextPoint(int threadIndex) {
+  int nQueues = (int)m_queues.size();
+  for (int i_q = 0; i_q < nQueues; i_q++) {
+    ScanQueue *queue = m_queues[(threadIndex + i_q) % nQueues];
+    int pointIndex = -1;
+    {
+      std::lock_guard<std::mutex> lock(queue->mutex);
+      if (queue->points.empty()) continue;
+      if (i_q == 0) {
+	pointIndex = queue->points.front();
+	queue->points.pop_front();
+      }
+      else {
+	pointIndex = queue->points.back();
+	queue->points.pop_back();
+      }
+    }
+    if (i_q > 0) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_nSteals++;
+    }
+    return pointIndex;
+  }
+  return -1;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Print the points in order of increasing best validation loss, with a line
+   of totals.
+*/
+void HyperparameterScan::printSummary() {
+  printf("# rank nHiddenLayers nNodesPerLayer learningRate nEpochs bestEpoch "
+	 "bestLoss trainingLoss status seconds\n");
+  std::vector<int> ranking = getRanking();
+  int nTerminated = 0;
+  int nEpochsTrained = 0;
+  for (int i_r = 0; i_r < (int)ranking.size(); i_r++) {
+    const ScanPoint &point = m_points[ranking[i_r]];
+    printf("%d %d %d %.6g %d %d %.6g %.6g %s %.3g\n", i_r + 1,
+	   point.nHiddenLayers, point.nNodesPerLayer, point.learningRate,
+	   (int)point.validationLosses.size(), point.bestEpoch,
+	   point.bestLoss, point.trainingLoss,
+	   point.isTerminated ? "stopped" : "done", point.seconds);
+    if (point.isTerminated) nTerminated++;
+    nEpochsTrained += (int)point.validationLosses.size();
+  }
+  printf("HyperparameterScan: %d of %d points stopped early, %d of %d "
+	 "epochs trained, %d steals\n", nTerminated, (int)m_points.size(),
+	 nEpochsTrained, (int)m_points.size() * m_nEpochs, m_nSteals);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Train all points, m_nThreads at a time, and record their results.
+*/
+void HyperparameterScan::run() {
+  int nPoints = (int)m_points.size();
+  if (nPoints == 0) return;
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  m_epochLosses.assign(m_nEpochs, std::vector<double>());
+  m_nSteals = 0;
+  for (int i_p = 0; i_p < nPoints; i_p++) {
+    m_points[i_p].validationLosses.clear();
+    m_points[i_p].trainingLoss = 0.0;
+    m_points[i_p].bestLoss = HUGE_VAL;
+    m_points[i_p].bestEpoch = 0;
+    m_points[i_p].isTerminated = false;
+    m_points[i_p].seconds = 0.0;
+  }
+
+  // Deal the points out round-robin, most weights first:
+  int nInputs = m_training->getNVariables();
+  int nOutputs = m_training->getNTargets();
+  std::vector<std::pair<long,int> > costs;
+  for (int i_p = 0; i_p < nPoints; i_p++) {
+    long nNodes = m_points[i_p].nNodesPerLayer;
+    long nWeights = (nInputs + 1) * nNodes + (nNodes + 1) * nOutputs
+      + (m_points[i_p].nHiddenLayers - 1) * (nNodes + 1) * nNodes;
+    costs.push_back(std::make_pair(-nWeights, i_p));
+  }
+  std::sort(costs.begin(), costs.end());
+  int nWorkers = std::min(m_nThreads, nPoints);
+  for (int i_q = 0; i_q < (int)m_queues.size(); i_q++) delete m_queues[i_q];
+  m_queues.clear();
+  for (int i_w = 0; i_w < nWorkers; i_w++) m_queues.push_back(new ScanQueue());
+  for (int i_p = 0; i_p < nPoints; i_p++) {
+    m_queues[i_p % nWorkers]->points.push_back(costs[i_p].second);
+  }
+
+  std::vector<std::thread> workers;
+  for (int i_w = 0; i_w < nWorkers; i_w++) {
+    workers.push_back(std::thread(&HyperparameterScan::work, this, i_w));
+  }
+  for (int i_w = 0; i_w < nWorkers; i_w++) workers[i_w].join();
+  if (m_verbose) {
+    printf("HyperparameterScan: %d points on %d threads in %.3g s\n",
+	   nPoints, nWorkers, std::chrono::duration<double>
+	   (std::chrono::steady_clock::now() - start).count());
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set whether points that are clearly losing are stopped early.
+   @param earlyTermination - True iff points may be stopped.
+*/
+void HyperparameterScan::setEarlyTermination(bool earlyTermination) {
+  m_earlyTermination = earlyTermination;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the number of epochs every point trains before it can be stopped.
+   @param nEpochs - The number of epochs.
+*/
+void HyperparameterScan::setGracePeriod(int nEpochs) {
+  if (nEpochs < 1) {
+    std::cout << "HyperparameterScan: ERROR! Grace period " << nEpochs
+	      << " is not allowed." << std::endl;
+    exit(0);
+  }
+  m_gracePeriod = nEpochs;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the transform of the input variables given to every network.
+   @param normalization - The (finalized) transform.
+*/
+void HyperparameterScan::setInputNormalization(const InputNormalization
+					       &normalization) {
+  m_normalization = normalization;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the mini-batch size of every point.
+   @param miniBatchSize - The number of events per weight update.
+*/
+void HyperparameterScan::setMiniBatchSize(int miniBatchSize) {
+  if (miniBatchSize < 1) {
+    std::cout << "HyperparameterScan: ERROR! Mini-batch size "
+	      << miniBatchSize << " is not allowed." << std::endl;
+    exit(0);
+  }
+  m_miniBatchSize = miniBatchSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the largest number of epochs of a point.
+   @param nEpochs - The number of epochs.
+*/
+void HyperparameterScan::setNEpochs(int nEpochs) {
+  if (nEpochs < 1) {
+    std::cout << "HyperparameterScan: ERROR! " << nEpochs
+	      << " epochs are not allowed." << std::endl;
+    exit(0);
+  }
+  m_nEpochs = nEpochs;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the seed of the scan. Point i initializes its weights and shuffles its
+   events with seed + i.
+   @param seed - The seed.
+*/
+void HyperparameterScan::setSeed(unsigned int seed) {
+  m_seed = seed;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the quantile of the other points' losses a point must beat to continue.
+   0.5 is the median stopping rule; higher values stop fewer points.
+   @param quantile - The quantile, in (0,1].
+*/
+void HyperparameterScan::setTerminationQuantile(double quantile) {
+  if (quantile <= 0.0 || quantile > 1.0) {
+    std::cout << "HyperparameterScan: ERROR! Quantile " << quantile
+	      << " is not allowed." << std::endl;
+    exit(0);
+  }
+  m_terminationQuantile = quantile;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set whether a line is printed for every point.
+   @param verbose - True iff the scan should print.
+*/
+void HyperparameterScan::setVerbose(bool verbose) {
+  m_verbose = verbose;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Train one point until its last epoch or until it is losing.
+   @param pointIndex - The index of the point.
+*/
+void HyperparameterScan::trainPoint(int pointIndex) {
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  ScanPoint &point = m_points[pointIndex];
+  NeuralNetwork network(m_training->getNVariables(),
+			m_training->getNTargets(), point.nHiddenLayers,
+			point.nNodesPerLayer, true);
+  network.randomizeNetworkWeights(m_seed + pointIndex);
+  if (m_normalization.getType() != kNoNormalization) {
+    network.setInputNormalization(m_normalization);
+  }
+  network.setNetworkLearningRate(point.learningRate);
+  network.setMiniBatchSize(m_miniBatchSize);
+  NetworkTrainer trainer(&network);
+  trainer.setSeed(m_seed + pointIndex);
+  trainer.setVerbose(false);
+  CompiledNetwork compiledNetwork(&network);
+  std::vector<double> outputs(m_validation->getNEvents() *
+			      m_validation->getNTargets());
+
+  for (int i_e = 0; i_e < m_nEpochs; i_e++) {
+    point.trainingLoss = trainer.trainEpoch(*m_training);
+    compiledNetwork.compile(&network);
+    double loss = validate(&compiledNetwork, outputs);
+    point.validationLosses.push_back(loss);
+    // A diverged network has a NaN loss and is never the best:
+    if (loss < point.bestLoss) {
+      point.bestLoss = loss;
+      point.bestEpoch = i_e + 1;
+    }
+    if (isLosing(i_e, loss, point.bestLoss) && i_e + 1 < m_nEpochs) {
+      point.isTerminated = true;
+      break;
+    }
+  }
+  point.seconds = std::chrono::duration<double>
+    (std::chrono::steady_clock::now() - start).count();
+  if (m_verbose) {
+    printf("HyperparameterScan: %d x %d rate %.6g loss %.6g after %d epochs"
+	   "%s\n", point.nHiddenLayers, point.nNodesPerLayer,
+	   point.learningRate, point.bestLoss,
+	   (int)point.validationLosses.size(),
+	   point.isTerminated ? " (stopped)" : "");
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Evaluate a network on the validation events.
+   @param network - The compiled network.
+   @param outputs - Scratch for the outputs, nEvents x nOutputs.
+   @returns - The mean weighted loss per event, as in NetworkTrainer.
+*/
+double HyperparameterScan::validate(CompiledNetwork *network,
+				    std::vector<double> &outputs) {
+  network->getBatchResponse(*m_validation, &outputs[0]);
+  int nOutputs = m_validation->getNTargets();
+  std::vector<double> targets(nOutputs);
+  double loss = 0.0;
+  for (int i_e = 0; i_e < m_validation->getNEvents(); i_e++) {
+    m_validation->getTargets(i_e, &targets[0]);
+    for (int i_o = 0; i_o < nOutputs; i_o++) {
+      double error = outputs[i_e * nOutputs + i_o] - targets[i_o];
+      loss += m_validation->getWeight(i_e) * 0.5 * error * error;
+    }
+  }
+  return (loss / m_validation->getNEvents());
+}
+
+/**
+   -----------------------------------------------------------------------------
+   The loop run by a worker thread: train points until none are left.
+   @param threadIndex - The index of the worker.
+*/
+void HyperparameterScan::work(int threadIndex) {
+  int pointIndex = nextPoint(threadIndex);
+  while (pointIndex >= 0) {
+    trainPoint(pointIndex);
+    pointIndex = nextPoint(threadIndex);
+  }
+}
@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: HyperparameterScan.h                                                //
+//  Class: HyperparameterScan.cxx                                             //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HyperparameterScan_h
+#define HyperparameterScan_h
+
+#include "CompiledNetwork.h"
+#include "EventBlock.h"
+#include "InputNormalization.h"
+#include "NetworkTrainer.h"
+#include "NeuralNetwork.h"
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+// One configuration of the scan and its results:
+struct ScanPoint {
+  int nHiddenLayers;
+  int nNodesPerLayer;
+  double learningRate;
+  std::vector<double> validationLosses;// After each epoch
+  double trainingLoss;// Of the last epoch
+  double bestLoss;// Lowest validation loss
+  int bestEpoch;// Epoch of bestLoss, from 1
+  bool isTerminated;// Stopped early
+  double seconds;
+};
+
+// The points waiting in one worker's queue, most expensive first:
+struct ScanQueue {
+  std::deque<int> points;
+  std::mutex mutex;
+};
+
+class HyperparameterScan
+{
+
+ public:
+
+  HyperparameterScan(const EventBlock &training,
+		     const EventBlock &validation, int nThreads);
+  ~HyperparameterScan();
+
+  // Accessors:
+  const ScanPoint& getBestPoint();
+  int getGracePeriod();
+  int getMiniBatchSize();
+  int getNEpochs();
+  int getNPoints();
+  int getNSteals();
+  int getNThreads();
+  const ScanPoint& getPoint(int pointIndex);
+  std::vector<int> getRanking();
+  double getTerminationQuantile();
+  bool hasEarlyTermination();
+  bool isVerbose();
+
+  // Mutators:
+  void addGrid(std::vector<int> nHiddenLayers,
+	       std::vector<int> nNodesPerLayer,
+	       std::vector<double> learningRates);
+  void addPoint(int nHiddenLayers, int nNodesPerLayer, double learningRate);
+  void printSummary();
+  void run();
+  void setEarlyTermination(bool earlyTermination);
+  void setGracePeriod(int nEpochs);
+  void setInputNormalization(const InputNormalization &normalization);
+  void setMiniBatchSize(int miniBatchSize);
+  void setNEpochs(int nEpochs);
+  void setSeed(unsigned int seed);
+  void setTerminationQuantile(double quantile);
+  void setVerbose(bool verbose);
+
+ private:
+
+  // Private functions:
+  bool isLosing(int epochIndex, double loss, double bestLoss);
+  int nextPoint(int threadIndex);
+  void trainPoint(int pointIndex);
+  double validate(CompiledNetwork *network, std::vector<double> &outputs);
+  void work(int threadIndex);
+
+  // Member objects:
+  const EventBlock *m_training;
+  const EventBlock *m_validation;
+  int m_nThreads;
+  InputNormalization m_normalization;
+  int m_miniBatchSize;
+  int m_nEpochs;
+  unsigned int m_seed;
+  bool m_verbose;
+
+  // Median stopping: after the grace period, a point stops when its best
+  // validation loss is worse than the given quantile of the losses that the
+  // other points reached after the same number of epochs:
+  bool m_earlyTermination;
+  int m_gracePeriod;
+  double m_terminationQuantile;
+  std::vector<std::vector<double> > m_epochLosses;
+
+  // The configurations, and one queue of point indices per worker:
+  std::vector<ScanPoint> m_points;
+  std::vector<ScanQueue*> m_queues;
+  int m_nSteals;
+  std::mutex m_mutex;
+
+};
+
+#endif
@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: InferenceBenchmark.cxx                                              //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Measures the InferenceServer on this machine alone. A server for a stored //
+//  model runs in this process, and stand-in clients (threads with an         //
+//  InferenceClient each) score random events one at a time through the       //
+//  socket, as separate analysis processes would. Each line gives the number  //
+//  of clients, the total throughput, the mean batch size and the largest     //
+//  deviation from scoring the events directly, which should be 0. The first  //
+//  line is the direct, unbatched rate of one process for comparison.         //
+//                                                                            //
+//  Usage: InferenceBenchmark <modelFile> [maxClients] [nEvents]              //
+//                            [maxBatchSize] [maxLatencyMicroseconds]         //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CompiledNetwork.h"
+#include "InferenceClient.h"
+#include "InferenceServer.h"
+#include "ModelFile.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+   -----------------------------------------------------------------------------
+   Score a share of the events one at a time through the server.
+   @param socketPath - The server's socket.
+   @param events - All events, row-major.
+   @param firstEvent - The first event of the share.
+   @param nEvents - The number of events in the share.
+   @param outputs - All outputs, row-major (output).
+*/
+void runClient(std::string socketPath, const std::vector<double> *events,
+	       int firstEvent, int nEvents, std::vector<double> *outputs) {
+  InferenceClient client(socketPath);
+  int nInputs = client.getNInputs();
+  int nOutputs = client.getNOutputs();
+  for (int i_e = firstEvent; i_e < firstEvent + nEvents; i_e++) {
+    client.getNetworkResponse(&(*events)[i_e * nInputs],
+			      &(*outputs)[i_e * nOutputs]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Main method: serve one model to an increasing number of clients.
+*/
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cout << "Usage: " << argv[0] << " <modelFile> [maxClients] "
+	      << "[nEvents] [maxBatchSize] [maxLatencyMicroseconds]"
+	      << std::endl;
+    exit(0);
+  }
+  ModelFile modelFile(argv[1]);
+  int maxClients = (argc > 2) ? atoi(argv[2]) : 16;
+  int nEvents = (argc > 3) ? atoi(argv[3]) : 200000;
+  CompiledNetwork *network = modelFile.getNetwork();
+  int nInputs = network->getNInputs();
+  int nOutputs = network->getNOutputs();
+
+  srand(0);
+  std::vector<double> events(nEvents * nInputs);
+  for (int i_v = 0; i_v < nEvents * nInputs; i_v++) {
+    events[i_v] = 2.0 * rand() / RAND_MAX - 1.0;
+  }
+  std::vector<double> reference(nEvents * nOutputs);
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  for (int i_e = 0; i_e < nEvents; i_e++) {
+    network->getNetworkResponse(&events[i_e * nInputs],
+				&reference[i_e * nOutputs]);
+  }
+  double seconds = std::chrono::duration<double>
+    (std::chrono::steady_clock::now() - start).count();
+  printf("# nClients eventsPerSecond meanBatchSize maxDeviation\n");
+  printf("direct %.6g 1 0\n", nEvents / seconds);
+
+  char socketPath[64];
+  snprintf(socketPath, sizeof(socketPath), "/tmp/InferenceBenchmark.%d.sock",
+	   (int)getpid());
+  std::vector<double> outputs(nEvents * nOutputs);
+  for (int nClients = 1; nClients <= maxClients; nClients *= 2) {
+    InferenceServer server(network, socketPath);
+    if (argc > 4) server.setMaxBatchSize(atoi(argv[4]));
+    if (argc > 5) server.setMaxLatency(atof(argv[5]));
+    server.start();
+    outputs.assign(nEvents * nOutputs, 0.0);
+    start = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients;
+    for (int i_c = 0; i_c < nClients; i_c++) {
+      int firstEvent = (int)((long)nEvents * i_c / nClients);
+      int lastEvent = (int)((long)nEvents * (i_c + 1) / nClients);
+      clients.push_back(std::thread(runClient, std::string(socketPath),
+				    &events, firstEvent,
+				    lastEvent - firstEvent, &outputs));
+    }
+    for (int i_c = 0; i_c < nClients; i_c++) clients[i_c].join();
+    seconds = std::chrono::duration<double>
+      (std::chrono::steady_clock::now() - start).count();
+    server.stop();
+
+    double maxDeviation = 0.0;
+    for (int i_o = 0; i_o < nEvents * nOutputs; i_o++) {
+      maxDeviation = std::max(maxDeviation,
+			      fabs(outputs[i_o] - reference[i_o]));
+    }
+    printf("%d %.6g %.2f %g\n", nClients, nEvents / seconds,
+	   server.getMeanBatchSize(), maxDeviation);
+  }
+  return 0;
+}
@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: InferenceClient.cxx                                                 //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class scores events with a network held by an InferenceServer on     //
+//  the same node. It has the evaluation interface of CompiledNetwork, so an  //
+//  analysis can switch from a network of its own to the shared one without   //
+//  other changes. Each call is one request and waits for the reply; calls    //
+//  from concurrent clients are batched together by the server.               //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "InferenceClient.h"
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+   -----------------------------------------------------------------------------
+   InferenceClient constructor. Connects to the server and reads its greeting.
+   @param socketPath - The file name of the server's Unix domain socket.
+*/
+InferenceClient::InferenceClient(std::string socketPath) {
+  m_socketPath = socketPath;
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    std::cout << "InferenceClient: ERROR! Socket path " << socketPath
+	      << " is too long." << std::endl;
+    exit(0);
+  }
+  strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path)-1);
+  m_fileDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (m_fileDescriptor < 0 ||
+      connect(m_fileDescriptor, (struct sockaddr*)&address,
+	      sizeof(address)) < 0) {
+    std::cout << "InferenceClient: ERROR! Cannot connect to " << socketPath
+	      << std::endl;
+    exit(0);
+  }
+  InferenceHeader header;
+  if (!InferenceServer::readFully(m_fileDescriptor, &header, sizeof(header))
+      || header.magic != kInferenceMagic) {
+    std::cout << "InferenceClient: ERROR! No InferenceServer on "
+	      << socketPath << std::endl;
+    exit(0);
+  }
+  m_nInputs = (int)header.nInputs;
+  m_nOutputs = (int)header.nOutputs;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   InferenceClient destructor. Closes the connection.
+*/
+InferenceClient::~InferenceClient() {
+  close(m_fileDescriptor);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score a set of events in one request.
+   @param events - The input variables, nEvents x nInputs in row-major order.
+   @param nEvents - The number of events.
+   @param outputs - The outputs, nEvents x nOutputs in row-major order.
+*/
+void InferenceClient::getBatchResponse(const double *events, int nEvents,
+				       double *outputs) {
+  if (nEvents < 1) return;
+  InferenceHeader header;
+  header.magic = kInferenceMagic;
+  header.nEvents = (uint32_t)nEvents;
+  header.nInputs = (uint32_t)m_nInputs;
+  header.nOutputs = (uint32_t)m_nOutputs;
+  if (!InferenceServer::writeFully(m_fileDescriptor, &header, sizeof(header))
+      || !InferenceServer::writeFully(m_fileDescriptor, events,
+				      (size_t)nEvents * m_nInputs
+				      * sizeof(double)) ||
+      !InferenceServer::readFully(m_fileDescriptor, &header, sizeof(header))) {
+    std::cout << "InferenceClient: ERROR! Lost the connection to "
+	      << m_socketPath << std::endl;
+    exit(0);
+  }
+  if (header.nEvents != (uint32_t)nEvents ||
+      header.nOutputs != (uint32_t)m_nOutputs) {
+    std::cout << "InferenceClient: ERROR! The server rejected " << nEvents
+	      << " events of " << m_nInputs << " inputs; expect "
+	      << header.nInputs << " inputs and at most " << kMaxRequestBytes
+	      << " bytes of inputs and outputs." << std::endl;
+    exit(0);
+  }
+  if (!InferenceServer::readFully(m_fileDescriptor, outputs, (size_t)nEvents
+				  * m_nOutputs * sizeof(double))) {
+    std::cout << "InferenceClient: ERROR! Lost the connection to "
+	      << m_socketPath << std::endl;
+    exit(0);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of input variables of the served network.
+*/
+int InferenceClient::getNInputs() {
+  return m_nInputs;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of outputs of the served network.
+*/
+int InferenceClient::getNOutputs() {
+  return m_nOutputs;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score a single event.
+   @param vars - The input variables.
+   @returns - The network outputs.
+*/
+std::vector<double> InferenceClient::getNetworkResponse(std::vector<double>
+							vars) {
+  if ((int)vars.size() != m_nInputs) {
+    std::cout << "InferenceClient: ERROR! Expect " << m_nInputs
+	      << " input variables." << std::endl;
+    exit(0);
+  }
+  std::vector<double> outputs(m_nOutputs);
+  getBatchResponse(&vars[0], 1, &outputs[0]);
+  return outputs;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score a single event.
+   @param vars - The nInputs input variables.
+   @param outputs - The nOutputs network outputs.
+*/
+void InferenceClient::getNetworkResponse(const double *vars, double *outputs) {
+  getBatchResponse(vars, 1, outputs);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The file name of the server's Unix domain socket.
+*/
+std::string InferenceClient::getSocketPath() {
+  return m_socketPath;
+}
@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: InferenceClient.h                                                   //
+//  Class: InferenceClient.cxx                                                //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef InferenceClient_h
+#define InferenceClient_h
+
+#include "InferenceServer.h"
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+class InferenceClient
+{
+
+ public:
+
+  InferenceClient(std::string socketPath);
+  ~InferenceClient();
+
+  // Accessors:
+  void getBatchResponse(const double *events, int nEvents, double *outputs);
+  int getNInputs();
+  int getNOutputs();
+  std::vector<double> getNetworkResponse(std::vector<double> vars);
+  void getNetworkResponse(const double *vars, double *outputs);
+  std::string getSocketPath();
+
+ private:
+
+  // Not copyable (owns the connection):
+  InferenceClient(const InferenceClient&);
+  InferenceClient& operator=(const InferenceClient&);
+
+  // Member objects:
+  std::string m_socketPath;
+  int m_fileDescriptor;
+  int m_nInputs;
+  int m_nOutputs;
+
+};
+
+#endif
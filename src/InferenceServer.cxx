@@ -0,0 +1,513 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: InferenceServer.cxx                                                 //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class serves the responses of one network to the other processes on  //
+//  a node over a Unix domain socket, so that a single warm copy of the model //
+//  scores the events of all of them in batches. Clients connect with an      //
+//  InferenceClient; the server greets each connection with the numbers of    //
+//  inputs and outputs, and then answers every request (an InferenceHeader    //
+//  and nEvents x nInputs doubles) with nEvents x nOutputs doubles.           //
+//                                                                            //
+//  Each connection has a thread that reads a request, queues it and sleeps   //
+//  until it is scored. One batch thread takes the queued requests, oldest    //
+//  first, as soon as they add up to setMaxBatchSize() events or the oldest   //
+//  has waited setMaxLatency() microseconds, and scores them together with    //
+//  CompiledNetwork::getBatchResponse(). Since a connection has one request   //
+//  in flight, the batch thread also stops waiting once every open connection //
+//  has a request queued. A request larger than a batch is scored on its own. //
+//  Requests are never split, so a client always gets the same scores as from //
+//  the network itself.                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "InferenceServer.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+   -----------------------------------------------------------------------------
+   InferenceServer constructor. Nothing is served before start().
+   @param network - The network to evaluate. It is not copied.
+   @param socketPath - The file name of the Unix domain socket.
+*/
+InferenceServer::InferenceServer(CompiledNetwork *network,
+				 std::string socketPath) {
+  m_network = network;
+  m_socketPath = socketPath;
+  m_maxBatchSize = 256;
+  m_maxLatency = 200.0;
+  m_verbose = false;
+  m_listenDescriptor = -1;
+  m_isRunning = false;
+  m_isStopping = false;
+  m_nOpenConnections = 0;
+  m_nQueuedEvents = 0;
+  m_nBatches = 0;
+  m_nEvents = 0;
+  m_nRequests = 0;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   InferenceServer destructor. Stops the server if it is running.
+*/
+InferenceServer::~InferenceServer() {
+  stop();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   The loop run by the accept thread: start a thread for each new connection
+   and clean up the connections that have closed. It ends when stop() shuts
+   the listening socket down.
+*/
+void InferenceServer::acceptLoop() {
+  while (true) {
+    int fileDescriptor = accept(m_listenDescriptor, NULL, NULL);
+    if (fileDescriptor < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      break;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_isStopping) {
+      close(fileDescriptor);
+      break;
+    }
+    std::list<InferenceConnection*>::iterator iterator
+      = m_connections.begin();
+    while (iterator != m_connections.end()) {
+      if ((*iterator)->isFinished) {
+	(*iterator)->thread.join();
+	delete *iterator;
+	iterator = m_connections.erase(iterator);
+      }
+      else iterator++;
+    }
+    InferenceConnection *connection = new InferenceConnection();
+    connection->fileDescriptor = fileDescriptor;
+    connection->isFinished = false;
+    connection->thread = std::thread(&InferenceServer::serve, this,
+				     connection);
+    m_connections.push_back(connection);
+    m_nOpenConnections++;
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   The loop run by the batch thread: collect requests until the batch is full
+   or the oldest request is due, score them and wake their connections. After
+   stop() the queue is drained before the loop ends.
+*/
+void InferenceServer::batchLoop() {
+  size_t nInputs = (size_t)m_network->getNInputs();
+  size_t nOutputs = (size_t)m_network->getNOutputs();
+  std::chrono::steady_clock::duration maxLatency
+    = std::chrono::duration_cast<std::chrono::steady_clock::duration>
+    (std::chrono::duration<double, std::micro>(m_maxLatency));
+  std::vector<InferenceRequest*> batch;
+  while (true) {
+    int nEvents = 0;
+    batch.clear();
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (m_queue.empty() && !m_isStopping) m_queueCondition.wait(lock);
+      if (m_queue.empty()) break;
+      std::chrono::steady_clock::time_point deadline
+	= m_queue.front()->arrival + maxLatency;
+      // A connection has one request at a time, so the batch cannot grow
+      // once every open connection is waiting:
+      while (m_nQueuedEvents < m_maxBatchSize &&
+	     (int)m_queue.size() < m_nOpenConnections && !m_isStopping) {
+	if (m_queueCondition.wait_until(lock, deadline)
+	    == std::cv_status::timeout) {
+	  break;
+	}
+      }
+      // The oldest requests that fit in a batch, and at least one:
+      while (!m_queue.empty() &&
+	     (batch.empty() ||
+	      nEvents + m_queue.front()->nEvents <= m_maxBatchSize)) {
+	batch.push_back(m_queue.front());
+	nEvents += m_queue.front()->nEvents;
+	m_nQueuedEvents -= m_queue.front()->nEvents;
+	m_queue.pop_front();
+      }
+    }
+
+    if (batch.size() == 1) {
+      m_network->getBatchResponse(batch[0]->events, nEvents,
+				  batch[0]->outputs);
+    }
+    else {
+      int i_e = 0;
+      for (int i_r = 0; i_r < (int)batch.size(); i_r++) {
+	memcpy(&m_batchEvents[i_e * nInputs], batch[i_r]->events,
+	       batch[i_r]->nEvents * nInputs * sizeof(double));
+	i_e += batch[i_r]->nEvents;
+      }
+      m_network->getBatchResponse(&m_batchEvents[0], nEvents,
+				  &m_batchOutputs[0]);
+      i_e = 0;
+      for (int i_r = 0; i_r < (int)batch.size(); i_r++) {
+	memcpy(batch[i_r]->outputs, &m_batchOutputs[i_e * nOutputs],
+	       batch[i_r]->nEvents * nOutputs * sizeof(double));
+	i_e += batch[i_r]->nEvents;
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      for (int i_r = 0; i_r < (int)batch.size(); i_r++) {
+	batch[i_r]->isDone = true;
+      }
+      m_nBatches++;
+      m_nEvents += nEvents;
+      m_nRequests += batch.size();
+    }
+    m_doneCondition.notify_all();
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The largest number of events scored together.
+*/
+int InferenceServer::getMaxBatchSize() {
+  return m_maxBatchSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The longest a request waits for a batch to fill, in microseconds.
+*/
+double InferenceServer::getMaxLatency() {
+  return m_maxLatency;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The mean number of events per batch since start().
+*/
+double InferenceServer::getMeanBatchSize() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return (m_nBatches > 0) ? ((double)m_nEvents / m_nBatches) : 0.0;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of batches scored since start().
+*/
+long InferenceServer::getNBatches() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nBatches;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of events scored since start().
+*/
+long InferenceServer::getNEvents() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nEvents;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of requests answered since start().
+*/
+long InferenceServer::getNRequests() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nRequests;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The file name of the Unix domain socket.
+*/
+std::string InferenceServer::getSocketPath() {
+  return m_socketPath;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - True between start() and stop().
+*/
+bool InferenceServer::isRunning() {
+  return m_isRunning;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - True if start() and stop() print a line.
+*/
+bool InferenceServer::isVerbose() {
+  return m_verbose;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Read a number of bytes from a socket, however many calls that takes.
+   @param fileDescriptor - The socket.
+   @param data - The destination.
+   @param nBytes - The number of bytes.
+   @returns - False if the connection closed or failed first.
+*/
+bool InferenceServer::readFully(int fileDescriptor, void *data,
+				size_t nBytes) {
+  char *bytes = (char*)data;
+  while (nBytes > 0) {
+    ssize_t nRead = recv(fileDescriptor, bytes, nBytes, 0);
+    if (nRead < 0 && errno == EINTR) continue;
+    if (nRead <= 0) return false;
+    bytes += nRead;
+    nBytes -= nRead;
+  }
+  return true;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   The loop run by a connection thread: greet the client, then read, queue
+   and answer its requests until it disconnects or sends a bad request.
+   @param connection - The connection.
+*/
+void InferenceServer::serve(InferenceConnection *connection) {
+  int fileDescriptor = connection->fileDescriptor;
+  InferenceHeader header;
+  header.magic = kInferenceMagic;
+  header.nEvents = 0;
+  header.nInputs = m_network->getNInputs();
+  header.nOutputs = m_network->getNOutputs();
+  bool isOpen = writeFully(fileDescriptor, &header, sizeof(header));
+
+  // All sizes in size_t, since nEvents x nInputs may not fit in 32 bits:
+  size_t nInputs = (size_t)m_network->getNInputs();
+  size_t nOutputs = (size_t)m_network->getNOutputs();
+  size_t maxRequestEvents = kMaxRequestBytes
+    / ((nInputs + nOutputs) * sizeof(double));
+  std::vector<double> events;
+  std::vector<double> outputs;
+  InferenceRequest request;
+  while (isOpen && readFully(fileDescriptor, &header, sizeof(header))) {
+    if (header.magic != kInferenceMagic || header.nEvents < 1 ||
+	header.nEvents > maxRequestEvents || header.nInputs != nInputs) {
+      // Tell the client what was expected and hang up:
+      header.magic = kInferenceMagic;
+      header.nEvents = 0;
+      header.nInputs = m_network->getNInputs();
+      header.nOutputs = m_network->getNOutputs();
+      writeFully(fileDescriptor, &header, sizeof(header));
+      break;
+    }
+    events.resize((size_t)header.nEvents * nInputs);
+    outputs.resize((size_t)header.nEvents * nOutputs);
+    if (!readFully(fileDescriptor, &events[0],
+		   events.size() * sizeof(double))) {
+      break;
+    }
+    request.events = &events[0];
+    request.outputs = &outputs[0];
+    request.nEvents = (int)header.nEvents;
+    request.isDone = false;
+    request.arrival = std::chrono::steady_clock::now();
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      if (m_isStopping) break;
+      m_queue.push_back(&request);
+      m_nQueuedEvents += request.nEvents;
+      m_queueCondition.notify_one();
+      while (!request.isDone) m_doneCondition.wait(lock);
+    }
+    header.nOutputs = m_network->getNOutputs();
+    isOpen = (writeFully(fileDescriptor, &header, sizeof(header)) &&
+	      writeFully(fileDescriptor, &outputs[0],
+			 outputs.size() * sizeof(double)));
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  close(fileDescriptor);
+  connection->fileDescriptor = -1;
+  connection->isFinished = true;
+  m_nOpenConnections--;
+  m_queueCondition.notify_one();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the largest number of events scored together. Set before start().
+   @param maxBatchSize - The number of events.
+*/
+void InferenceServer::setMaxBatchSize(int maxBatchSize) {
+  if (maxBatchSize < 1) {
+    std::cout << "InferenceServer: ERROR! Batch size " << maxBatchSize
+	      << " is not allowed." << std::endl;
+    exit(0);
+  }
+  m_maxBatchSize = maxBatchSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the longest a request waits for a batch to fill. Zero scores whatever
+   is queued at once. Set before start().
+   @param microseconds - The latency deadline in microseconds.
+*/
+void InferenceServer::setMaxLatency(double microseconds) {
+  if (microseconds < 0.0) {
+    std::cout << "InferenceServer: ERROR! Latency " << microseconds
+	      << " is not allowed." << std::endl;
+    exit(0);
+  }
+  m_maxLatency = microseconds;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set whether start() and stop() print a line.
+   @param verbose - True iff the server should print.
+*/
+void InferenceServer::setVerbose(bool verbose) {
+  m_verbose = verbose;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Create the socket and start serving in background threads. A socket file
+   left over by a server that is gone is replaced, but not a live one.
+*/
+void InferenceServer::start() {
+  if (m_isRunning) return;
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (m_socketPath.size() >= sizeof(address.sun_path)) {
+    std::cout << "InferenceServer: ERROR! Socket path " << m_socketPath
+	      << " is too long." << std::endl;
+    exit(0);
+  }
+  strncpy(address.sun_path, m_socketPath.c_str(), sizeof(address.sun_path)-1);
+
+  struct stat fileStatus;
+  if (stat(m_socketPath.c_str(), &fileStatus) == 0 &&
+      !S_ISSOCK(fileStatus.st_mode)) {
+    std::cout << "InferenceServer: ERROR! " << m_socketPath
+	      << " exists and is not a socket." << std::endl;
+    exit(0);
+  }
+  m_listenDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (m_listenDescriptor < 0) {
+    std::cout << "InferenceServer: ERROR! Cannot create a socket."
+	      << std::endl;
+    exit(0);
+  }
+  if (connect(m_listenDescriptor, (struct sockaddr*)&address,
+	      sizeof(address)) == 0) {
+    std::cout << "InferenceServer: ERROR! Another server is on "
+	      << m_socketPath << std::endl;
+    exit(0);
+  }
+  close(m_listenDescriptor);
+  m_listenDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(m_socketPath.c_str());
+  if (m_listenDescriptor < 0 ||
+      bind(m_listenDescriptor, (struct sockaddr*)&address,
+	   sizeof(address)) < 0 ||
+      listen(m_listenDescriptor, SOMAXCONN) < 0) {
+    std::cout << "InferenceServer: ERROR! Cannot listen on " << m_socketPath
+	      << ": " << strerror(errno) << std::endl;
+    exit(0);
+  }
+
+  // Room to gather the largest batch without allocating while serving:
+  m_batchEvents.assign((size_t)m_maxBatchSize * m_network->getNInputs(), 0.0);
+  m_batchOutputs.assign((size_t)m_maxBatchSize * m_network->getNOutputs(),
+			0.0);
+  m_nOpenConnections = 0;
+  m_nQueuedEvents = 0;
+  m_nBatches = 0;
+  m_nEvents = 0;
+  m_nRequests = 0;
+  m_isStopping = false;
+  m_isRunning = true;
+  m_batchThread = std::thread(&InferenceServer::batchLoop, this);
+  m_acceptThread = std::thread(&InferenceServer::acceptLoop, this);
+  if (m_verbose) {
+    printf("InferenceServer: Serving %d inputs -> %d outputs on %s\n",
+	   m_network->getNInputs(), m_network->getNOutputs(),
+	   m_socketPath.c_str());
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Stop serving: refuse new connections and requests, answer the queued ones,
+   close all connections and remove the socket file.
+*/
+void InferenceServer::stop() {
+  if (!m_isRunning) return;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isStopping = true;
+  }
+  m_queueCondition.notify_all();
+  shutdown(m_listenDescriptor, SHUT_RDWR);
+  m_acceptThread.join();
+  m_batchThread.join();
+  close(m_listenDescriptor);
+  m_listenDescriptor = -1;
+  unlink(m_socketPath.c_str());
+
+  // Wake the connection threads waiting for a request:
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::list<InferenceConnection*>::iterator iterator;
+    for (iterator = m_connections.begin(); iterator != m_connections.end();
+	 iterator++) {
+      if ((*iterator)->fileDescriptor >= 0) {
+	shutdown((*iterator)->fileDescriptor, SHUT_RDWR);
+      }
+    }
+  }
+  while (!m_connections.empty()) {
+    m_connections.front()->thread.join();
+    delete m_connections.front();
+    m_connections.pop_front();
+  }
+  m_isRunning = false;
+  if (m_verbose) {
+    printf("InferenceServer: Stopped after %ld requests, %ld events in %ld "
+	   "batches\n", m_nRequests, m_nEvents, m_nBatches);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Write a number of bytes to a socket, however many calls that takes. A
+   closed peer is reported rather than raising SIGPIPE.
+   @param fileDescriptor - The socket.
+   @param data - The source.
+   @param nBytes - The number of bytes.
+   @returns - False if the connection closed or failed first.
+*/
+bool InferenceServer::writeFully(int fileDescriptor, const void *data,
+				 size_t nBytes) {
+  const char *bytes = (const char*)data;
+  while (nBytes > 0) {
+    ssize_t nWritten = send(fileDescriptor, bytes, nBytes, MSG_NOSIGNAL);
+    if (nWritten < 0 && errno == EINTR) continue;
+    if (nWritten <= 0) return false;
+    bytes += nWritten;
+    nBytes -= nWritten;
+  }
+  return true;
+}
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: InferenceServer.h                                                   //
+//  Class: InferenceServer.cxx                                                //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef InferenceServer_h
+#define InferenceServer_h
+
+#include "CompiledNetwork.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Message header, in front of every greeting, request and reply. A request
+// is followed by nEvents x nInputs doubles, a reply by nEvents x nOutputs:
+struct InferenceHeader {
+  uint32_t magic;// kInferenceMagic
+  uint32_t nEvents;// 0 in the greeting and in the reply to a bad request
+  uint32_t nInputs;
+  uint32_t nOutputs;
+};
+
+static const uint32_t kInferenceMagic = 0x4e4e4953;// "NNIS"
+
+// Upper limit on the bytes of the inputs and outputs of one request, against
+// corrupt headers; larger requests are rejected:
+static const size_t kMaxRequestBytes = (size_t)1 << 28;
+
+// A request waiting to be scored, owned by its connection thread:
+struct InferenceRequest {
+  const double *events;
+  double *outputs;
+  int nEvents;
+  bool isDone;
+  std::chrono::steady_clock::time_point arrival;
+};
+
+// A client connection and the thread serving it:
+struct InferenceConnection {
+  int fileDescriptor;// -1 once the thread has closed it
+  std::thread thread;
+  bool isFinished;
+};
+
+class InferenceServer
+{
+
+ public:
+
+  InferenceServer(CompiledNetwork *network, std::string socketPath);
+  ~InferenceServer();
+
+  // Accessors:
+  int getMaxBatchSize();
+  double getMaxLatency();
+  double getMeanBatchSize();
+  long getNBatches();
+  long getNEvents();
+  long getNRequests();
+  std::string getSocketPath();
+  bool isRunning();
+  bool isVerbose();
+
+  // Mutators:
+  void setMaxBatchSize(int maxBatchSize);
+  void setMaxLatency(double microseconds);
+  void setVerbose(bool verbose);
+  void start();
+  void stop();
+
+  // Static functions:
+  static bool readFully(int fileDescriptor, void *data, size_t nBytes);
+  static bool writeFully(int fileDescriptor, const void *data,
+			 size_t nBytes);
+
+ private:
+
+  // Private functions:
+  void acceptLoop();
+  void batchLoop();
+  void serve(InferenceConnection *connection);
+
+  // Not copyable:
+  InferenceServer(const InferenceServer&);
+  InferenceServer& operator=(const InferenceServer&);
+
+  // Member objects:
+  CompiledNetwork *m_network;
+  std::string m_socketPath;
+  int m_maxBatchSize;
+  double m_maxLatency;// Microseconds
+  bool m_verbose;
+
+  // Server state:
+  int m_listenDescriptor;
+  bool m_isRunning;
+  bool m_isStopping;
+  std::thread m_acceptThread;
+  std::thread m_batchThread;
+  std::list<InferenceConnection*> m_connections;
+  int m_nOpenConnections;
+
+  // Requests queued for the batch thread, oldest first:
+  std::deque<InferenceRequest*> m_queue;
+  int m_nQueuedEvents;
+  std::mutex m_mutex;
+  std::condition_variable m_queueCondition;
+  std::condition_variable m_doneCondition;
+
+  // Contiguous events and outputs of a batch of several requests:
+  std::vector<double> m_batchEvents;
+  std::vector<double> m_batchOutputs;
+
+  // Statistics since start():
+  long m_nBatches;
+  long m_nEvents;
+  long m_nRequests;
+
+};
+
+#endif
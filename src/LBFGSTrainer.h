@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: LBFGSTrainer.h                                                      //
+//  Class: LBFGSTrainer.cxx                                                   //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LBFGSTrainer_h
+#define LBFGSTrainer_h
+
+#include "CompiledNetwork.h"
+#include "EventBlock.h"
+#include "NeuralNetwork.h"
+#include "NetworkState.h"
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+class LBFGSTrainer
+{
+
+ public:
+
+  LBFGSTrainer(NeuralNetwork *network, int nThreads);
+  ~LBFGSTrainer();
+
+  // Accessors:
+  CompiledNetwork* getCompiledNetwork();
+  double getGradientNorm();
+  int getHistorySize();
+  double getLoss();
+  int getMaxIterations();
+  int getNEvaluations();
+  int getNIterations();
+  int getNThreads();
+  double getTolerance();
+  bool isVerbose();
+
+  // Mutators:
+  double evaluate(const EventBlock &block, const double *parameters,
+		  double *gradient);
+  void setHistorySize(int historySize);
+  void setMaxIterations(int maxIterations);
+  void setNThreads(int nThreads);
+  void setTolerance(double tolerance);
+  void setVerbose(bool verbose);
+  double train(const EventBlock &block);
+  void updateNetwork();
+
+ private:
+
+  // Private functions:
+  void evaluateWorker(int threadIndex, const EventBlock *block,
+		      const double *parameters);
+  bool lineSearch(const EventBlock &block, const double *direction,
+		  double *step, double *loss);
+
+  // Member objects:
+  NeuralNetwork *m_network;
+  CompiledNetwork *m_compiledNetwork;
+  std::vector<NetworkState*> m_states;
+  std::vector<double> m_losses;
+  int m_nThreads;
+  int m_historySize;
+  int m_maxIterations;
+  double m_tolerance;
+  bool m_verbose;
+
+  // Current point of the minimization: loss and gradient at the weights of
+  // m_compiledNetwork:
+  double m_loss;
+  std::vector<double> m_gradient;
+  int m_nIterations;
+  int m_nEvaluations;
+
+  // Line search scratch: trial weights and the gradient there:
+  std::vector<double> m_trialParameters;
+  std::vector<double> m_trialGradient;
+
+  // Correction pairs s = x_k+1 - x_k and y = g_k+1 - g_k, in a ring buffer:
+  std::vector<std::vector<double> > m_steps;
+  std::vector<std::vector<double> > m_gradientChanges;
+  std::vector<double> m_curvatures;// 1 / (y.s)
+  std::vector<double> m_alphas;
+
+};
+
+#endif
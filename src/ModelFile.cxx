@@ -0,0 +1,299 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: ModelFile.cxx                                                       //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class saves and loads trained networks in a versioned binary format. //
+//  A model file holds the topology (layer sizes, activation functions and    //
+//  bias flags), the InputNormalization and the flat parameter block of a     //
+//  CompiledNetwork, in that order (see ModelFile.h for the header).          //
+//                                                                            //
+//  Loading maps the file read-only and evaluates straight from the mapped    //
+//  parameters: nothing is parsed or copied apart from the few topology       //
+//  numbers. The pages of the mapping come from the page cache, so all of the //
+//  processes on a node that load the same model share one physical copy.     //
+//  createNeuralNetwork() makes an ordinary trainable copy instead.           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ModelFile.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char kModelFileMagic[8] = {'N','N','M','O','D','E','L','\0'};
+static const uint32_t kModelFileVersion = 1;
+static const uint32_t kModelFileByteOrder = 0x01020304;
+static const uint64_t kParameterAlignment = 64;
+
+/**
+   -----------------------------------------------------------------------------
+   Write values to a model file being created, and give up if they do not all
+   fit (e.g. on a full disk), rather than leave a truncated model behind.
+   @param file - The file.
+   @param data - The values.
+   @param valueSize - The size of one value in bytes.
+   @param nValues - The number of values.
+   @param fileName - The name of the file, for the error message.
+*/
+static void writeValues(FILE *file, const void *data, size_t valueSize,
+			size_t nValues, const std::string &fileName) {
+  if (fwrite(data, valueSize, nValues, file) != nValues) {
+    std::cout << "ModelFile: ERROR! Failed to write " << fileName << std::endl;
+    fclose(file);
+    exit(0);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   ModelFile constructor. Maps the model file and checks it.
+   @param fileName - The name of the model file.
+*/
+ModelFile::ModelFile(std::string fileName) {
+  m_fileName = fileName;
+  m_network = NULL;
+  m_fileDescriptor = open(fileName.c_str(), O_RDONLY);
+  if (m_fileDescriptor < 0) {
+    std::cout << "ModelFile: ERROR! Cannot open " << fileName << std::endl;
+    exit(0);
+  }
+  struct stat fileStatus;
+  fstat(m_fileDescriptor, &fileStatus);
+  m_size = (size_t)fileStatus.st_size;
+  if (m_size < sizeof(ModelFileHeader)) {
+    std::cout << "ModelFile: ERROR! " << fileName << " is too short."
+	      << std::endl;
+    exit(0);
+  }
+  m_data = (char*)mmap(NULL, m_size, PROT_READ, MAP_SHARED, m_fileDescriptor,
+		       0);
+  if (m_data == MAP_FAILED) {
+    std::cout << "ModelFile: ERROR! Cannot map " << fileName << std::endl;
+    exit(0);
+  }
+
+  // Check the header:
+  const ModelFileHeader *header = (const ModelFileHeader*)m_data;
+  if (memcmp(header->magic, kModelFileMagic, sizeof(kModelFileMagic)) != 0) {
+    std::cout << "ModelFile: ERROR! " << fileName << " is not a model file."
+	      << std::endl;
+    exit(0);
+  }
+  if (header->version != kModelFileVersion ||
+      header->byteOrder != kModelFileByteOrder) {
+    std::cout << "ModelFile: ERROR! " << fileName << " has version "
+	      << header->version << " or byte order; expect version "
+	      << kModelFileVersion << " in native byte order." << std::endl;
+    exit(0);
+  }
+  if (header->fileSize != m_size || header->nLayers < 2 ||
+      header->layerOffset + header->nLayers * sizeof(ModelFileLayer) > m_size ||
+      header->parameterOffset % kParameterAlignment != 0 ||
+      header->parameterOffset + header->nParameters * sizeof(double) > m_size) {
+    std::cout << "ModelFile: ERROR! " << fileName << " is corrupt."
+	      << std::endl;
+    exit(0);
+  }
+
+  // Read the topology:
+  const ModelFileLayer *layers
+    = (const ModelFileLayer*)(m_data + header->layerOffset);
+  std::vector<int> layerSizes;
+  std::vector<ActivationFunction> layerFunctions;
+  std::vector<bool> layerHasBias;
+  uint64_t nParameters = 0;
+  for (uint32_t i_l = 0; i_l < header->nLayers; i_l++) {
+    if (layers[i_l].size < 1 || layers[i_l].function > kSine) {
+      std::cout << "ModelFile: ERROR! Layer " << i_l << " of " << fileName
+		<< " is corrupt." << std::endl;
+      exit(0);
+    }
+    layerSizes.push_back((int)layers[i_l].size);
+    layerFunctions.push_back((ActivationFunction)layers[i_l].function);
+    layerHasBias.push_back(layers[i_l].hasBias != 0);
+    if (i_l > 0) {
+      nParameters += (uint64_t)layers[i_l].size * (layers[i_l-1].size + 1);
+    }
+  }
+  if (nParameters != header->nParameters) {
+    std::cout << "ModelFile: ERROR! " << fileName
+	      << " has the wrong number of parameters." << std::endl;
+    exit(0);
+  }
+
+  // Read the input normalization:
+  InputNormalization normalization;
+  if (header->normalizationType != kNoNormalization) {
+    int nKnots = (int)header->nNormalizationSegments + 1;
+    if (header->normalizationType > kQuantileNormalization ||
+	header->nNormalizationSegments < 1 ||
+	header->normalizationOffset + layerSizes[0] * nKnots * sizeof(double)
+	> m_size) {
+      std::cout << "ModelFile: ERROR! " << fileName
+		<< " has a corrupt normalization." << std::endl;
+      exit(0);
+    }
+    normalization
+      = InputNormalization(layerSizes[0],
+			   (NormalizationType)header->normalizationType,
+			   (int)header->nNormalizationSegments);
+    const double *knots
+      = (const double*)(m_data + header->normalizationOffset);
+    for (int i_v = 0; i_v < layerSizes[0]; i_v++) {
+      normalization.setKnots(i_v, std::vector<double>
+			     (&knots[i_v * nKnots], &knots[(i_v+1) * nKnots]));
+    }
+  }
+
+  // Evaluate directly from the mapped parameters:
+  m_network = new CompiledNetwork(layerSizes, layerFunctions, layerHasBias,
+				  normalization,
+				  (const double*)(m_data +
+						  header->parameterOffset),
+				  true);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   ModelFile destructor. Deletes the network and unmaps the file.
+*/
+ModelFile::~ModelFile() {
+  if (m_network) delete m_network;
+  munmap(m_data, m_size);
+  close(m_fileDescriptor);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Create a trainable NeuralNetwork with the stored topology, weights and
+   normalization. The caller owns the new network. Only the topology built by
+   the NeuralNetwork constructor (equal sigmoid hidden layers, linear input and
+   output layers) can be created.
+   @returns - The new NeuralNetwork.
+*/
+NeuralNetwork* ModelFile::createNeuralNetwork() {
+  int nLayers = m_network->getNLayers();
+  int nNodes = (nLayers > 2) ? m_network->getLayerSize(1) : 1;
+  for (int i_l = 0; i_l < nLayers; i_l++) {
+    bool isHidden = (i_l > 0 && i_l < nLayers-1);
+    ActivationFunction function = isHidden ? kSigmoid : kLinear;
+    if (m_network->getLayerFunction(i_l) != function ||
+	(isHidden && m_network->getLayerSize(i_l) != nNodes)) {
+      std::cout << "ModelFile: ERROR! " << m_fileName << " does not have the "
+		<< "topology of a NeuralNetwork." << std::endl;
+      exit(0);
+    }
+  }
+  NeuralNetwork *network = new NeuralNetwork(m_network->getNInputs(),
+					     m_network->getNOutputs(),
+					     nLayers-2, nNodes);
+  m_network->exportWeights(network);
+  return network;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The name of the model file.
+*/
+std::string ModelFile::getFileName() {
+  return m_fileName;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - A read-only network that evaluates from the mapped parameters.
+   It is owned by the ModelFile and may be shared by any number of threads,
+   using the NetworkState overloads of its evaluation methods.
+*/
+CompiledNetwork* ModelFile::getNetwork() {
+  return m_network;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Save a compiled network.
+   @param fileName - The name of the model file to create.
+   @param network - The network to save.
+*/
+void ModelFile::write(std::string fileName, CompiledNetwork *network) {
+  int nLayers = network->getNLayers();
+  int nInputs = network->getNInputs();
+  const InputNormalization &normalization = network->getInputNormalization();
+  bool normalize = (normalization.getType() != kNoNormalization);
+  int nKnots = normalization.getNSegments() + 1;
+
+  // Lay out the file:
+  ModelFileHeader header;
+  memset(&header, 0, sizeof(ModelFileHeader));
+  memcpy(header.magic, kModelFileMagic, sizeof(kModelFileMagic));
+  header.version = kModelFileVersion;
+  header.byteOrder = kModelFileByteOrder;
+  header.nLayers = nLayers;
+  header.normalizationType = normalize ? normalization.getType() :
+    kNoNormalization;
+  header.nNormalizationSegments = normalize ? normalization.getNSegments() : 0;
+  header.nParameters = network->getNParameters();
+  header.layerOffset = sizeof(ModelFileHeader);
+  header.normalizationOffset = header.layerOffset
+    + nLayers * sizeof(ModelFileLayer);
+  uint64_t normalizationSize = normalize ?
+    nInputs * nKnots * sizeof(double) : 0;
+  header.parameterOffset = header.normalizationOffset + normalizationSize;
+  header.parameterOffset = ((header.parameterOffset + kParameterAlignment - 1)
+			    / kParameterAlignment) * kParameterAlignment;
+  header.fileSize = header.parameterOffset
+    + header.nParameters * sizeof(double);
+
+  std::vector<ModelFileLayer> layers(nLayers);
+  for (int i_l = 0; i_l < nLayers; i_l++) {
+    layers[i_l].size = network->getLayerSize(i_l);
+    layers[i_l].function = network->getLayerFunction(i_l);
+    layers[i_l].hasBias = network->layerHasBias(i_l) ? 1 : 0;
+    layers[i_l].reserved = 0;
+  }
+
+  FILE *file = fopen(fileName.c_str(), "wb");
+  if (!file) {
+    std::cout << "ModelFile: ERROR! Cannot create " << fileName << std::endl;
+    exit(0);
+  }
+  writeValues(file, &header, sizeof(ModelFileHeader), 1, fileName);
+  writeValues(file, &layers[0], sizeof(ModelFileLayer), nLayers, fileName);
+  for (int i_v = 0; i_v < nInputs && normalize; i_v++) {
+    std::vector<double> knots = normalization.getKnots(i_v);
+    writeValues(file, &knots[0], sizeof(double), nKnots, fileName);
+  }
+  long position = ftell(file);
+  if (position < 0 || (uint64_t)position > header.parameterOffset) {
+    std::cout << "ModelFile: ERROR! Failed to write " << fileName << std::endl;
+    fclose(file);
+    exit(0);
+  }
+  const char padding[kParameterAlignment] = {0};
+  writeValues(file, padding, 1, header.parameterOffset - position, fileName);
+  std::vector<double> parameters = network->getParameters();
+  writeValues(file, &parameters[0], sizeof(double), parameters.size(),
+	      fileName);
+  if (fclose(file) != 0) {
+    std::cout << "ModelFile: ERROR! Failed to write " << fileName << std::endl;
+    exit(0);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Save a network.
+   @param fileName - The name of the model file to create.
+   @param network - The network to save.
+*/
+void ModelFile::write(std::string fileName, NeuralNetwork *network) {
+  CompiledNetwork compiledNetwork(network);
+  write(fileName, &compiledNetwork);
+}
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: ModelFile.h                                                         //
+//  Class: ModelFile.cxx                                                      //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ModelFile_h
+#define ModelFile_h
+
+#include "CompiledNetwork.h"
+#include "InputNormalization.h"
+#include "NeuralNetwork.h"
+#include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+// File header, at offset 0:
+struct ModelFileHeader {
+  char magic[8];// "NNMODEL"
+  uint32_t version;
+  uint32_t byteOrder;// 0x01020304 as written
+  uint32_t nLayers;
+  uint32_t normalizationType;// NormalizationType
+  uint32_t nNormalizationSegments;
+  uint32_t reserved;
+  uint64_t nParameters;
+  uint64_t layerOffset;// Of the ModelFileLayer array
+  uint64_t normalizationOffset;// Of the knots, nInputs x (nSegments+1)
+  uint64_t parameterOffset;// Of the parameter block, 64 byte aligned
+  uint64_t fileSize;
+};
+
+// Layer descriptors, nLayers of them, input layer first:
+struct ModelFileLayer {
+  uint32_t size;
+  uint32_t function;// ActivationFunction
+  uint32_t hasBias;
+  uint32_t reserved;
+};
+
+class ModelFile
+{
+
+ public:
+
+  ModelFile(std::string fileName);
+  ~ModelFile();
+
+  // Accessors:
+  NeuralNetwork* createNeuralNetwork();
+  std::string getFileName();
+  CompiledNetwork* getNetwork();
+
+  // Static functions:
+  static void write(std::string fileName, CompiledNetwork *network);
+  static void write(std::string fileName, NeuralNetwork *network);
+
+ private:
+
+  // Not copyable (owns the mapping and m_network):
+  ModelFile(const ModelFile&);
+  ModelFile& operator=(const ModelFile&);
+
+  // Member objects:
+  std::string m_fileName;
+  int m_fileDescriptor;
+  char *m_data;
+  size_t m_size;
+  CompiledNetwork *m_network;
+
+};
+
+#endif
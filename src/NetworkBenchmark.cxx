@@ -0,0 +1,213 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: NetworkBenchmark.cxx                                                //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Measures inference latency, throughput, training speed and memory over a //
+//  sweep of topologies (nInputs x nHiddenLayers x nNodesPerLayer). For each  //
+//  topology it prints one line with:                                        //
+//                                                                            //
+//  - the single-event getNetworkResponse() latency of the NeuralNetwork and  //
+//    of the CompiledNetwork, in nanoseconds,                                 //
+//  - the getBatchResponse() throughput of the CompiledNetwork,               //
+//  - the updateNetworkViaBP() training throughput of the NeuralNetwork,      //
+//  - the memory footprint of the NeuralNetwork (heap and arena mode) and of  //
+//    the CompiledNetwork, in bytes.                                          //
+//                                                                            //
+//  The output is whitespace-separated with '#' comment lines, and the first  //
+//  line names the format version and the kernel instruction set, so results  //
+//  from different versions and machines can be compared directly. Each      //
+//  measurement is repeated for at least minSeconds (default 0.2).            //
+//                                                                            //
+//  Usage: NetworkBenchmark [minSeconds]                                      //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Activation.h"
+#include "CompiledNetwork.h"
+#include "NeuralNetwork.h"
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// Version of the output columns, to be incremented when they change:
+const int kFormatVersion = 1;
+
+// Number of distinct random events cycled through by each measurement:
+const int kNEvents = 4096;
+
+// Number of single-event calls between clock checks (large networks are slow):
+const int kNCheck = 64;
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The seconds elapsed since the start time.
+*/
+double elapsed(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>
+    (std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The mean single-event latency of NeuralNetwork in nanoseconds.
+*/
+double networkLatency(NeuralNetwork *network, std::vector<double> &events,
+		      double minSeconds) {
+  int nInputs = network->getNInputs();
+  std::vector<double> outputs(network->getNOutputs());
+  long nCalls = 0;
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  do {
+    for (int i_e = 0; i_e < kNCheck; i_e++) {
+      int event = (int)(nCalls % kNEvents);
+      network->getNetworkResponse(&events[event * nInputs], &outputs[0]);
+      nCalls++;
+    }
+  } while (elapsed(start) < minSeconds);
+  return (1e9 * elapsed(start) / ((double)nCalls));
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The mean single-event latency of CompiledNetwork in nanoseconds.
+*/
+double compiledLatency(CompiledNetwork *network, std::vector<double> &events,
+		       double minSeconds) {
+  int nInputs = network->getNInputs();
+  std::vector<double> outputs(network->getNOutputs());
+  long nCalls = 0;
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  do {
+    for (int i_e = 0; i_e < kNCheck; i_e++) {
+      int event = (int)(nCalls % kNEvents);
+      network->getNetworkResponse(&events[event * nInputs], &outputs[0]);
+      nCalls++;
+    }
+  } while (elapsed(start) < minSeconds);
+  return (1e9 * elapsed(start) / ((double)nCalls));
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The getBatchResponse() throughput in events per second.
+*/
+double batchRate(CompiledNetwork *network, std::vector<double> &events,
+		 double minSeconds) {
+  std::vector<double> outputs(kNEvents * network->getNOutputs());
+  long nCalls = 0;
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  do {
+    network->getBatchResponse(&events[0], kNEvents, &outputs[0]);
+    nCalls += kNEvents;
+  } while (elapsed(start) < minSeconds);
+  return (nCalls / elapsed(start));
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The updateNetworkViaBP() throughput in events per second.
+*/
+double trainingRate(NeuralNetwork *network, std::vector<double> &events,
+		    std::vector<double> &targets, double minSeconds) {
+  int nInputs = network->getNInputs();
+  int nOutputs = network->getNOutputs();
+  std::vector<double> outputs(nOutputs);
+  network->setNetworkLearningRate(0.01);
+  long nCalls = 0;
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  do {
+    for (int i_e = 0; i_e < kNCheck; i_e++) {
+      int event = (int)(nCalls % kNEvents);
+      network->getNetworkResponse(&events[event * nInputs], &outputs[0]);
+      network->setNetworkTargets(&targets[event * nOutputs]);
+      network->updateNetworkViaBP();
+      nCalls++;
+    }
+  } while (elapsed(start) < minSeconds);
+  return (nCalls / elapsed(start));
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Benchmark one topology and print its line of results.
+*/
+void runTopology(int nInputs, int nHiddenLayers, int nNodesPerLayer,
+		 double minSeconds) {
+  int nOutputs = 1;
+  std::vector<double> events(kNEvents * nInputs);
+  std::vector<double> targets(kNEvents * nOutputs);
+  for (int i_v = 0; i_v < (int)events.size(); i_v++) {
+    events[i_v] = 2.0 * rand() / ((double)RAND_MAX) - 1.0;
+  }
+  for (int i_t = 0; i_t < (int)targets.size(); i_t++) {
+    targets[i_t] = (rand() % 2 == 0) ? 0.8 : -0.8;
+  }
+
+  NeuralNetwork *network = new NeuralNetwork(nInputs, nOutputs, nHiddenLayers,
+					     nNodesPerLayer);
+  network->randomizeNetworkWeights();
+  NeuralNetwork *arenaNetwork = new NeuralNetwork(nInputs, nOutputs,
+						  nHiddenLayers,
+						  nNodesPerLayer, true);
+  CompiledNetwork *compiled = new CompiledNetwork(network);
+
+  double networkNs = networkLatency(network, events, minSeconds);
+  double compiledNs = compiledLatency(compiled, events, minSeconds);
+  double batchPerSecond = batchRate(compiled, events, minSeconds);
+  double bpPerSecond = trainingRate(network, events, targets, minSeconds);
+
+  printf("%d %d %d %d %.6g %.6g %.6g %.6g %lu %lu %lu\n", nInputs,
+	 nHiddenLayers, nNodesPerLayer, compiled->getNParameters(), networkNs,
+	 compiledNs, batchPerSecond, bpPerSecond,
+	 (unsigned long)network->getMemoryFootprint(),
+	 (unsigned long)arenaNetwork->getMemoryFootprint(),
+	 (unsigned long)compiled->getMemoryFootprint());
+  fflush(stdout);
+  delete compiled;
+  delete arenaNetwork;
+  delete network;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Main method: sweep the topologies.
+*/
+int main(int argc, char **argv) {
+  double minSeconds = (argc > 1) ? atof(argv[1]) : 0.2;
+  if (minSeconds <= 0.0) {
+    std::cout << "Usage: " << argv[0] << " [minSeconds]" << std::endl;
+    exit(0);
+  }
+  const int nInputValues = 3;
+  const int inputValues[nInputValues] = {4, 16, 64};
+  const int nLayerValues = 3;
+  const int layerValues[nLayerValues] = {1, 2, 4};
+  const int nNodeValues = 4;
+  const int nodeValues[nNodeValues] = {8, 32, 128, 256};
+
+  srand(1);
+  printf("# NetworkBenchmark format %d instructionSet %s\n", kFormatVersion,
+	 Activation::getInstructionSetName().c_str());
+  printf("# nInputs nHiddenLayers nNodesPerLayer nParameters networkLatencyNs "
+	 "compiledLatencyNs batchEventsPerSecond bpEventsPerSecond "
+	 "networkBytes arenaNetworkBytes compiledBytes\n");
+  for (int i_i = 0; i_i < nInputValues; i_i++) {
+    for (int i_l = 0; i_l < nLayerValues; i_l++) {
+      for (int i_n = 0; i_n < nNodeValues; i_n++) {
+	runTopology(inputValues[i_i], layerValues[i_l], nodeValues[i_n],
+		    minSeconds);
+      }
+    }
+  }
+  return 0;
+}
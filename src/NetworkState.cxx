@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: NetworkState.cxx                                                    //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class holds the per-event scratch of a CompiledNetwork: responses,   //
+//  response derivatives and deltas of every node, plus a gradient buffer     //
+//  and the summed loss. Keeping this state outside of the network lets each  //
+//  thread evaluate and train against the same weights independently.        //
+//  Threads that only score events share one read-only CompiledNetwork and    //
+//  pass their own NetworkState to getNetworkResponse()/getBatchResponse().   //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NetworkState.h"
+#include "CompiledNetwork.h"
+
+/**
+   -----------------------------------------------------------------------------
+   NetworkState constructor.
+   @param network - The CompiledNetwork that this state will be used with.
+*/
+NetworkState::NetworkState(const CompiledNetwork *network) {
+  resize(network);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   NetworkState destructor. All storage is owned by member vectors.
+*/
+NetworkState::~NetworkState() {
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Clear the gradient buffer and the summed loss.
+*/
+void NetworkState::clearGradient() {
+  for (int i_p = 0; i_p < (int)m_gradient.size(); i_p++) m_gradient[i_p] = 0.0;
+  m_loss = 0.0;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - A copy of the gradient accumulated since the last clear.
+*/
+std::vector<double> NetworkState::getGradient() {
+  return m_gradient;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - A pointer to the gradient buffer, laid out like the parameters of
+   the CompiledNetwork.
+*/
+double* NetworkState::getGradientData() {
+  return &m_gradient[0];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The loss summed over the events accumulated since the last clear.
+*/
+double NetworkState::getLoss() {
+  return m_loss;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - A pointer to the responses of the most recent double-precision
+   event, layer after layer in the order of the CompiledNetwork layers.
+*/
+const double* NetworkState::getResponseData() const {
+  return &m_responses[0];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Size the scratch buffers for a network and clear the gradient.
+   @param network - The CompiledNetwork that this state will be used with.
+*/
+void NetworkState::resize(const CompiledNetwork *network) {
+  int nNodes = 0;
+  for (int i_l = 0; i_l < network->getNLayers(); i_l++) {
+    nNodes += network->getLayerSize(i_l);
+  }
+  m_responses.assign(nNodes, 0.0);
+  m_derivatives.assign(nNodes, 0.0);
+  m_deltas.assign(nNodes, 0.0);
+  m_blockResponses.clear();
+  m_floatResponses.clear();
+  m_floatDerivatives.clear();
+  m_floatDeltas.clear();
+  m_floatBlockResponses.clear();
+  m_gradient.assign(network->getNParameters(), 0.0);
+  m_loss = 0.0;
+}
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: NetworkState.h                                                      //
+//  Class: NetworkState.cxx                                                   //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NetworkState_h
+#define NetworkState_h
+
+#include <vector>
+
+class CompiledNetwork;
+
+class NetworkState
+{
+
+ public:
+
+  NetworkState(const CompiledNetwork *network);
+  ~NetworkState();
+
+  // Accessors:
+  std::vector<double> getGradient();
+  double* getGradientData();
+  double getLoss();
+  const double* getResponseData() const;
+
+  // Mutators:
+  void clearGradient();
+  void resize(const CompiledNetwork *network);
+
+ private:
+
+  friend class CompiledNetwork;
+
+  // Per-node scratch, laid out like CompiledNetwork responses:
+  std::vector<double> m_responses;
+  std::vector<double> m_derivatives;
+  std::vector<double> m_deltas;
+
+  // Node-major block scratch for batched evaluation, sized on first use:
+  std::vector<double> m_blockResponses;
+
+  // The same in single precision, sized on first use:
+  std::vector<float> m_floatResponses;
+  std::vector<float> m_floatDerivatives;
+  std::vector<float> m_floatDeltas;
+  std::vector<float> m_floatBlockResponses;
+
+  // Gradient buffer, laid out like CompiledNetwork parameters:
+  std::vector<double> m_gradient;
+  double m_loss;
+
+};
+
+#endif
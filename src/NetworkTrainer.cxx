@@ -0,0 +1,343 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: NetworkTrainer.cxx                                                  //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class runs training epochs over a dataset, such as a memory-mapped  //
+//  EventFile. A background thread prepares the data: at the start of each   //
+//  epoch it shuffles the event order, then it gathers the events block by    //
+//  block into contiguous row-major variables, targets and weights. There are //
+//  two such buffers, so the next block is decoded while the current one      //
+//  trains, and the next epoch is shuffled while the current one finishes.    //
+//                                                                            //
+//  The blocks train either a NeuralNetwork, event by event through           //
+//  getNetworkResponse(), setNetworkTargets() and updateNetworkViaBP(), or a  //
+//  ParallelTrainer, one train() call per block. The loss, throughput and the //
+//  time spent waiting for data are recorded for every epoch.                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NetworkTrainer.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+/**
+   -----------------------------------------------------------------------------
+   NetworkTrainer constructor, training a NeuralNetwork event by event. Its
+   learning rate and mini-batch size are used as they are. Event weights only
+   enter the reported loss.
+   @param network - The network to train.
+*/
+NetworkTrainer::NetworkTrainer(NeuralNetwork *network) {
+  m_network = network;
+  m_trainer = NULL;
+  m_blockSize = 4096;
+  m_shuffled = true;
+  m_seed = 1;
+  m_verbose = true;
+  m_nEpochs = 0;
+  m_loss = 0.0;
+  m_eventsPerSecond = 0.0;
+  m_waitSeconds = 0.0;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   NetworkTrainer constructor, training through a ParallelTrainer, one block
+   per call of ParallelTrainer::train(). Choose a block size that is a
+   multiple of the mini-batch size of the trainer.
+   @param trainer - The trainer.
+*/
+NetworkTrainer::NetworkTrainer(ParallelTrainer *trainer) {
+  m_network = NULL;
+  m_trainer = trainer;
+  m_blockSize = 4096;
+  m_shuffled = true;
+  m_seed = 1;
+  m_verbose = true;
+  m_nEpochs = 0;
+  m_loss = 0.0;
+  m_eventsPerSecond = 0.0;
+  m_waitSeconds = 0.0;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   NetworkTrainer destructor. The network or trainer is not owned.
+*/
+NetworkTrainer::~NetworkTrainer() {
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Gather a block of events into a buffer.
+   @param data - The dataset.
+   @param order - The event order of the epoch.
+   @param firstEvent - The position in the order of the first event to gather.
+   @param buffer - The buffer to fill.
+*/
+void NetworkTrainer::fillBuffer(const EventBlock *data,
+				const std::vector<int> &order, int firstEvent,
+				PrefetchBuffer *buffer) {
+  int nVariables = data->getNVariables();
+  int nTargets = data->getNTargets();
+  int nEvents = std::min(m_blockSize, (int)order.size() - firstEvent);
+  buffer->variables.resize(m_blockSize * nVariables);
+  buffer->targets.resize(m_blockSize * nTargets);
+  buffer->weights.resize(m_blockSize);
+  for (int i_e = 0; i_e < nEvents; i_e++) {
+    int event = order[firstEvent + i_e];
+    data->getEvent(event, &buffer->variables[i_e * nVariables]);
+    data->getTargets(event, &buffer->targets[i_e * nTargets]);
+    buffer->weights[i_e] = data->getWeight(event);
+  }
+  buffer->nEvents = nEvents;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of events per block.
+*/
+int NetworkTrainer::getBlockSize() {
+  return m_blockSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The training throughput of the most recent epoch.
+*/
+double NetworkTrainer::getEventsPerSecond() {
+  return m_eventsPerSecond;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The mean weighted loss per event of the most recent epoch,
+   measured before each weight update.
+*/
+double NetworkTrainer::getLoss() {
+  return m_loss;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of epochs trained so far.
+*/
+int NetworkTrainer::getNEpochs() {
+  return m_nEpochs;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The time the training spent waiting for data in the most recent
+   epoch. This should be close to zero.
+*/
+double NetworkTrainer::getWaitSeconds() {
+  return m_waitSeconds;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - True if the event order is shuffled for each epoch.
+*/
+bool NetworkTrainer::isShuffled() {
+  return m_shuffled;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - True if a line is printed after each epoch.
+*/
+bool NetworkTrainer::isVerbose() {
+  return m_verbose;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   The loop run by the prefetch thread: shuffle each epoch and fill the
+   buffers in turn, waiting whenever both are full.
+   @param data - The dataset.
+   @param firstEpoch - The index of the first epoch, for the shuffling seed.
+   @param nEpochs - The number of epochs.
+*/
+void NetworkTrainer::prefetch(const EventBlock *data, int firstEpoch,
+			      int nEpochs) {
+  int nEvents = data->getNEvents();
+  std::vector<int> order(nEvents);
+  int nBuffersFilled = 0;
+  for (int i_e = 0; i_e < nEpochs; i_e++) {
+    for (int i_o = 0; i_o < nEvents; i_o++) order[i_o] = i_o;
+    if (m_shuffled) {
+      // A fixed seed per epoch keeps the training reproducible:
+      std::mt19937 generator(m_seed + firstEpoch + i_e);
+      std::shuffle(order.begin(), order.end(), generator);
+    }
+    for (int i_b = 0; i_b < nEvents; i_b += m_blockSize) {
+      PrefetchBuffer *buffer = &m_buffers[nBuffersFilled % 2];
+      {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (buffer->isFull) m_condition.wait(lock);
+      }
+      fillBuffer(data, order, i_b, buffer);
+      {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	buffer->isFull = true;
+      }
+      m_condition.notify_all();
+      nBuffersFilled++;
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the number of events per block.
+   @param blockSize - The number of events per block.
+*/
+void NetworkTrainer::setBlockSize(int blockSize) {
+  if (blockSize < 1) {
+    std::cout << "NetworkTrainer: ERROR! Block size must be positive."
+	      << std::endl;
+    exit(0);
+  }
+  m_blockSize = blockSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the seed of the shuffling. Epoch i is shuffled with seed + i.
+   @param seed - The seed.
+*/
+void NetworkTrainer::setSeed(unsigned int seed) {
+  m_seed = seed;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Choose whether the event order is shuffled for each epoch (the default).
+   @param shuffled - True to shuffle.
+*/
+void NetworkTrainer::setShuffled(bool shuffled) {
+  m_shuffled = shuffled;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Choose whether a line is printed after each epoch (the default):
+   NetworkTrainer: epoch <n> loss <loss> events/s <rate> wait <seconds> s
+   @param verbose - True to print.
+*/
+void NetworkTrainer::setVerbose(bool verbose) {
+  m_verbose = verbose;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Train for several epochs over a dataset. One prefetch thread serves all of
+   the epochs.
+   @param data - The dataset.
+   @param nEpochs - The number of epochs.
+   @returns - The mean loss per event of the last epoch.
+*/
+double NetworkTrainer::train(const EventBlock &data, int nEpochs) {
+  int nInputs = m_network ? m_network->getNInputs() :
+    m_trainer->getCompiledNetwork()->getNInputs();
+  int nOutputs = m_network ? m_network->getNOutputs() :
+    m_trainer->getCompiledNetwork()->getNOutputs();
+  if (data.getNVariables() != nInputs || data.getNTargets() != nOutputs) {
+    std::cout << "NetworkTrainer: ERROR! Data does not match the network."
+	      << std::endl;
+    exit(0);
+  }
+  int nEvents = data.getNEvents();
+  if (nEvents <= 0 || nEpochs <= 0) return 0.0;
+  m_buffers[0].isFull = false;
+  m_buffers[1].isFull = false;
+  std::thread prefetcher(&NetworkTrainer::prefetch, this, &data, m_nEpochs,
+			 nEpochs);
+
+  int nBuffersTrained = 0;
+  for (int i_e = 0; i_e < nEpochs; i_e++) {
+    std::chrono::steady_clock::time_point start
+      = std::chrono::steady_clock::now();
+    double loss = 0.0;
+    double waitSeconds = 0.0;
+    for (int i_b = 0; i_b < nEvents; i_b += m_blockSize) {
+      PrefetchBuffer *buffer = &m_buffers[nBuffersTrained % 2];
+      {
+	std::chrono::steady_clock::time_point waitStart
+	  = std::chrono::steady_clock::now();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (!buffer->isFull) m_condition.wait(lock);
+	waitSeconds += std::chrono::duration<double>
+	  (std::chrono::steady_clock::now() - waitStart).count();
+      }
+      loss += trainBuffer(buffer);
+      {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	buffer->isFull = false;
+      }
+      m_condition.notify_all();
+      nBuffersTrained++;
+    }
+    double seconds = std::chrono::duration<double>
+      (std::chrono::steady_clock::now() - start).count();
+    m_loss = loss / ((double)nEvents);
+    m_eventsPerSecond = nEvents / seconds;
+    m_waitSeconds = waitSeconds;
+    m_nEpochs++;
+    if (m_verbose) {
+      printf("NetworkTrainer: epoch %d loss %.6g events/s %.4g wait %.3g s\n",
+	     m_nEpochs, m_loss, m_eventsPerSecond, m_waitSeconds);
+    }
+  }
+  prefetcher.join();
+  return m_loss;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Train on the events of one buffer.
+   @param buffer - The buffer.
+   @returns - The summed weighted loss of the events.
+*/
+double NetworkTrainer::trainBuffer(PrefetchBuffer *buffer) {
+  int nEvents = buffer->nEvents;
+  if (m_trainer) {
+    CompiledNetwork *network = m_trainer->getCompiledNetwork();
+    EventBlock block(&buffer->variables[0], &buffer->targets[0], nEvents,
+		     network->getNInputs(), network->getNOutputs());
+    block.setWeights(&buffer->weights[0], kDoubleColumn, sizeof(double));
+    return (m_trainer->train(block) * nEvents);
+  }
+  int nInputs = m_network->getNInputs();
+  int nOutputs = m_network->getNOutputs();
+  std::vector<double> outputs(nOutputs);
+  double loss = 0.0;
+  for (int i_e = 0; i_e < nEvents; i_e++) {
+    const double *targets = &buffer->targets[i_e * nOutputs];
+    m_network->getNetworkResponse(&buffer->variables[i_e * nInputs],
+				  &outputs[0]);
+    for (int i_o = 0; i_o < nOutputs; i_o++) {
+      double error = outputs[i_o] - targets[i_o];
+      loss += buffer->weights[i_e] * 0.5 * error * error;
+    }
+    m_network->setNetworkTargets(targets);
+    m_network->updateNetworkViaBP();
+  }
+  return loss;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Train for one epoch over a dataset.
+   @param data - The dataset.
+   @returns - The mean loss per event of the epoch.
+*/
+double NetworkTrainer::trainEpoch(const EventBlock &data) {
+  return train(data, 1);
+}
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: NetworkTrainer.h                                                    //
+//  Class: NetworkTrainer.cxx                                                 //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NetworkTrainer_h
+#define NetworkTrainer_h
+
+#include "EventBlock.h"
+#include "NeuralNetwork.h"
+#include "ParallelTrainer.h"
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+// One block of decoded events, in row-major arrays:
+struct PrefetchBuffer {
+  std::vector<double> variables;// [nEvents x nVariables]
+  std::vector<double> targets;// [nEvents x nTargets]
+  std::vector<double> weights;// [nEvents]
+  int nEvents;
+  bool isFull;
+};
+
+class NetworkTrainer
+{
+
+ public:
+
+  NetworkTrainer(NeuralNetwork *network);
+  NetworkTrainer(ParallelTrainer *trainer);
+  ~NetworkTrainer();
+
+  // Accessors:
+  int getBlockSize();
+  double getEventsPerSecond();
+  double getLoss();
+  int getNEpochs();
+  double getWaitSeconds();
+  bool isShuffled();
+  bool isVerbose();
+
+  // Mutators:
+  void setBlockSize(int blockSize);
+  void setSeed(unsigned int seed);
+  void setShuffled(bool shuffled);
+  void setVerbose(bool verbose);
+  double train(const EventBlock &data, int nEpochs);
+  double trainEpoch(const EventBlock &data);
+
+ private:
+
+  // Private functions:
+  void fillBuffer(const EventBlock *data, const std::vector<int> &order,
+		  int firstEvent, PrefetchBuffer *buffer);
+  void prefetch(const EventBlock *data, int firstEpoch, int nEpochs);
+  double trainBuffer(PrefetchBuffer *buffer);
+
+  // Member objects:
+  NeuralNetwork *m_network;
+  ParallelTrainer *m_trainer;
+  int m_blockSize;
+  bool m_shuffled;
+  unsigned int m_seed;
+  bool m_verbose;
+
+  // Statistics of the most recent epoch:
+  int m_nEpochs;
+  double m_loss;
+  double m_eventsPerSecond;
+  double m_waitSeconds;
+
+  // Two buffers: the prefetch thread fills one while the other trains:
+  PrefetchBuffer m_buffers[2];
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+
+};
+
+#endif
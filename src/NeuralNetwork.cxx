@@ -17,18 +17,20 @@
 //  - back-propagation                                                        //
 //  - ?                                                                       //
 //                                                                            //
-//  Note: need to think about how to train a network using many events and    //
-//  not just one at a time. In particular, how to track a group of responses. //
-//  Maybe have a response library for each node, which has to be cleared      //
-//  independently? Maybe the response library should just be a sum that is    //
-//  stored.                                                                   //
+//  Note: the forward, backward and clear passes are flat loops over a        //
+//  topological order of the Neurons, computed once after the network is     //
+//  built. Each Neuron is visited once per pass, and the memoized response    //
+//  and delta of its neighbours are always ready, so nothing recurses.        //
 //                                                                            //
-//  Note: For the moment, train on single event at a time. Stochastic? See    //
-//  wikipedia for inspiration.                                                //
+//  Note: training on many events at a time uses a gradient buffer in each    //
+//  Axon. accumulateNetworkGradient() adds the gradient of the current event  //
+//  and applyNetworkGradient() updates all weights once per mini-batch. With  //
+//  a mini-batch size of 1 (the default) this is stochastic gradient descent. //
 //                                                                            //
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "NeuralNetwork.h"
+#include <random>
 
 /**
    NeuralNetwork constructor.
@@ -36,15 +38,40 @@
    @param nOutputs - The number of output variables.
    @param nHiddenLayers- The number of internal network layers.
    @param nNodesPerLayer - The number of nodes per hidden layer, excluding bias
+   @param useArena - True to allocate all Neurons and Axons in a few contiguous
+   blocks, in layer order, that are released at once by the destructor.
  */
 NeuralNetwork::NeuralNetwork(int nInputs, int nOutputs, int nHiddenLayers,
-			     int nNodesPerLayer) {
+			     int nNodesPerLayer, bool useArena) {
   m_nInputs = nInputs;
   m_nOutputs = nOutputs;
   m_nHiddenLayers = nHiddenLayers;
   m_nNodesPerLayer = nNodesPerLayer;
+  m_miniBatchSize = 1;
+  m_nAccumulated = 0;
   m_axons.clear();
   m_neurons.clear();
+  m_schedule.clear();
+  m_layerBegins.clear();
+  m_layerEnds.clear();
+  m_arena = NULL;
+  m_optimizer = NULL;
+  
+  // Count the nodes and connections so that they fit in a single block:
+  int nNeurons = m_nInputs + m_nHiddenLayers * (m_nNodesPerLayer+1) + m_nOutputs;
+  int nAxons = 0;
+  int nPrevious = m_nInputs;
+  for (int i_i = 1; i_i <= m_nHiddenLayers; i_i++) {
+    nAxons += nPrevious * m_nNodesPerLayer;
+    nPrevious = m_nNodesPerLayer + 1;
+  }
+  nAxons += nPrevious * m_nOutputs;
+  m_neurons.reserve(nNeurons);
+  m_axons.reserve(nAxons);
+  if (useArena) {
+    m_arena = new Arena(nNeurons * (sizeof(Neuron) + alignof(Neuron)) +
+			nAxons * (sizeof(Axon) + alignof(Axon)));
+  }
   
   // Add the first (visible) layer:
   addLayer(0, m_nInputs, "linear"); 
@@ -57,34 +84,185 @@ NeuralNetwork::NeuralNetwork(int nInputs, int nOutputs, int nHiddenLayers,
   addLayer(m_nHiddenLayers+1, m_nOutputs, "linear");
 }
 
+/**
+   -----------------------------------------------------------------------------
+   NeuralNetwork destructor. Deletes all Neurons and Axons. In arena mode only
+   their destructors are called here, and the memory is released all at once
+   when the Arena is deleted.
+*/
+NeuralNetwork::~NeuralNetwork() {
+  for (std::vector<Axon*>::iterator axonIter = m_axons.begin();
+       axonIter != m_axons.end(); axonIter++) {
+    if (m_arena) (*axonIter)->~Axon();
+    else delete (*axonIter);
+  }
+  for (std::vector<Neuron*>::iterator neuroIter = m_neurons.begin();
+       neuroIter != m_neurons.end(); neuroIter++) {
+    if (m_arena) (*neuroIter)->~Neuron();
+    else delete (*neuroIter);
+  }
+  m_axons.clear();
+  m_neurons.clear();
+  m_schedule.clear();
+  if (m_arena) delete m_arena;
+  if (m_optimizer) delete m_optimizer;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Back-propagate the errors of the current event and add the resulting weight
+   gradients to the gradient buffer of each Axon. No weights are changed. 
+   Assumes the response has just been evaluated and network targets have also
+   been set.
+*/
+void NeuralNetwork::accumulateNetworkGradient() {
+  NN_SCOPE(&m_instrumentation);
+  // First clear all deltas:
+  clearNetworkDelta();
+  
+  // Then compute the deltas in reverse topological order. The deltas of all
+  // downstream Neurons are already memoized when getDelta() is called, so each
+  // Neuron is evaluated exactly once without recursion.
+  {
+    NN_TIME(kDeltaPhase);
+    for (std::vector<Neuron*>::reverse_iterator neuroIter = m_schedule.rbegin();
+	 neuroIter != m_schedule.rend(); neuroIter++) {
+      (*neuroIter)->getDelta();
+    }
+  }
+  
+  // Finally add the gradient of each connection, now that all deltas are set:
+  {
+    NN_TIME(kGradientPhase);
+    for (std::vector<Axon*>::iterator axonIter = m_axons.begin();
+	 axonIter != m_axons.end(); axonIter++) {
+      (*axonIter)->accumulateGradient();
+    }
+  }
+  m_nAccumulated++;
+}
+
 /**
    -----------------------------------------------------------------------------
    Add a layer to the neural network and connect to the preceding layer (if it
-   is not the first layer (index = 0). 
+   is not the first layer (index = 0). The Neurons of a layer are stored
+   contiguously, so each layer can only be added once.
    @param layerIndex - The index of the layer. 
    @param nodesPerLayer - The number of nodes per hidden layer.
 */
 void NeuralNetwork::addLayer(int layerIndex, int nodesPerLayer, 
 			     std::string function) {
+  if (layerIndex < (int)m_layerBegins.size() && 
+      m_layerEnds[layerIndex] > m_layerBegins[layerIndex]) {
+    std::cout << "NeuralNetwork: ERROR! Layer " << layerIndex 
+	      << " already exists." << std::endl;
+    exit(0);
+  }
+  if (layerIndex >= (int)m_layerBegins.size()) {
+    m_layerBegins.resize(layerIndex+1, 0);
+    m_layerEnds.resize(layerIndex+1, 0);
+  }
+  m_layerBegins[layerIndex] = (int)m_neurons.size();
+  
+  // Get a list of upstream neurons.
+  std::vector<Neuron*> previousLayer;
+  if (layerIndex > 0) previousLayer = getLayer(layerIndex-1);
   for (int i_n = 0; i_n < nodesPerLayer; i_n++) {
-    Neuron *currNeuron = new Neuron(layerIndex, function);
+    Neuron *currNeuron = createNeuron(layerIndex, function);
     if (layerIndex > 0) {
-      // Get a list of upstream neurons.
-      std::vector<Neuron*> previousLayer = getLayer(layerIndex-1);
       // Create a connection to each.
       for (std::vector<Neuron*>::iterator neuroIter = previousLayer.begin();
 	   neuroIter != previousLayer.end(); neuroIter++) {
-	Axon *currAxon = new Axon(1.0, *neuroIter, currNeuron);
-	m_axons.push_back(currAxon);
+	Axon *currAxon = createAxon(1.0, *neuroIter, currNeuron);
+	(*neuroIter)->addDownstreamConnection(currAxon);
+	currNeuron->addUpstreamConnection(currAxon);
       }
     }
-    m_neurons.push_back(currNeuron);
   }
   // Then add a bias node (not for input or output layers):
   if (layerIndex > 0 && layerIndex != m_nHiddenLayers+1) {
-    Neuron *currNeuron = new Neuron(layerIndex, function);
+    Neuron *currNeuron = createNeuron(layerIndex, function);
     currNeuron->setBiasNode(true);
-    m_neurons.push_back(currNeuron);
+  }
+  m_layerEnds[layerIndex] = (int)m_neurons.size();
+  buildSchedule();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Update all weights in the network using the mean gradient accumulated since
+   the last update, then clear the gradient buffers.
+*/
+void NeuralNetwork::applyNetworkGradient() {
+  if (m_nAccumulated == 0) return;
+  NN_SCOPE(&m_instrumentation);
+  NN_TIME(kUpdatePhase);
+  if (m_optimizer) {
+    // Gather the weights and gradients for one fused update, then scatter:
+    int nAxons = (int)m_axons.size();
+    for (int i_a = 0; i_a < nAxons; i_a++) {
+      m_optimizerWeights[i_a] = m_axons[i_a]->getWeight();
+      m_optimizerGradients[i_a] = m_axons[i_a]->getGradient();
+    }
+    m_optimizer->update(&m_optimizerWeights[0], &m_optimizerGradients[0],
+			m_nAccumulated);
+    for (int i_a = 0; i_a < nAxons; i_a++) {
+      m_axons[i_a]->setWeight(m_optimizerWeights[i_a]);
+      m_axons[i_a]->clearGradient();
+    }
+  }
+  else {
+    for (std::vector<Axon*>::iterator axonIter = m_axons.begin();
+	 axonIter != m_axons.end(); axonIter++) {
+      (*axonIter)->applyGradient(m_nAccumulated);
+    }
+  }
+  m_nAccumulated = 0;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Compute the topological execution order of the Neurons with Kahn's
+   algorithm: a Neuron is scheduled once all of its upstream Neurons are. Input
+   and bias nodes come first, in the order they were created.
+*/
+void NeuralNetwork::buildSchedule() {
+  m_schedule.clear();
+  std::map<Neuron*,int> nWaiting;
+  std::deque<Neuron*> ready;
+  for (std::vector<Neuron*>::iterator neuroIter = m_neurons.begin();
+       neuroIter != m_neurons.end(); neuroIter++) {
+    nWaiting[*neuroIter] = (*neuroIter)->getNUpstreamConnections();
+    if (nWaiting[*neuroIter] == 0) ready.push_back(*neuroIter);
+  }
+  while (!ready.empty()) {
+    Neuron *currNeuron = ready.front();
+    ready.pop_front();
+    m_schedule.push_back(currNeuron);
+    std::vector<Axon*> downstream = currNeuron->getDownstreamConnections();
+    for (std::vector<Axon*>::iterator axonIter = downstream.begin();
+	 axonIter != downstream.end(); axonIter++) {
+      Neuron *terminal = (*axonIter)->getTerminalNeuron();
+      nWaiting[terminal]--;
+      if (nWaiting[terminal] == 0) ready.push_back(terminal);
+    }
+  }
+  if (m_schedule.size() != m_neurons.size()) {
+    std::cout << "NeuralNetwork: ERROR! Network contains a cycle." << std::endl;
+    exit(0);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Clear the deltas of all Neurons in the network.
+*/
+void NeuralNetwork::clearNetworkDelta() {
+  NN_SCOPE(&m_instrumentation);
+  NN_TIME(kClearPhase);
+  for (std::vector<Neuron*>::iterator neuroIter = m_neurons.begin();
+       neuroIter != m_neurons.end(); neuroIter++) {
+    (*neuroIter)->clearDelta();
   }
 }
 
@@ -93,6 +271,8 @@ void NeuralNetwork::addLayer(int layerIndex, int nodesPerLayer,
    Clear the responses of all Neurons in the network.
 */
 void NeuralNetwork::clearNetworkResponse() {
+  NN_SCOPE(&m_instrumentation);
+  NN_TIME(kClearPhase);
   for (std::vector<Neuron*>::iterator neuroIter = m_neurons.begin();
        neuroIter != m_neurons.end(); neuroIter++) {
     (*neuroIter)->clearResponse();
@@ -110,6 +290,48 @@ void NeuralNetwork::clearNetworkResponse() {
 //  }
 //}
 
+/**
+   -----------------------------------------------------------------------------
+   Create a new connection owned by the network, in the Arena if there is one.
+   @param weight - The new connection weight.
+   @param originNeuron - The upstream neuron for the connection.
+   @param terminalNeuron - The downstream neuron for the connection.
+   @returns - A pointer to the new Axon.
+*/
+Axon* NeuralNetwork::createAxon(double weight, Neuron *originNeuron,
+				Neuron *terminalNeuron) {
+  Axon *axon = NULL;
+  if (m_arena) {
+    void *memory = m_arena->allocate(sizeof(Axon), alignof(Axon));
+    axon = new (memory) Axon(weight, originNeuron, terminalNeuron);
+  }
+  else {
+    axon = new Axon(weight, originNeuron, terminalNeuron);
+  }
+  m_axons.push_back(axon);
+  return axon;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Create a new node owned by the network, in the Arena if there is one.
+   @param layerIndex - The index of the layer in which the Neuron resides.
+   @param function - The activation function for the neuron.
+   @returns - A pointer to the new Neuron.
+*/
+Neuron* NeuralNetwork::createNeuron(int layerIndex, std::string function) {
+  Neuron *neuron = NULL;
+  if (m_arena) {
+    void *memory = m_arena->allocate(sizeof(Neuron), alignof(Neuron));
+    neuron = new (memory) Neuron(layerIndex, function);
+  }
+  else {
+    neuron = new Neuron(layerIndex, function);
+  }
+  m_neurons.push_back(neuron);
+  return neuron;
+}
+
 /**
    -----------------------------------------------------------------------------
    Get the Neurons that are bias nodes.
@@ -125,6 +347,24 @@ std::vector<Neuron*> NeuralNetwork::getBiasNodes() {
   return result;
 }
 
+/**
+   -----------------------------------------------------------------------------
+   @returns - The transform applied to the raw input variables.
+*/
+const InputNormalization& NeuralNetwork::getInputNormalization() {
+  return m_normalization;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The hot-path statistics of the network since it was built or
+   since resetInstrumentation(). They are all zero unless the project is
+   compiled with NN_INSTRUMENTATION; getReport() gives a printable summary.
+*/
+const Instrumentation& NeuralNetwork::getInstrumentation() {
+  return m_instrumentation;
+}
+
 /**
    -----------------------------------------------------------------------------
    Get the Neurons in the input layer.
@@ -133,6 +373,15 @@ std::vector<Neuron*> NeuralNetwork::getInputLayer() {
   return getLayer(0);
 }
 
+/**
+   -----------------------------------------------------------------------------
+   @returns - The optimizer that updates the weights, or NULL if the Axons
+   update themselves with plain SGD.
+*/
+Optimizer* NeuralNetwork::getOptimizer() {
+  return m_optimizer;
+}
+
 /**
    -----------------------------------------------------------------------------
    Get the Neurons in the output layer.
@@ -148,15 +397,75 @@ std::vector<Neuron*> NeuralNetwork::getOutputLayer() {
    @returns - A vector of Neurons in the specified layer.
 */
 std::vector<Neuron*> NeuralNetwork::getLayer(int layerIndex) {
-  std::vector<Neuron*> layer; layer.clear();
-  // Loop over all neurons stored and return the ones with the proper layer idx.
+  if (layerIndex < 0 || layerIndex >= (int)m_layerBegins.size()) {
+    return std::vector<Neuron*>();
+  }
+  return std::vector<Neuron*>(m_neurons.begin() + m_layerBegins[layerIndex],
+			      m_neurons.begin() + m_layerEnds[layerIndex]);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Estimate the heap memory held by the network: the nodes, the connections
+   and their pointer lists, and the bookkeeping vectors. In arena mode the
+   whole reserved block is counted. Allocator overhead is not included.
+   @returns - The memory footprint in bytes.
+*/
+size_t NeuralNetwork::getMemoryFootprint() {
+  size_t nBytes = sizeof(NeuralNetwork);
+  if (m_arena) nBytes += m_arena->getNBytesReserved();
+  else {
+    nBytes += m_neurons.size() * sizeof(Neuron) + m_axons.size() * sizeof(Axon);
+  }
   for (std::vector<Neuron*>::iterator neuroIter = m_neurons.begin();
        neuroIter != m_neurons.end(); neuroIter++) {
-    if ((*neuroIter)->getLayerIndex() == layerIndex) {
-      layer.push_back(*neuroIter);
-    }
+    nBytes += ((*neuroIter)->getNDownstreamConnections() +
+	       (*neuroIter)->getNUpstreamConnections()) * sizeof(Axon*);
   }
-  return layer;
+  nBytes += (m_neurons.capacity() + m_schedule.capacity()) * sizeof(Neuron*);
+  nBytes += m_axons.capacity() * sizeof(Axon*);
+  nBytes += (m_layerBegins.capacity() + m_layerEnds.capacity()) * sizeof(int);
+  return nBytes;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of events accumulated per weight update.
+*/
+int NeuralNetwork::getMiniBatchSize() {
+  return m_miniBatchSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of hidden layers in the network.
+*/
+int NeuralNetwork::getNHiddenLayers() {
+  return m_nHiddenLayers;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of input variables (input layer nodes).
+*/
+int NeuralNetwork::getNInputs() {
+  return m_nInputs;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The total number of layers, including input and output layers.
+*/
+int NeuralNetwork::getNLayers() {
+  return m_nHiddenLayers + 2;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of output variables (output layer nodes).
+*/
+int NeuralNetwork::getNOutputs() {
+  return m_nOutputs;
 }
 
 /**
@@ -164,47 +473,60 @@ std::vector<Neuron*> NeuralNetwork::getLayer(int layerIndex) {
    Retrieve the network response based on the given inputs.
 */
 std::vector<double> NeuralNetwork::getNetworkResponse(std::vector<double> vars){
+  NN_SCOPE(&m_instrumentation);
   if ((int)vars.size() != m_nInputs) {
     std::cout << "NeuralNetwork: ERROR! Wrong size of inputs." << std::endl;
     exit(0);
   }
-  
-  // FIRST, VARS SHOULD HAVE RANGE -1,1. 
+  std::vector<double> result(m_nOutputs);
+  getNetworkResponse(&vars[0], &result[0]);
+  return result;
+}
 
-  std::vector<double> result; result.clear();
-  
+/**
+   -----------------------------------------------------------------------------
+   Retrieve the network response based on the given inputs, without any heap
+   allocation: the layers are located by their precomputed index ranges.
+   @param vars - The m_nInputs input variables.
+   @param outputs - Buffer for the m_nOutputs responses of the output layer.
+*/
+void NeuralNetwork::getNetworkResponse(const double *vars, double *outputs) {
+  NN_SCOPE(&m_instrumentation);
+  NN_COUNT(kEventCount);
   // First clear the responses in the network.
   clearNetworkResponse();
   
-  // Then set input layer responses using input variables:
-  std::vector<Neuron*> inputLayer = getInputLayer();
+  // Then set input layer responses using input variables, mapped onto [-1,1]
+  // by the InputNormalization (if any):
+  NN_TIME(kForwardPhase);
+  int inputBegin = m_layerBegins[0];
+  bool normalize = m_normalization.isActive();
   for (int i_n = 0; i_n < m_nInputs; i_n++) {
-    inputLayer[i_n]->setResponseWithSum(vars[i_n]);
+    double var = normalize ? m_normalization.transformValue(i_n, vars[i_n]) :
+      vars[i_n];
+    m_neurons[inputBegin + i_n]->setResponseWithSum(var);
   }
   
-  // Then get the responses of the output layer. Again, this algorithm is
-  // recursive, so you only need to call it on the output layers.
-  std::vector<Neuron*> outputLayer = getOutputLayer();
-  for (std::vector<Neuron*>::iterator neuroIter = outputLayer.begin();
-       neuroIter != outputLayer.end(); neuroIter++) {
-    result.push_back((*neuroIter)->getResponse());
+  // Then evaluate the Neurons in topological order. The upstream responses are
+  // always memoized already, so getResponse() does not recurse.
+  for (std::vector<Neuron*>::iterator neuroIter = m_schedule.begin();
+       neuroIter != m_schedule.end(); neuroIter++) {
+    (*neuroIter)->getResponse();
   }
   
-  // Check that output vector is correct size before returning:
-  if ((int)result.size() != m_nOutputs) {
-    std::cout << "NeuralNetwork: ERROR! Wrong number of outputs! Expect " 
-	      << m_nOutputs << " and find " << result.size() << std::endl;
-    exit(0);
+  // Then collect the responses of the output layer.
+  int outputBegin = m_layerBegins[m_nHiddenLayers+1];
+  for (int i_n = 0; i_n < m_nOutputs; i_n++) {
+    outputs[i_n] = m_neurons[outputBegin + i_n]->getResponse();
   }
-  return result;
 }
 
 /**
    -----------------------------------------------------------------------------
    Randomize the values of the weights for all connections (Axons) in the 
    network. Useful when starting the training. Note: this relies on rand() from
-   <cstdlib>, which can't be reproduced via seeding. Might consider replacing
-   with a seeded random number generator in the future.
+   <cstdlib>, which can't be reproduced via seeding. Use the seeded version for
+   reproducible networks, or networks built concurrently.
 */
 void NeuralNetwork::randomizeNetworkWeights() {
   // Loop over the axons:
@@ -217,6 +539,81 @@ void NeuralNetwork::randomizeNetworkWeights() {
   }
 }
 
+/**
+   -----------------------------------------------------------------------------
+   Randomize the values of the weights for all connections (Axons) in the
+   network, in the same way as above but from a private generator, so the
+   result only depends on the seed.
+   @param seed - The seed of the random number generator.
+*/
+void NeuralNetwork::randomizeNetworkWeights(unsigned int seed) {
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<int> distribution(0, 99);
+  for (std::vector<Axon*>::iterator axonIter = m_axons.begin();
+       axonIter != m_axons.end(); axonIter++) {
+    int randInt = distribution(generator);
+    (*axonIter)->setWeight(((double)(randInt - 50.0))/100.0);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the hot-path statistics of the network to zero.
+*/
+void NeuralNetwork::resetInstrumentation() {
+  m_instrumentation.reset();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Store a (finalized) transform of the raw input variables with the network.
+   It is applied to the variables passed to getNetworkResponse(), so callers
+   and CompiledNetwork copies can use the raw data directly.
+   @param normalization - The transform, with one entry per input variable.
+*/
+void NeuralNetwork::setInputNormalization(const InputNormalization
+					  &normalization) {
+  if (normalization.getType() != kNoNormalization &&
+      (!normalization.isActive() ||
+       normalization.getNVariables() != m_nInputs)) {
+    std::cout << "NeuralNetwork: ERROR! Normalization does not fit the network."
+	      << std::endl;
+    exit(0);
+  }
+  m_normalization = normalization;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the number of events to accumulate before each weight update in
+   updateNetworkViaBP(). Any partial mini-batch is applied first.
+   @param miniBatchSize - The number of events per weight update.
+*/
+void NeuralNetwork::setMiniBatchSize(int miniBatchSize) {
+  if (miniBatchSize < 1) {
+    std::cout << "NeuralNetwork: ERROR! Mini-batch size must be positive."
+	      << std::endl;
+    exit(0);
+  }
+  applyNetworkGradient();
+  m_miniBatchSize = miniBatchSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Update the weights with an Optimizer instead of the per-Axon SGD rule. The
+   optimizer state is kept in arrays parallel to m_axons, so call this once
+   the network is complete. Its learning rate starts at 0.01; set it with
+   setNetworkLearningRate() or getOptimizer().
+   @param type - The update rule.
+*/
+void NeuralNetwork::setOptimizer(OptimizerType type) {
+  if (m_optimizer) delete m_optimizer;
+  m_optimizer = new Optimizer(type, (int)m_axons.size());
+  m_optimizerWeights.assign(m_axons.size(), 0.0);
+  m_optimizerGradients.assign(m_axons.size(), 0.0);
+}
+
 /**
    -----------------------------------------------------------------------------
    Set how quickly the network should pursue the gradient descent direction. 
@@ -225,6 +622,7 @@ void NeuralNetwork::randomizeNetworkWeights() {
    @param rate - The rate in the formula above for gradient descent.
 */
 void NeuralNetwork::setNetworkLearningRate(double rate) {
+  if (m_optimizer) m_optimizer->setLearningRate(rate);
   for (std::vector<Axon*>::iterator axonIter = m_axons.begin();
        axonIter != m_axons.end(); axonIter++) {
     (*axonIter)->setLearningRate(rate);
@@ -244,42 +642,33 @@ void NeuralNetwork::setNetworkTargets(std::vector<double> targets) {
     exit(0);
   }
   
-  // Then set the target value for each output layer node:
-  std::vector<Neuron*> outputLayer = getOutputLayer();
+  setNetworkTargets(&targets[0]);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the targets for the output layer, without any heap allocation.
+   @param targets - The m_nOutputs target values.
+*/
+void NeuralNetwork::setNetworkTargets(const double *targets) {
+  int outputBegin = m_layerBegins[m_nHiddenLayers+1];
   for (int i_n = 0; i_n < m_nOutputs; i_n++) {
-    outputLayer[i_n]->setTarget(targets[i_n]);
+    m_neurons[outputBegin + i_n]->setTarget(targets[i_n]);
   }
 }
 
 /**
    -----------------------------------------------------------------------------
    Use back-propagation to update the weights in the network. Assumes training
-   has just taken place and network targets have also been set. 
+   has just taken place and network targets have also been set. The gradient of
+   the event is accumulated, and the weights are updated once every 
+   getMiniBatchSize() events. Call applyNetworkGradient() to flush a partial 
+   mini-batch at the end of the training sample.
 */
 void NeuralNetwork::updateNetworkViaBP() {
-  // First clear deltas for input layer:
-  std::vector<Neuron*> inputLayer = getInputLayer();
-  for (std::vector<Neuron*>::iterator neuroIter = inputLayer.begin(); 
-       neuroIter != inputLayer.end(); neuroIter++) {
-    (*neuroIter)->clearDelta();
-  }
-  
-  // Then clear deltas for bias nodes (technically might not be necessary):
-  std::vector<Neuron*> biasNodes = getBiasNodes();
-  for (std::vector<Neuron*>::iterator neuroIter = biasNodes.begin(); 
-       neuroIter != biasNodes.end(); neuroIter++) {
-    (*neuroIter)->clearDelta();
-  }
-  
-  // Finally call back-propagation algorithm, which is recursive. It finds all
-  // of the input and bias nodes and calls getDelta() on them. This getDelta()
-  // method is recursive, and calls all downstream getDeltas(). These update
-  // the weights of the connections after they have been used for all necessary
-  // calculations. Probably only need to call on a single output layer node, but
-  // for completeness, we will call it on all of them.
-  std::vector<Neuron*> outputLayer = getOutputLayer();
-  for (std::vector<Neuron*>::iterator neuroIter = outputLayer.begin(); 
-       neuroIter != outputLayer.end(); neuroIter++) {
-    (*neuroIter)->backPropagation();
+  NN_SCOPE(&m_instrumentation);
+  accumulateNetworkGradient();
+  if (m_nAccumulated >= m_miniBatchSize) {
+    applyNetworkGradient();
   }
 }
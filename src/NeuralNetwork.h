@@ -12,9 +12,15 @@
 #ifndef NeuralNetwork_h
 #define NeuralNetwork_h
 
+#include "Arena.h"
 #include "Axon.h"
+#include "InputNormalization.h"
+#include "Instrumentation.h"
 #include "Neuron.h"
+#include "Optimizer.h"
 #include <cstdlib>
+#include <deque>
+#include <map>
 #include <stdlib.h>
 #include <stdio.h>
 #include <vector>
@@ -26,36 +32,86 @@ class NeuralNetwork
  public:
   
   NeuralNetwork(int nInputs, int nOutputs, int nHiddenLayers, 
-		int nNodesPerLayer);
+		int nNodesPerLayer, bool useArena = false);
   ~NeuralNetwork();
   
   // Accessors:
   std::vector<Neuron*> getBiasNodes();
+  const InputNormalization& getInputNormalization();
+  const Instrumentation& getInstrumentation();
   std::vector<Neuron*> getInputLayer();
   std::vector<Neuron*> getOutputLayer();
   std::vector<Neuron*> getLayer(int layerIndex);
+  size_t getMemoryFootprint();
+  int getMiniBatchSize();
+  int getNHiddenLayers();
+  int getNInputs();
+  int getNLayers();
+  int getNOutputs();
+  Optimizer* getOptimizer();
   
   // Mutators:
+  void accumulateNetworkGradient();
   void addLayer(int layerIndex, int nodesPerLayer, std::string function);
+  void applyNetworkGradient();
+  void clearNetworkDelta();
   void clearNetworkResponse();
   void clearNetworkResponseSum();
   std::vector<double> getNetworkResponse(std::vector<double> vars);
+  void getNetworkResponse(const double *vars, double *outputs);
   void randomizeNetworkWeights();
+  void randomizeNetworkWeights(unsigned int seed);
+  void resetInstrumentation();
+  void setInputNormalization(const InputNormalization &normalization);
+  void setMiniBatchSize(int miniBatchSize);
   void setNetworkLearningRate(double rate);
   void setNetworkTargets(std::vector<double> targets);
+  void setNetworkTargets(const double *targets);
+  void setOptimizer(OptimizerType type);
   void updateNetworkViaBP();
 
  private:
   
+  // Private functions:
+  void buildSchedule();
+  Axon* createAxon(double weight, Neuron *originNeuron, Neuron *terminalNeuron);
+  Neuron* createNeuron(int layerIndex, std::string function);
+  
   int m_nInputs;
   int m_nOutputs;
   int m_nHiddenLayers;
   int m_nNodesPerLayer;
   
+  // Transform of the raw input variables onto [-1,+1]:
+  InputNormalization m_normalization;
+  
+  // Mini-batch gradient accumulation:
+  int m_miniBatchSize;
+  int m_nAccumulated;
+  
   // Keep pointers to all neurons and connections:
   std::vector<Axon*> m_axons;
   std::vector<Neuron*> m_neurons;
   
+  // Layer L occupies m_neurons[m_layerBegins[L]] to m_neurons[m_layerEnds[L]-1]:
+  std::vector<int> m_layerBegins;
+  std::vector<int> m_layerEnds;
+  
+  // Optional owner of all neurons and connections (null if not used):
+  Arena *m_arena;
+  
+  // Optional update rule (null for per-Axon SGD), with gather buffers
+  // parallel to m_axons:
+  Optimizer *m_optimizer;
+  std::vector<double> m_optimizerWeights;
+  std::vector<double> m_optimizerGradients;
+  
+  // Topological execution order of m_neurons (upstream before downstream):
+  std::vector<Neuron*> m_schedule;
+  
+  // Hot-path statistics (only collected with NN_INSTRUMENTATION):
+  Instrumentation m_instrumentation;
+  
 };
 
 #endif
@@ -0,0 +1,442 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: ParallelTrainer.cxx                                                 //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class trains a NeuralNetwork with data-parallel mini-batch gradient  //
+//  descent. Each mini-batch is split across worker threads. Every thread     //
+//  keeps its own NetworkState (activation/delta scratch and gradient) and    //
+//  back-propagates its share of the events against a shared CompiledNetwork. //
+//  The per-thread gradients are then reduced, with each thread summing one   //
+//  slice of the parameters, and the weights are updated once per batch.     //
+//  The update rule is an Optimizer (plain SGD by default): each thread       //
+//  updates the weights and optimizer state of its slice in one fused pass.   //
+//                                                                            //
+//  In the optional asynchronous (Hogwild-style) mode there are no barriers.  //
+//  Each thread streams its own shard of the events against a thread-local    //
+//  copy of the weights and pushes sparse, unsynchronized updates into the    //
+//  shared weights using relaxed atomic loads and stores. Concurrent updates  //
+//  of the same weight may occasionally be lost, which SGD tolerates.         //
+//                                                                            //
+//  In mixed precision (setPrecision(kSinglePrecision)) the events are        //
+//  propagated forwards and backwards in float against a float replica of    //
+//  the weights, while the master weights, the gradients and their reduction //
+//  stay in double. The replica is refreshed after every update.             //
+//                                                                            //
+//  The training happens on the compiled copy of the network. Call           //
+//  updateNetwork() to copy the trained weights back into the Axons.          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ParallelTrainer.h"
+
+/**
+   -----------------------------------------------------------------------------
+   Relaxed atomic access to a shared weight. Unlike a plain read or write this
+   is well defined while other threads update the same weight, but it imposes
+   no ordering and compiles to an ordinary load or store on x86.
+*/
+static inline double loadRelaxed(const double *weight) {
+  double value;
+  __atomic_load(weight, &value, __ATOMIC_RELAXED);
+  return value;
+}
+
+static inline void storeRelaxed(double *weight, double value) {
+  __atomic_store(weight, &value, __ATOMIC_RELAXED);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   ParallelTrainer constructor.
+   @param network - The NeuralNetwork to train.
+   @param nThreads - The number of worker threads per mini-batch.
+*/
+ParallelTrainer::ParallelTrainer(NeuralNetwork *network, int nThreads) {
+  m_network = network;
+  m_compiledNetwork = new CompiledNetwork(network);
+  m_miniBatchSize = 100;
+  m_optimizer = new Optimizer(kSGD, m_compiledNetwork->getNParameters());
+  m_optimizer->setLearningRate(0.2);
+  m_asynchronous = false;
+  m_precision = kDoublePrecision;
+  m_nWaiting = 0;
+  m_barrierGeneration = 0;
+  m_states.clear();
+  setNThreads(nThreads);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   ParallelTrainer destructor.
+*/
+ParallelTrainer::~ParallelTrainer() {
+  for (int i_t = 0; i_t < (int)m_states.size(); i_t++) delete m_states[i_t];
+  delete m_optimizer;
+  delete m_compiledNetwork;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The compiled copy of the network that is being trained.
+*/
+CompiledNetwork* ParallelTrainer::getCompiledNetwork() {
+  return m_compiledNetwork;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The gradient descent learning rate.
+*/
+double ParallelTrainer::getLearningRate() {
+  return m_optimizer->getLearningRate();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of events per weight update.
+*/
+int ParallelTrainer::getMiniBatchSize() {
+  return m_miniBatchSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of worker threads.
+*/
+int ParallelTrainer::getNThreads() {
+  return m_nThreads;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The optimizer that updates the weights, for setting its
+   hyperparameters.
+*/
+Optimizer* ParallelTrainer::getOptimizer() {
+  return m_optimizer;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The precision of the forward and backward passes.
+*/
+Precision ParallelTrainer::getPrecision() {
+  return m_precision;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - True iff training uses the asynchronous (Hogwild-style) mode.
+*/
+bool ParallelTrainer::isAsynchronous() {
+  return m_asynchronous;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Choose between synchronous mini-batches (default) and the asynchronous
+   Hogwild-style mode, in which each thread pushes its own updates to the
+   shared weights every getMiniBatchSize() of its events without waiting for
+   the other threads.
+   @param asynchronous - True to use the asynchronous mode.
+*/
+void ParallelTrainer::setAsynchronous(bool asynchronous) {
+  m_asynchronous = asynchronous;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set how quickly the weights pursue the gradient descent direction.
+   @param rate - The learning rate.
+*/
+void ParallelTrainer::setLearningRate(double rate) {
+  m_optimizer->setLearningRate(rate);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the number of events per weight update. Each mini-batch is shared among
+   all threads.
+   @param miniBatchSize - The number of events per weight update.
+*/
+void ParallelTrainer::setMiniBatchSize(int miniBatchSize) {
+  if (miniBatchSize < 1) {
+    std::cout << "ParallelTrainer: ERROR! Mini-batch size must be positive."
+	      << std::endl;
+    exit(0);
+  }
+  m_miniBatchSize = miniBatchSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the number of worker threads, creating one NetworkState per thread.
+   @param nThreads - The number of worker threads.
+*/
+void ParallelTrainer::setNThreads(int nThreads) {
+  if (nThreads < 1) {
+    std::cout << "ParallelTrainer: ERROR! Need at least one thread."
+	      << std::endl;
+    exit(0);
+  }
+  for (int i_t = 0; i_t < (int)m_states.size(); i_t++) delete m_states[i_t];
+  m_states.clear();
+  m_nThreads = nThreads;
+  m_losses.assign(m_nThreads, 0.0);
+  for (int i_t = 0; i_t < m_nThreads; i_t++) {
+    m_states.push_back(new NetworkState(m_compiledNetwork));
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Replace the optimizer by a new one with the given update rule and the same
+   learning rate. Its state starts at zero. The asynchronous mode only supports
+   plain SGD.
+   @param type - The update rule.
+*/
+void ParallelTrainer::setOptimizer(OptimizerType type) {
+  Optimizer *optimizer = new Optimizer(type,
+				       m_compiledNetwork->getNParameters());
+  optimizer->setLearningRate(m_optimizer->getLearningRate());
+  delete m_optimizer;
+  m_optimizer = optimizer;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Choose the precision of the forward and backward passes. kSinglePrecision
+   trains in mixed precision: float arithmetic on a float replica of the
+   weights, with double master weights and double gradient sums, so that
+   small updates are not lost to rounding.
+   @param precision - The precision to use.
+*/
+void ParallelTrainer::setPrecision(Precision precision) {
+  m_precision = precision;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Train the network on a set of events, updating the weights once per
+   mini-batch. The calling thread acts as worker 0. In asynchronous mode each
+   thread trains on a contiguous shard of the events instead.
+   @param inputs - Row-major [nEvents x nInputs] matrix of input variables.
+   @param targets - Row-major [nEvents x nOutputs] matrix of target values.
+   @param nEvents - The number of events.
+   @returns - The mean loss per event, measured before each weight update.
+*/
+double ParallelTrainer::train(const double *inputs, const double *targets,
+			      int nEvents) {
+  EventBlock block(inputs, targets, nEvents, m_compiledNetwork->getNInputs(),
+		   m_compiledNetwork->getNOutputs());
+  return train(block);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Train the network on a block of events, such as a block of a memory-mapped
+   EventFile, reading the variables, targets and (optional) event weights in
+   place. The gradient of each event is scaled by its weight.
+   @param block - The events.
+   @returns - The mean (weighted) loss per event.
+*/
+double ParallelTrainer::train(const EventBlock &block) {
+  int nEvents = block.getNEvents();
+  if (nEvents <= 0) return 0.0;
+  if (block.getNVariables() != m_compiledNetwork->getNInputs() ||
+      block.getNTargets() != m_compiledNetwork->getNOutputs()) {
+    std::cout << "ParallelTrainer: ERROR! Block does not match the network."
+	      << std::endl;
+    exit(0);
+  }
+  if (m_asynchronous && m_optimizer->getType() != kSGD) {
+    std::cout << "ParallelTrainer: ERROR! Asynchronous mode only supports SGD."
+	      << std::endl;
+    exit(0);
+  }
+  m_nWaiting = 0;
+  if (m_precision == kSinglePrecision) {
+    const double *parameters = m_compiledNetwork->getParameterData();
+    m_floatParameters.assign(parameters, parameters
+			     + m_compiledNetwork->getNParameters());
+  }
+  std::vector<std::thread> workers;
+  void (ParallelTrainer::*worker)(int, const EventBlock*)
+    = m_asynchronous ? &ParallelTrainer::trainAsynchronousWorker :
+    &ParallelTrainer::trainWorker;
+  for (int i_t = 1; i_t < m_nThreads; i_t++) {
+    workers.push_back(std::thread(worker, this, i_t, &block));
+  }
+  (this->*worker)(0, &block);
+  for (int i_t = 0; i_t < (int)workers.size(); i_t++) workers[i_t].join();
+
+  double loss = 0.0;
+  for (int i_t = 0; i_t < m_nThreads; i_t++) loss += m_losses[i_t];
+  return (loss / ((double)nEvents));
+}
+
+/**
+   -----------------------------------------------------------------------------
+   The loop run by each worker thread in asynchronous mode. The thread streams
+   through its own shard of the events, evaluating them against a local copy
+   of the weights. Every getMiniBatchSize() events it pushes the non-zero
+   entries of its gradient into the shared weights and refreshes its copy.
+   There is no barrier: other threads may read or update the same weights at
+   the same time.
+   @param threadIndex - The index of this worker.
+   @param block - The events.
+*/
+void ParallelTrainer::trainAsynchronousWorker(int threadIndex,
+					      const EventBlock *block) {
+  NetworkState *state = m_states[threadIndex];
+  int nEvents = block->getNEvents();
+  std::vector<double> inputs(m_compiledNetwork->getNInputs());
+  std::vector<double> targets(m_compiledNetwork->getNOutputs());
+  int nParameters = m_compiledNetwork->getNParameters();
+  double *parameters = m_compiledNetwork->getParameterData();
+  double *gradient = state->getGradientData();
+  int firstEvent = (int)(((long)nEvents * threadIndex) / m_nThreads);
+  int lastEvent = (int)(((long)nEvents * (threadIndex+1)) / m_nThreads);
+
+  bool isMixed = (m_precision == kSinglePrecision);
+  std::vector<double> localParameters(nParameters);
+  std::vector<float> localFloatParameters(isMixed ? nParameters : 0);
+  for (int i_p = 0; i_p < nParameters; i_p++) {
+    localParameters[i_p] = loadRelaxed(&parameters[i_p]);
+    if (isMixed) localFloatParameters[i_p] = localParameters[i_p];
+  }
+  
+  double loss = 0.0;
+  for (int i_b = firstEvent; i_b < lastEvent; i_b += m_miniBatchSize) {
+    int nBatch = (lastEvent - i_b < m_miniBatchSize) ?
+      (lastEvent - i_b) : m_miniBatchSize;
+    state->clearGradient();
+    for (int i_e = i_b; i_e < i_b + nBatch; i_e++) {
+      block->getEvent(i_e, &inputs[0]);
+      block->getTargets(i_e, &targets[0]);
+      if (isMixed) {
+	m_compiledNetwork->accumulateGradient(&inputs[0], &targets[0],
+					      block->getWeight(i_e), state,
+					      &localFloatParameters[0]);
+      }
+      else {
+	m_compiledNetwork->accumulateGradient(&inputs[0], &targets[0],
+					      block->getWeight(i_e), state,
+					      &localParameters[0]);
+      }
+    }
+    loss += state->getLoss();
+    
+    // Push the sparse update, then pick up the other threads' updates:
+    double scale = -1.0 * m_optimizer->getLearningRate() / ((double)nBatch);
+    for (int i_p = 0; i_p < nParameters; i_p++) {
+      if (gradient[i_p] != 0.0) {
+	storeRelaxed(&parameters[i_p], loadRelaxed(&parameters[i_p])
+		     + (scale * gradient[i_p]));
+      }
+      localParameters[i_p] = loadRelaxed(&parameters[i_p]);
+      if (isMixed) localFloatParameters[i_p] = localParameters[i_p];
+    }
+  }
+  m_losses[threadIndex] = loss;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   The loop run by each worker thread. For every mini-batch the thread first
+   back-propagates its contiguous share of the events into its own gradient
+   buffer. After a barrier it sums one slice of the parameters over all of the
+   gradient buffers and updates those weights. A second barrier ensures that
+   the update is complete before the next mini-batch reads the weights.
+   @param threadIndex - The index of this worker.
+   @param block - The events.
+*/
+void ParallelTrainer::trainWorker(int threadIndex, const EventBlock *block) {
+  NetworkState *state = m_states[threadIndex];
+  int nEvents = block->getNEvents();
+  std::vector<double> inputs(m_compiledNetwork->getNInputs());
+  std::vector<double> targets(m_compiledNetwork->getNOutputs());
+  int nParameters = m_compiledNetwork->getNParameters();
+  double *parameters = m_compiledNetwork->getParameterData();
+  int firstParameter = (nParameters * threadIndex) / m_nThreads;
+  int lastParameter = (nParameters * (threadIndex+1)) / m_nThreads;
+  bool isMixed = (m_precision == kSinglePrecision);
+  std::vector<double*> gradients;
+  for (int i_t = 0; i_t < m_nThreads; i_t++) {
+    gradients.push_back(m_states[i_t]->getGradientData());
+  }
+
+  double loss = 0.0;
+  for (int i_b = 0; i_b < nEvents; i_b += m_miniBatchSize) {
+    int nBatch = (nEvents - i_b < m_miniBatchSize) ?
+      (nEvents - i_b) : m_miniBatchSize;
+    int firstEvent = i_b + (nBatch * threadIndex) / m_nThreads;
+    int lastEvent = i_b + (nBatch * (threadIndex+1)) / m_nThreads;
+
+    state->clearGradient();
+    for (int i_e = firstEvent; i_e < lastEvent; i_e++) {
+      block->getEvent(i_e, &inputs[0]);
+      block->getTargets(i_e, &targets[0]);
+      if (isMixed) {
+	m_compiledNetwork->accumulateGradient(&inputs[0], &targets[0],
+					      block->getWeight(i_e), state,
+					      &m_floatParameters[0]);
+      }
+      else {
+	m_compiledNetwork->accumulateGradient(&inputs[0], &targets[0],
+					      block->getWeight(i_e), state,
+					      parameters);
+      }
+    }
+    loss += state->getLoss();
+    if (threadIndex == 0) m_optimizer->beginStep();
+    waitAtBarrier();
+
+    // Reduce this thread's slice of the gradient into the first gradient
+    // buffer, then update the weights and the optimizer state in one pass:
+    for (int i_t = 1; i_t < m_nThreads; i_t++) {
+      for (int i_p = firstParameter; i_p < lastParameter; i_p++) {
+	gradients[0][i_p] += gradients[i_t][i_p];
+      }
+    }
+    m_optimizer->update(parameters, gradients[0], nBatch, firstParameter,
+			lastParameter);
+    if (isMixed) {
+      for (int i_p = firstParameter; i_p < lastParameter; i_p++) {
+	m_floatParameters[i_p] = parameters[i_p];
+      }
+    }
+    waitAtBarrier();
+  }
+  m_losses[threadIndex] = loss;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Copy the trained weights back into the Axons of the NeuralNetwork.
+*/
+void ParallelTrainer::updateNetwork() {
+  m_compiledNetwork->exportWeights(m_network);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Block until all m_nThreads workers have reached the barrier.
+*/
+void ParallelTrainer::waitAtBarrier() {
+  std::unique_lock<std::mutex> lock(m_barrierMutex);
+  int generation = m_barrierGeneration;
+  m_nWaiting++;
+  if (m_nWaiting == m_nThreads) {
+    m_nWaiting = 0;
+    m_barrierGeneration++;
+    m_barrierCondition.notify_all();
+  }
+  else {
+    while (generation == m_barrierGeneration) m_barrierCondition.wait(lock);
+  }
+}
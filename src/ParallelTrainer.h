@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: ParallelTrainer.h                                                   //
+//  Class: ParallelTrainer.cxx                                                //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ParallelTrainer_h
+#define ParallelTrainer_h
+
+#include "CompiledNetwork.h"
+#include "EventBlock.h"
+#include "NeuralNetwork.h"
+#include "NetworkState.h"
+#include "Optimizer.h"
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+class ParallelTrainer
+{
+
+ public:
+
+  ParallelTrainer(NeuralNetwork *network, int nThreads);
+  ~ParallelTrainer();
+
+  // Accessors:
+  CompiledNetwork* getCompiledNetwork();
+  double getLearningRate();
+  int getMiniBatchSize();
+  int getNThreads();
+  Optimizer* getOptimizer();
+  Precision getPrecision();
+  bool isAsynchronous();
+
+  // Mutators:
+  void setAsynchronous(bool asynchronous);
+  void setLearningRate(double rate);
+  void setMiniBatchSize(int miniBatchSize);
+  void setNThreads(int nThreads);
+  void setOptimizer(OptimizerType type);
+  void setPrecision(Precision precision);
+  double train(const double *inputs, const double *targets, int nEvents);
+  double train(const EventBlock &block);
+  void updateNetwork();
+
+ private:
+
+  // Private functions:
+  void trainAsynchronousWorker(int threadIndex, const EventBlock *block);
+  void trainWorker(int threadIndex, const EventBlock *block);
+  void waitAtBarrier();
+
+  // Member objects:
+  NeuralNetwork *m_network;
+  CompiledNetwork *m_compiledNetwork;
+  std::vector<NetworkState*> m_states;
+  std::vector<double> m_losses;
+  int m_nThreads;
+  int m_miniBatchSize;
+  Optimizer *m_optimizer;
+  bool m_asynchronous;
+
+  // Mixed precision: float replica of the (double) weights for the
+  // forward and backward passes:
+  Precision m_precision;
+  std::vector<float> m_floatParameters;
+
+  // Barrier shared by the workers of one train() call:
+  std::mutex m_barrierMutex;
+  std::condition_variable m_barrierCondition;
+  int m_nWaiting;
+  int m_barrierGeneration;
+
+};
+
+#endif
@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: PrecisionBenchmark.cxx                                              //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Compares single- and double-precision execution on a reference sample.    //
+//  The first half of the events of an EventFile is used for training and    //
+//  the second half as the reference sample.                                  //
+//                                                                            //
+//  - Training: identical copies of a network are trained in double and in    //
+//    mixed precision, printing the time and losses after every epoch.        //
+//  - Inference: the double-trained network scores the reference sample in   //
+//    double and in float precision. The maximum and mean deviation of the    //
+//    float outputs from the double outputs are printed with the throughput.  //
+//                                                                            //
+//  With a ModelFile as the last argument, the training is skipped and the    //
+//  stored network is compared instead.                                       //
+//                                                                            //
+//  Usage: PrecisionBenchmark <eventFile> <nThreads> <nEpochs> [modelFile]    //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CompiledNetwork.h"
+#include "EventFile.h"
+#include "ModelFile.h"
+#include "NeuralNetwork.h"
+#include "ParallelTrainer.h"
+#include <chrono>
+#include <iostream>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The mean weighted loss 0.5 * (response - target)^2 per event of
+   a sample, normalized like the training loss of ParallelTrainer.
+*/
+double getLoss(const EventBlock &block, std::vector<double> &outputs) {
+  int nTargets = block.getNTargets();
+  std::vector<double> targets(nTargets);
+  double loss = 0.0;
+  for (int i_e = 0; i_e < block.getNEvents(); i_e++) {
+    block.getTargets(i_e, &targets[0]);
+    for (int i_t = 0; i_t < nTargets; i_t++) {
+      double error = outputs[i_e * nTargets + i_t] - targets[i_t];
+      loss += block.getWeight(i_e) * 0.5 * error * error;
+    }
+  }
+  return (loss / ((double)block.getNEvents()));
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score a sample in the given precision.
+   @param network - The network.
+   @param precision - The precision to use.
+   @param block - The events.
+   @param outputs - The responses (output).
+   @returns - The number of events per second.
+*/
+double score(CompiledNetwork *network, Precision precision,
+	     const EventBlock &block, std::vector<double> &outputs) {
+  network->setPrecision(precision);
+  outputs.assign(block.getNEvents() * network->getNOutputs(), 0.0);
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  network->getBatchResponse(block, &outputs[0]);
+  double seconds = std::chrono::duration<double>
+    (std::chrono::steady_clock::now() - start).count();
+  return (block.getNEvents() / seconds);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Print the deviation of float from double inference on the reference sample:
+   inference maxDeviation meanDeviation doubleEventsPerSecond
+   floatEventsPerSecond
+*/
+void compareInference(CompiledNetwork *network, const EventBlock &reference) {
+  std::vector<double> doubleOutputs, floatOutputs;
+  // Warm up the caches and the float copy before timing:
+  score(network, kDoublePrecision, reference, doubleOutputs);
+  double doubleRate = score(network, kDoublePrecision, reference,
+			    doubleOutputs);
+  score(network, kSinglePrecision, reference, floatOutputs);
+  double floatRate = score(network, kSinglePrecision, reference, floatOutputs);
+  network->setPrecision(kDoublePrecision);
+
+  double maxDeviation = 0.0;
+  double sumDeviation = 0.0;
+  for (int i_o = 0; i_o < (int)doubleOutputs.size(); i_o++) {
+    double deviation = fabs(floatOutputs[i_o] - doubleOutputs[i_o]);
+    if (deviation > maxDeviation) maxDeviation = deviation;
+    sumDeviation += deviation;
+  }
+  printf("# inference maxDeviation meanDeviation doubleEventsPerSecond "
+	 "floatEventsPerSecond\n");
+  printf("inference %.6g %.6g %.6g %.6g\n", maxDeviation,
+	 sumDeviation / ((double)doubleOutputs.size()), doubleRate, floatRate);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Train one copy of the network and print one line per epoch:
+   precision epoch seconds trainingLoss referenceLoss
+   @returns - The trained network.
+*/
+NeuralNetwork* train(Precision precision, int nThreads, int nEpochs,
+		     const EventBlock &training, const EventBlock &reference) {
+  srand(1);
+  NeuralNetwork *network = new NeuralNetwork(training.getNVariables(),
+					     training.getNTargets(), 2, 32);
+  network->randomizeNetworkWeights();
+  ParallelTrainer *trainer = new ParallelTrainer(network, nThreads);
+  trainer->setPrecision(precision);
+  trainer->setMiniBatchSize(16 * nThreads);
+  trainer->setLearningRate(0.05);
+
+  const char *name = (precision == kSinglePrecision) ? "mixed" : "double";
+  std::vector<double> outputs;
+  double seconds = 0.0;
+  for (int i_e = 1; i_e <= nEpochs; i_e++) {
+    std::chrono::steady_clock::time_point start
+      = std::chrono::steady_clock::now();
+    double trainingLoss = trainer->train(training);
+    seconds += std::chrono::duration<double>
+      (std::chrono::steady_clock::now() - start).count();
+    score(trainer->getCompiledNetwork(), kDoublePrecision, reference, outputs);
+    printf("%s %d %.4f %.6g %.6g\n", name, i_e, seconds, trainingLoss,
+	   getLoss(reference, outputs));
+  }
+  trainer->updateNetwork();
+  delete trainer;
+  return network;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Main method: compare the precisions on an event file.
+*/
+int main(int argc, char **argv) {
+  if (argc < 4) {
+    std::cout << "Usage: " << argv[0]
+	      << " <eventFile> <nThreads> <nEpochs> [modelFile]" << std::endl;
+    exit(0);
+  }
+  EventFile eventFile(argv[1]);
+  int nThreads = atoi(argv[2]);
+  int nEpochs = atoi(argv[3]);
+  int nTraining = eventFile.getNEvents() / 2;
+  EventBlock training, reference;
+  eventFile.getBlock(0, nTraining, training);
+  eventFile.getBlock(nTraining, eventFile.getNEvents() - nTraining, reference);
+
+  if (argc > 4) {
+    ModelFile modelFile(argv[4]);
+    compareInference(modelFile.getNetwork(), reference);
+    return 0;
+  }
+
+  printf("# precision epoch seconds trainingLoss referenceLoss\n");
+  NeuralNetwork *doubleNetwork = train(kDoublePrecision, nThreads, nEpochs,
+				       training, reference);
+  NeuralNetwork *mixedNetwork = train(kSinglePrecision, nThreads, nEpochs,
+				      training, reference);
+
+  CompiledNetwork doubleCompiled(doubleNetwork);
+  CompiledNetwork mixedCompiled(mixedNetwork);
+  compareInference(&doubleCompiled, reference);
+
+  // Deviation of the mixed-precision training from the double training:
+  std::vector<double> doubleOutputs, mixedOutputs;
+  score(&doubleCompiled, kDoublePrecision, reference, doubleOutputs);
+  score(&mixedCompiled, kDoublePrecision, reference, mixedOutputs);
+  double maxDeviation = 0.0;
+  for (int i_o = 0; i_o < (int)doubleOutputs.size(); i_o++) {
+    double deviation = fabs(mixedOutputs[i_o] - doubleOutputs[i_o]);
+    if (deviation > maxDeviation) maxDeviation = deviation;
+  }
+  printf("# training maxDeviation\n");
+  printf("training %.6g\n", maxDeviation);
+  delete doubleNetwork;
+  delete mixedNetwork;
+  return 0;
+}
@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: PruningBenchmark.cxx                                                //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Compares magnitude-pruned SparseNetworks with the dense network for a     //
+//  stored model. The first nTrain events of an EventFile fine-tune the      //
+//  pruned networks and the remaining events are the reference sample.        //
+//                                                                            //
+//  For target densities of 100% down to 10% of the connections, the         //
+//  threshold is the corresponding quantile of the weight magnitudes. Each    //
+//  line gives the density, the memory footprint, the throughput, and the    //
+//  ROC area and signal/background separation (events with a first target    //
+//  > 0 are signal), before and after nEpochs of fine-tuning.                 //
+//                                                                            //
+//  Usage: PruningBenchmark <eventFile> <modelFile> [nTrain] [nEpochs]        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CompiledNetwork.h"
+#include "EventFile.h"
+#include "ModelFile.h"
+#include "SeparationMetrics.h"
+#include "SparseNetwork.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The magnitudes of all weights (not biases) of a network, sorted.
+*/
+std::vector<double> getWeightMagnitudes(CompiledNetwork *network) {
+  std::vector<double> parameters = network->getParameters();
+  std::vector<double> magnitudes;
+  for (int i_l = 1; i_l < network->getNLayers(); i_l++) {
+    int nWeights = network->getLayerSize(i_l) * network->getLayerSize(i_l-1);
+    const double *weights = &parameters[network->getWeightOffset(i_l)];
+    for (int i_w = 0; i_w < nWeights; i_w++) {
+      magnitudes.push_back(fabs(weights[i_w]));
+    }
+  }
+  std::sort(magnitudes.begin(), magnitudes.end());
+  return magnitudes;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score a sample with a SparseNetwork.
+   @returns - The number of events per second.
+*/
+double score(SparseNetwork *network, const EventBlock &block,
+	     std::vector<double> &outputs) {
+  outputs.assign(block.getNEvents() * network->getNOutputs(), 0.0);
+  // Warm up the caches before timing:
+  network->getBatchResponse(block, &outputs[0]);
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  network->getBatchResponse(block, &outputs[0]);
+  double seconds = std::chrono::duration<double>
+    (std::chrono::steady_clock::now() - start).count();
+  return (block.getNEvents() / seconds);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Main method: prune a stored network to several densities.
+*/
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cout << "Usage: " << argv[0]
+	      << " <eventFile> <modelFile> [nTrain] [nEpochs]" << std::endl;
+    exit(0);
+  }
+  EventFile eventFile(argv[1]);
+  ModelFile modelFile(argv[2]);
+  int nTrain = (argc > 3) ? atoi(argv[3]) : 100000;
+  int nEpochs = (argc > 4) ? atoi(argv[4]) : 2;
+  if (nTrain < 1 || nTrain >= eventFile.getNEvents()) {
+    std::cout << "PruningBenchmark: ERROR! Bad training size." << std::endl;
+    exit(0);
+  }
+  EventBlock training, reference;
+  eventFile.getBlock(0, nTrain, training);
+  eventFile.getBlock(nTrain, eventFile.getNEvents() - nTrain, reference);
+  CompiledNetwork *network = modelFile.getNetwork();
+  int nOutputs = network->getNOutputs();
+
+  std::vector<double> outputs(reference.getNEvents() * nOutputs);
+  network->getBatchResponse(reference, &outputs[0]);
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  network->getBatchResponse(reference, &outputs[0]);
+  double denseRate = reference.getNEvents() /
+    std::chrono::duration<double>(std::chrono::steady_clock::now()
+				  - start).count();
+  printf("# dense bytes eventsPerSecond rocArea separation\n");
+  printf("dense %zu %.6g %.6f %.6f\n", network->getMemoryFootprint(),
+	 denseRate, SeparationMetrics::getROCArea(reference, outputs, nOutputs),
+	 SeparationMetrics::getSeparation(reference, outputs, nOutputs));
+
+  printf("# density threshold bytes eventsPerSecond rocArea separation "
+	 "tunedRocArea tunedSeparation\n");
+  std::vector<double> magnitudes = getWeightMagnitudes(network);
+  const double densities[] = {1.0, 0.75, 0.5, 0.25, 0.1};
+  for (int i_d = 0; i_d < 5; i_d++) {
+    int nPruned = (int)((1.0 - densities[i_d]) * magnitudes.size());
+    double threshold = (nPruned > 0) ? magnitudes[nPruned] : 0.0;
+    SparseNetwork sparse(network, threshold);
+    size_t nBytes = sparse.getMemoryFootprint();
+    double rate = score(&sparse, reference, outputs);
+    double rocArea
+      = SeparationMetrics::getROCArea(reference, outputs, nOutputs);
+    double separation
+      = SeparationMetrics::getSeparation(reference, outputs, nOutputs);
+    sparse.setLearningRate(0.02);
+    sparse.setMiniBatchSize(32);
+    for (int i_e = 0; i_e < nEpochs; i_e++) sparse.train(training);
+    sparse.getBatchResponse(reference, &outputs[0]);
+    printf("%.4f %.6g %zu %.6g %.6f %.6f %.6f %.6f\n", sparse.getDensity(),
+	   threshold, nBytes, rate, rocArea, separation,
+	   SeparationMetrics::getROCArea(reference, outputs, nOutputs),
+	   SeparationMetrics::getSeparation(reference, outputs, nOutputs));
+  }
+  return 0;
+}
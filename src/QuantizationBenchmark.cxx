@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: QuantizationBenchmark.cxx                                           //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Compares int8 inference with double and float inference for a stored     //
+//  network. The first nCalibration events of an EventFile calibrate the      //
+//  quantization and the remaining events are the reference sample.           //
+//                                                                            //
+//  - For each granularity, the maximum and mean deviation of the int8 scores //
+//    from the double scores are printed with the ROC area and the            //
+//    signal/background separation of both (events with a first target > 0    //
+//    are signal).                                                            //
+//  - The throughput is printed for double, float and each integer kernel.   //
+//                                                                            //
+//  Usage: QuantizationBenchmark <eventFile> <modelFile> [nCalibration]       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CompiledNetwork.h"
+#include "EventFile.h"
+#include "ModelFile.h"
+#include "QuantizedNetwork.h"
+#include "SeparationMetrics.h"
+#include <chrono>
+#include <iostream>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/**
+   -----------------------------------------------------------------------------
+   Score a sample with a CompiledNetwork in the given precision.
+   @returns - The number of events per second.
+*/
+double score(CompiledNetwork *network, Precision precision,
+	     const EventBlock &block, std::vector<double> &outputs) {
+  network->setPrecision(precision);
+  outputs.assign(block.getNEvents() * network->getNOutputs(), 0.0);
+  // Warm up the caches before timing:
+  network->getBatchResponse(block, &outputs[0]);
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  network->getBatchResponse(block, &outputs[0]);
+  double seconds = std::chrono::duration<double>
+    (std::chrono::steady_clock::now() - start).count();
+  return (block.getNEvents() / seconds);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score a sample with a QuantizedNetwork using the given kernel.
+   @returns - The number of events per second.
+*/
+double score(QuantizedNetwork *network, QuantizedKernel kernel,
+	     const EventBlock &block, std::vector<double> &outputs) {
+  network->setKernel(kernel);
+  outputs.assign(block.getNEvents() * network->getNOutputs(), 0.0);
+  network->getBatchResponse(block, &outputs[0]);
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  network->getBatchResponse(block, &outputs[0]);
+  double seconds = std::chrono::duration<double>
+    (std::chrono::steady_clock::now() - start).count();
+  return (block.getNEvents() / seconds);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Main method: compare int8 with double and float inference.
+*/
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cout << "Usage: " << argv[0]
+	      << " <eventFile> <modelFile> [nCalibration]" << std::endl;
+    exit(0);
+  }
+  EventFile eventFile(argv[1]);
+  ModelFile modelFile(argv[2]);
+  int nCalibration = (argc > 3) ? atoi(argv[3]) : 10000;
+  if (nCalibration < 1 || nCalibration >= eventFile.getNEvents()) {
+    std::cout << "QuantizationBenchmark: ERROR! Bad calibration size."
+	      << std::endl;
+    exit(0);
+  }
+  EventBlock calibration, reference;
+  eventFile.getBlock(0, nCalibration, calibration);
+  eventFile.getBlock(nCalibration, eventFile.getNEvents() - nCalibration,
+		     reference);
+  CompiledNetwork *network = modelFile.getNetwork();
+  int nOutputs = network->getNOutputs();
+
+  std::vector<double> doubleOutputs, floatOutputs;
+  double doubleRate = score(network, kDoublePrecision, reference,
+			    doubleOutputs);
+  double floatRate = score(network, kSinglePrecision, reference, floatOutputs);
+  network->setPrecision(kDoublePrecision);
+  printf("# precision eventsPerSecond rocArea separation\n");
+  printf("double %.6g %.6f %.6f\n", doubleRate,
+	 SeparationMetrics::getROCArea(reference, doubleOutputs, nOutputs),
+	 SeparationMetrics::getSeparation(reference, doubleOutputs, nOutputs));
+  printf("float %.6g %.6f %.6f\n", floatRate,
+	 SeparationMetrics::getROCArea(reference, floatOutputs, nOutputs),
+	 SeparationMetrics::getSeparation(reference, floatOutputs, nOutputs));
+
+  printf("# granularity kernel eventsPerSecond maxDeviation meanDeviation "
+	 "rocArea separation\n");
+  for (int i_g = 0; i_g < 2; i_g++) {
+    QuantizationGranularity granularity = (i_g == 0) ?
+      kPerLayerScales : kPerNeuronScales;
+    QuantizedNetwork quantized(network, calibration, granularity);
+    QuantizedKernel bestKernel = quantized.getKernel();
+    for (int i_k = kScalarKernel; i_k <= bestKernel; i_k++) {
+      std::vector<double> outputs;
+      double rate = score(&quantized, (QuantizedKernel)i_k, reference,
+			  outputs);
+      double maxDeviation = 0.0;
+      double sumDeviation = 0.0;
+      for (int i_o = 0; i_o < (int)outputs.size(); i_o++) {
+	double deviation = fabs(outputs[i_o] - doubleOutputs[i_o]);
+	if (deviation > maxDeviation) maxDeviation = deviation;
+	sumDeviation += deviation;
+      }
+      printf("%s %s %.6g %.6g %.6g %.6f %.6f\n",
+	     (i_g == 0) ? "layer" : "neuron",
+	     quantized.getKernelName().c_str(), rate, maxDeviation,
+	     sumDeviation / ((double)outputs.size()),
+	     SeparationMetrics::getROCArea(reference, outputs, nOutputs),
+	     SeparationMetrics::getSeparation(reference, outputs, nOutputs));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: QuantizationTest.cxx                                                //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Checks the int8 inference of a QuantizedNetwork against the double        //
+//  inference of the same network. A small network is trained on a fixed toy  //
+//  signal/background sample, the quantization is calibrated on the first     //
+//  events of a second sample and the remaining events are the reference.     //
+//                                                                            //
+//  For per-layer and per-neuron scales, the test fails if the maximum        //
+//  deviation of an int8 score from the double score, or the change of the    //
+//  ROC area or of the separation, exceeds its bound, or if any integer       //
+//  kernel that the CPU supports gives an output that is not bit-identical to //
+//  that of the scalar kernel. The program prints one line per granularity    //
+//  and kernel and exits with status 1 on any failure.                        //
+//                                                                            //
+//  Usage: make test                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CompiledNetwork.h"
+#include "NetworkTrainer.h"
+#include "NeuralNetwork.h"
+#include "QuantizedNetwork.h"
+#include "SeparationMetrics.h"
+#include <iostream>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// The largest accepted deviations from double inference:
+const double maxScoreDeviation = 0.04;
+const double maxROCDeviation = 0.001;
+const double maxSeparationDeviation = 0.005;
+
+/**
+   -----------------------------------------------------------------------------
+   Fill a toy sample: signal events (target +0.8) are centred at +0.05 and
+   background events (target -0.8) at -0.05 in every variable, with flat noise.
+   @param nEvents - The number of events to generate.
+   @param nInputs - The number of variables per event.
+   @param inputs - Row-major [nEvents x nInputs] variables (output).
+   @param targets - The nEvents target values (output).
+*/
+void generateSample(int nEvents, int nInputs, std::vector<double> &inputs,
+		    std::vector<double> &targets) {
+  inputs.resize(nEvents * nInputs);
+  targets.resize(nEvents);
+  for (int i_e = 0; i_e < nEvents; i_e++) {
+    bool isSignal = (rand() % 2 == 0);
+    for (int i_i = 0; i_i < nInputs; i_i++) {
+      double noise = ((double)(rand() % 1000) - 500.0) / 1000.0;
+      inputs[i_e * nInputs + i_i] = (isSignal ? 0.05 : -0.05) + noise;
+    }
+    targets[i_e] = isSignal ? 0.8 : -0.8;
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Main method: compare int8 with double inference for both granularities.
+*/
+int main() {
+  const int nInputs = 10;
+  const int nCalibration = 5000;
+  const int nReference = 20000;
+  srand(1);
+  std::vector<double> trainInputs, trainTargets, testInputs, testTargets;
+  generateSample(20000, nInputs, trainInputs, trainTargets);
+  generateSample(nCalibration + nReference, nInputs, testInputs, testTargets);
+  EventBlock training(&trainInputs[0], &trainTargets[0], 20000, nInputs, 1);
+  EventBlock calibration(&testInputs[0], &testTargets[0], nCalibration,
+			 nInputs, 1);
+  EventBlock reference(&testInputs[nCalibration * nInputs],
+		       &testTargets[nCalibration], nReference, nInputs, 1);
+
+  NeuralNetwork network(nInputs, 1, 2, 16);
+  network.randomizeNetworkWeights(1);
+  NetworkTrainer trainer(&network);
+  trainer.setVerbose(false);
+  trainer.train(training, 3);
+  CompiledNetwork compiled(&network);
+  std::vector<double> doubleOutputs(nReference);
+  compiled.getBatchResponse(reference, &doubleOutputs[0]);
+  double doubleROCArea
+    = SeparationMetrics::getROCArea(reference, doubleOutputs, 1);
+  double doubleSeparation
+    = SeparationMetrics::getSeparation(reference, doubleOutputs, 1);
+  printf("QuantizationTest: double rocArea %.6f separation %.6f\n",
+	 doubleROCArea, doubleSeparation);
+
+  const char *kernelNames[] = {"scalar", "avx2", "vnni"};
+  bool passed = true;
+  for (int i_g = 0; i_g < 2; i_g++) {
+    QuantizationGranularity granularity = (i_g == 0) ?
+      kPerLayerScales : kPerNeuronScales;
+    QuantizedNetwork quantized(&compiled, calibration, granularity);
+    QuantizedKernel bestKernel = quantized.getKernel();
+    std::vector<double> scalarOutputs;
+    for (int i_k = kScalarKernel; i_k <= kVNNIKernel; i_k++) {
+      if (i_k > bestKernel) {
+	printf("QuantizationTest: %s %s not supported by this CPU\n",
+	       (i_g == 0) ? "layer" : "neuron", kernelNames[i_k]);
+	continue;
+      }
+      quantized.setKernel((QuantizedKernel)i_k);
+      std::vector<double> outputs(nReference);
+      quantized.getBatchResponse(reference, &outputs[0]);
+      if (i_k == kScalarKernel) scalarOutputs = outputs;
+      double maxDeviation = 0.0;
+      int nDifferent = 0;
+      for (int i_e = 0; i_e < nReference; i_e++) {
+	double deviation = fabs(outputs[i_e] - doubleOutputs[i_e]);
+	if (deviation > maxDeviation) maxDeviation = deviation;
+	if (outputs[i_e] != scalarOutputs[i_e]) nDifferent++;
+      }
+      double rocDeviation = fabs(doubleROCArea - SeparationMetrics
+				 ::getROCArea(reference, outputs, 1));
+      double separationDeviation
+	= fabs(doubleSeparation - SeparationMetrics
+	       ::getSeparation(reference, outputs, 1));
+      printf("QuantizationTest: %s %s maxDeviation %.6g rocDeviation %.6g "
+	     "separationDeviation %.6g nDifferentFromScalar %d\n",
+	     (i_g == 0) ? "layer" : "neuron", kernelNames[i_k], maxDeviation,
+	     rocDeviation, separationDeviation, nDifferent);
+      if (maxDeviation > maxScoreDeviation || rocDeviation > maxROCDeviation ||
+	  separationDeviation > maxSeparationDeviation || nDifferent > 0) {
+	passed = false;
+      }
+    }
+  }
+  if (!passed) {
+    std::cout << "QuantizationTest: FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "QuantizationTest: passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,569 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: QuantizedNetwork.cxx                                                //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class is a post-training 8-bit quantization of a trained network,   //
+//  for high-volume scoring. It is built from a CompiledNetwork and a sample  //
+//  of calibration events:                                                    //
+//                                                                            //
+//  - The responses of every node (or of every layer, with kPerLayerScales)   //
+//    are quantized to unsigned 8 bits over the range seen in calibration.   //
+//  - The weights of every node are quantized to signed 8 bits with their own //
+//    scale, after folding in the quantization steps of their inputs. The     //
+//    minima of the inputs and the bias become one float offset per node.     //
+//  - Each layer is then an exact integer dot product over 8-bit values with  //
+//    32-bit sums: AVX-512 VNNI (vpdpbusd, 64 byte-products per instruction)  //
+//    or AVX2 (vpmaddwd), with a scalar fallback. All kernels give identical  //
+//    sums, hence identical responses.                                        //
+//  - The activation functions of the hidden layers come from lookup tables.  //
+//    The output layer is evaluated exactly, from the dequantized sums.       //
+//                                                                            //
+//  Events are processed in blocks of kBlockSize. The quantized responses of  //
+//  a layer are interleaved in groups of four inputs per event, which is the  //
+//  operand layout of vpdpbusd.                                               //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "QuantizedNetwork.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define QUANTIZED_X86
+#include <immintrin.h>
+#endif
+
+const int QuantizedNetwork::kBlockSize;
+const int QuantizedNetwork::kTableSize;
+
+/**
+   -----------------------------------------------------------------------------
+   Scalar dot products of one node with the quantized inputs of a block.
+   @param activations - The interleaved quantized inputs of the block.
+   @param weights - The 4 * nGroups quantized weights of the node.
+   @param nGroups - The number of groups of four inputs.
+   @param products - The NEvents integer sums (output).
+*/
+template <int NEvents>
+static void dotProductsScalar(const uint8_t *activations,
+			      const int8_t *weights, int nGroups,
+			      int32_t *products) {
+  for (int i_e = 0; i_e < NEvents; i_e++) products[i_e] = 0;
+  for (int i_g = 0; i_g < nGroups; i_g++) {
+    const uint8_t *group = &activations[i_g * NEvents * 4];
+    const int8_t *weight = &weights[i_g * 4];
+    for (int i_e = 0; i_e < NEvents; i_e++) {
+      products[i_e] += (group[i_e*4] * weight[0] + group[i_e*4+1] * weight[1]
+			+ group[i_e*4+2] * weight[2]
+			+ group[i_e*4+3] * weight[3]);
+    }
+  }
+}
+
+#ifdef QUANTIZED_X86
+
+/**
+   -----------------------------------------------------------------------------
+   AVX2 dot products: the 8-bit values are widened to 16 bits and multiplied
+   and summed pairwise into 32 bits with vpmaddwd, which cannot overflow.
+   Each register holds two partial sums for each of 4 events.
+*/
+template <int NEvents>
+__attribute__((target("avx2")))
+static void dotProductsAVX2(const uint8_t *activations,
+			    const int8_t *weights, int nGroups,
+			    int32_t *products) {
+  const int nChunks = NEvents / 8;
+  __m256i sumsLow[nChunks];
+  __m256i sumsHigh[nChunks];
+  for (int i_c = 0; i_c < nChunks; i_c++) {
+    sumsLow[i_c] = _mm256_setzero_si256();
+    sumsHigh[i_c] = _mm256_setzero_si256();
+  }
+  for (int i_g = 0; i_g < nGroups; i_g++) {
+    int16_t weight[4];
+    for (int i_w = 0; i_w < 4; i_w++) weight[i_w] = weights[i_g * 4 + i_w];
+    long long packedWeight;
+    memcpy(&packedWeight, weight, sizeof(packedWeight));
+    __m256i weightVector = _mm256_set1_epi64x(packedWeight);
+    const uint8_t *group = &activations[i_g * NEvents * 4];
+    for (int i_c = 0; i_c < nChunks; i_c++) {
+      __m256i values = _mm256_loadu_si256((const __m256i*)&group[i_c * 32]);
+      __m256i low = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(values));
+      __m256i high = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(values, 1));
+      sumsLow[i_c] = _mm256_add_epi32(sumsLow[i_c],
+				      _mm256_madd_epi16(low, weightVector));
+      sumsHigh[i_c] = _mm256_add_epi32(sumsHigh[i_c],
+				       _mm256_madd_epi16(high, weightVector));
+    }
+  }
+  // Add the partial sums of each event and restore the event order:
+  for (int i_c = 0; i_c < nChunks; i_c++) {
+    __m256i sums = _mm256_hadd_epi32(sumsLow[i_c], sumsHigh[i_c]);
+    sums = _mm256_permute4x64_epi64(sums, 0xD8);
+    _mm256_storeu_si256((__m256i*)&products[i_c * 8], sums);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   AVX-512 VNNI dot products: vpdpbusd multiplies the four unsigned inputs of
+   16 events with the four signed weights and adds them to 32-bit sums.
+*/
+template <int NEvents>
+__attribute__((target("avx512f,avx512vnni")))
+static void dotProductsVNNI(const uint8_t *activations,
+			    const int8_t *weights, int nGroups,
+			    int32_t *products) {
+  const int nChunks = NEvents / 16;
+  __m512i sums[nChunks];
+  for (int i_c = 0; i_c < nChunks; i_c++) sums[i_c] = _mm512_setzero_si512();
+  for (int i_g = 0; i_g < nGroups; i_g++) {
+    int32_t packedWeight;
+    memcpy(&packedWeight, &weights[i_g * 4], sizeof(packedWeight));
+    __m512i weightVector = _mm512_set1_epi32(packedWeight);
+    const uint8_t *group = &activations[i_g * NEvents * 4];
+    for (int i_c = 0; i_c < nChunks; i_c++) {
+      __m512i values = _mm512_loadu_si512((const void*)&group[i_c * 64]);
+      sums[i_c] = _mm512_dpbusd_epi32(sums[i_c], values, weightVector);
+    }
+  }
+  for (int i_c = 0; i_c < nChunks; i_c++) {
+    _mm512_storeu_si512((void*)&products[i_c * 16], sums[i_c]);
+  }
+}
+
+#endif
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The fastest kernel supported by the CPU.
+*/
+static QuantizedKernel supportedKernel() {
+#ifdef QUANTIZED_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") &&
+      __builtin_cpu_supports("avx512vnni")) {
+    return kVNNIKernel;
+  }
+  if (__builtin_cpu_supports("avx2")) return kAVX2Kernel;
+#endif
+  return kScalarKernel;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Quantize a value onto [0,255] over a calibrated range.
+*/
+static inline uint8_t quantize(float value, float minimum,
+			       float inverseStep) {
+  float scaled = (value - minimum) * inverseStep + 0.5f;
+  scaled = (scaled > 0.0f) ? scaled : 0.0f;
+  scaled = (scaled < 255.0f) ? scaled : 255.0f;
+  return (uint8_t)scaled;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   QuantizedNetwork constructor.
+   @param network - The trained network to quantize.
+   @param calibration - Events used to calibrate the ranges of the responses.
+   @param granularity - Whether the ranges are per node or per layer.
+*/
+QuantizedNetwork::QuantizedNetwork(CompiledNetwork *network,
+				   const EventBlock &calibration,
+				   QuantizationGranularity granularity) {
+  m_granularity = granularity;
+  build(network, calibration);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   QuantizedNetwork constructor.
+   @param network - The trained network to quantize.
+   @param calibration - Events used to calibrate the ranges of the responses.
+   @param granularity - Whether the ranges are per node or per layer.
+*/
+QuantizedNetwork::QuantizedNetwork(NeuralNetwork *network,
+				   const EventBlock &calibration,
+				   QuantizationGranularity granularity) {
+  m_granularity = granularity;
+  CompiledNetwork compiledNetwork(network);
+  build(&compiledNetwork, calibration);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   QuantizedNetwork destructor. All storage is owned by member vectors.
+*/
+QuantizedNetwork::~QuantizedNetwork() {
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Calibrate the response ranges and quantize the weights. The calibration runs
+   the network in double precision over all of the calibration events.
+   @param network - The trained network to quantize.
+   @param calibration - The calibration events.
+*/
+void QuantizedNetwork::build(CompiledNetwork *network,
+			     const EventBlock &calibration) {
+  m_nLayers = network->getNLayers();
+  m_layerSizes.clear();
+  m_layerFunctions.clear();
+  for (int i_l = 0; i_l < m_nLayers; i_l++) {
+    m_layerSizes.push_back(network->getLayerSize(i_l));
+    m_layerFunctions.push_back(network->getLayerFunction(i_l));
+  }
+  m_normalization = network->getInputNormalization();
+  if (calibration.getNVariables() != m_layerSizes[0] ||
+      calibration.getNEvents() < 1) {
+    std::cout << "QuantizedNetwork: ERROR! Bad calibration sample."
+	      << std::endl;
+    exit(0);
+  }
+  std::vector<double> parameters = network->getParameters();
+
+  // Find the range of the responses of each node that feeds a later layer:
+  std::vector<std::vector<double> > responses(m_nLayers);
+  std::vector<std::vector<double> > minima(m_nLayers-1);
+  std::vector<std::vector<double> > maxima(m_nLayers-1);
+  for (int i_l = 0; i_l < m_nLayers; i_l++) {
+    responses[i_l].assign(m_layerSizes[i_l], 0.0);
+    if (i_l < m_nLayers-1) {
+      minima[i_l].assign(m_layerSizes[i_l], 0.0);
+      maxima[i_l].assign(m_layerSizes[i_l], 0.0);
+    }
+  }
+  std::vector<double> vars(m_layerSizes[0]);
+  for (int i_e = 0; i_e < calibration.getNEvents(); i_e++) {
+    calibration.getEvent(i_e, &vars[0]);
+    for (int i_i = 0; i_i < m_layerSizes[0]; i_i++) {
+      double value = m_normalization.isActive() ?
+	m_normalization.transformValue(i_i, vars[i_i]) : vars[i_i];
+      responses[0][i_i] = Activation::evaluate(m_layerFunctions[0], value);
+    }
+    for (int i_l = 1; i_l < m_nLayers-1; i_l++) {
+      int nIn = m_layerSizes[i_l-1];
+      const double *weights = &parameters[network->getWeightOffset(i_l)];
+      const double *biases = &parameters[network->getBiasOffset(i_l)];
+      for (int i_o = 0; i_o < m_layerSizes[i_l]; i_o++) {
+	double currSum = 0.0;
+	for (int i_i = 0; i_i < nIn; i_i++) {
+	  currSum += (weights[i_o * nIn + i_i] * responses[i_l-1][i_i]);
+	}
+	responses[i_l][i_o] = Activation::evaluate(m_layerFunctions[i_l],
+						   currSum + biases[i_o]);
+      }
+    }
+    for (int i_l = 0; i_l < m_nLayers-1; i_l++) {
+      for (int i_n = 0; i_n < m_layerSizes[i_l]; i_n++) {
+	double response = responses[i_l][i_n];
+	if (i_e == 0 || response < minima[i_l][i_n]) {
+	  minima[i_l][i_n] = response;
+	}
+	if (i_e == 0 || response > maxima[i_l][i_n]) {
+	  maxima[i_l][i_n] = response;
+	}
+      }
+    }
+  }
+
+  // The quantization steps of the responses:
+  m_minima.assign(m_nLayers-1, std::vector<float>());
+  m_steps.assign(m_nLayers-1, std::vector<float>());
+  m_inverseSteps.assign(m_nLayers-1, std::vector<float>());
+  for (int i_l = 0; i_l < m_nLayers-1; i_l++) {
+    if (m_granularity == kPerLayerScales) {
+      double minimum = *std::min_element(minima[i_l].begin(),
+					 minima[i_l].end());
+      double maximum = *std::max_element(maxima[i_l].begin(),
+					 maxima[i_l].end());
+      minima[i_l].assign(m_layerSizes[i_l], minimum);
+      maxima[i_l].assign(m_layerSizes[i_l], maximum);
+    }
+    for (int i_n = 0; i_n < m_layerSizes[i_l]; i_n++) {
+      double step = (maxima[i_l][i_n] - minima[i_l][i_n]) / 255.0;
+      m_minima[i_l].push_back(minima[i_l][i_n]);
+      m_steps[i_l].push_back(step);
+      m_inverseSteps[i_l].push_back((step > 0.0) ? 1.0 / step : 0.0);
+    }
+  }
+
+  // Fold the input steps into the weights and quantize each node:
+  m_weights.assign(m_nLayers, std::vector<int8_t>());
+  m_scales.assign(m_nLayers, std::vector<float>());
+  m_offsets.assign(m_nLayers, std::vector<float>());
+  m_nGroups.assign(m_nLayers, 0);
+  for (int i_l = 1; i_l < m_nLayers; i_l++) {
+    int nIn = m_layerSizes[i_l-1];
+    int nOut = m_layerSizes[i_l];
+    m_nGroups[i_l] = (nIn + 3) / 4;
+    m_weights[i_l].assign(nOut * m_nGroups[i_l] * 4, 0);
+    const double *weights = &parameters[network->getWeightOffset(i_l)];
+    const double *biases = &parameters[network->getBiasOffset(i_l)];
+    for (int i_o = 0; i_o < nOut; i_o++) {
+      const double *row = &weights[i_o * nIn];
+      double offset = biases[i_o];
+      double maximum = 0.0;
+      for (int i_i = 0; i_i < nIn; i_i++) {
+	offset += row[i_i] * minima[i_l-1][i_i];
+	double folded = fabs(row[i_i] * m_steps[i_l-1][i_i]);
+	if (folded > maximum) maximum = folded;
+      }
+      double scale = maximum / 127.0;
+      for (int i_i = 0; i_i < nIn && scale > 0.0; i_i++) {
+	double folded = row[i_i] * m_steps[i_l-1][i_i] / scale;
+	m_weights[i_l][i_o * m_nGroups[i_l] * 4 + i_i]
+	  = (int8_t)((folded < 0.0) ? -floor(0.5 - folded) :
+		     floor(folded + 0.5));
+      }
+      m_scales[i_l].push_back(scale);
+      m_offsets[i_l].push_back(offset);
+    }
+  }
+
+  // Tabulate the activation functions of the hidden layers over the ranges
+  // where they are not (nearly) constant:
+  m_tables.assign(m_nLayers, std::vector<float>());
+  m_tableMinima.assign(m_nLayers, 0.0);
+  m_tableScales.assign(m_nLayers, 0.0);
+  for (int i_l = 1; i_l < m_nLayers-1; i_l++) {
+    double range = 1.0;
+    if (m_layerFunctions[i_l] == kSigmoid) range = 8.0;
+    else if (m_layerFunctions[i_l] == kTanh) range = 4.0;
+    m_tableMinima[i_l] = -range;
+    m_tableScales[i_l] = (kTableSize - 1) / (2.0 * range);
+    for (int i_t = 0; i_t < kTableSize; i_t++) {
+      double sum = -range + (2.0 * range * i_t) / (kTableSize - 1);
+      m_tables[i_l].push_back(Activation::evaluate(m_layerFunctions[i_l],
+						   sum));
+    }
+  }
+
+  // Block scratch:
+  m_activations.assign(m_nLayers-1, std::vector<uint8_t>());
+  for (int i_l = 0; i_l < m_nLayers-1; i_l++) {
+    m_activations[i_l].assign(((m_layerSizes[i_l] + 3) / 4) * kBlockSize * 4,
+			      0);
+  }
+  m_column.assign(kBlockSize, 0.0);
+  m_sums.assign(kBlockSize, 0.0);
+  m_kernel = supportedKernel();
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Compute the integer dot products of one node with its quantized inputs for
+   all kBlockSize events of the block.
+   @param layerIndex - The index of the layer of the node (>= 1).
+   @param nodeIndex - The index of the node.
+   @param products - The kBlockSize integer sums (output).
+*/
+void QuantizedNetwork::dotProducts(int layerIndex, int nodeIndex,
+				   int32_t *products) const {
+  const uint8_t *activations = &m_activations[layerIndex-1][0];
+  int nGroups = m_nGroups[layerIndex];
+  const int8_t *weights = &m_weights[layerIndex][nodeIndex * nGroups * 4];
+#ifdef QUANTIZED_X86
+  if (m_kernel == kVNNIKernel) {
+    dotProductsVNNI<kBlockSize>(activations, weights, nGroups, products);
+    return;
+  }
+  if (m_kernel == kAVX2Kernel) {
+    dotProductsAVX2<kBlockSize>(activations, weights, nGroups, products);
+    return;
+  }
+#endif
+  dotProductsScalar<kBlockSize>(activations, weights, nGroups, products);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Propagate a block of quantized inputs through the network.
+   @param nEvents - The number of events in the block (<= kBlockSize).
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+*/
+void QuantizedNetwork::forwardBlock(int nEvents, double *outputs) {
+  int32_t products[kBlockSize];
+  float *sums = &m_sums[0];
+  for (int i_l = 1; i_l < m_nLayers; i_l++) {
+    int nOut = m_layerSizes[i_l];
+    bool isOutput = (i_l == m_nLayers-1);
+    for (int i_o = 0; i_o < nOut; i_o++) {
+      dotProducts(i_l, i_o, products);
+      float offset = m_offsets[i_l][i_o];
+      float scale = m_scales[i_l][i_o];
+      for (int i_e = 0; i_e < nEvents; i_e++) {
+	sums[i_e] = offset + scale * (float)products[i_e];
+      }
+      if (isOutput) {
+	for (int i_e = 0; i_e < nEvents; i_e++) {
+	  outputs[i_e * nOut + i_o]
+	    = Activation::evaluate(m_layerFunctions[i_l], sums[i_e]);
+	}
+	continue;
+      }
+      // Look up the activation and quantize it for the next layer:
+      const float *table = &m_tables[i_l][0];
+      float tableMinimum = m_tableMinima[i_l];
+      float tableScale = m_tableScales[i_l];
+      float minimum = m_minima[i_l][i_o];
+      float inverseStep = m_inverseSteps[i_l][i_o];
+      uint8_t *activations = &m_activations[i_l][(i_o / 4) * kBlockSize * 4
+						 + (i_o % 4)];
+      for (int i_e = 0; i_e < nEvents; i_e++) {
+	float index = (sums[i_e] - tableMinimum) * tableScale + 0.5f;
+	index = (index > 0.0f) ? index : 0.0f;
+	index = (index < kTableSize - 1) ? index : (float)(kTableSize - 1);
+	activations[i_e * 4] = quantize(table[(int)index], minimum,
+					inverseStep);
+      }
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score a row-major block of events.
+   @param events - Row-major [nEvents x nInputs] matrix of input variables.
+   @param nEvents - The number of events.
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+*/
+void QuantizedNetwork::getBatchResponse(const double *events, int nEvents,
+					double *outputs) {
+  int nInputs = getNInputs();
+  for (int i_b = 0; i_b < nEvents; i_b += kBlockSize) {
+    int nBlock = (nEvents - i_b < kBlockSize) ? (nEvents - i_b) : kBlockSize;
+    const double *blockEvents = &events[(long)i_b * nInputs];
+    for (int i_i = 0; i_i < nInputs; i_i++) {
+      for (int i_e = 0; i_e < nBlock; i_e++) {
+	m_column[i_e] = blockEvents[i_e * nInputs + i_i];
+      }
+      quantizeInput(i_i, &m_column[0], nBlock);
+    }
+    forwardBlock(nBlock, &outputs[(long)i_b * getNOutputs()]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score all events of an EventBlock, reading the input variables column by
+   column.
+   @param block - The events.
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+*/
+void QuantizedNetwork::getBatchResponse(const EventBlock &block,
+					double *outputs) {
+  if (block.getNVariables() != getNInputs()) {
+    std::cout << "QuantizedNetwork: ERROR! Wrong number of variables in block."
+	      << std::endl;
+    exit(0);
+  }
+  int nEvents = block.getNEvents();
+  for (int i_b = 0; i_b < nEvents; i_b += kBlockSize) {
+    int nBlock = (nEvents - i_b < kBlockSize) ? (nEvents - i_b) : kBlockSize;
+    for (int i_i = 0; i_i < getNInputs(); i_i++) {
+      block.getColumn(i_i, i_b, nBlock, &m_column[0]);
+      quantizeInput(i_i, &m_column[0], nBlock);
+    }
+    forwardBlock(nBlock, &outputs[(long)i_b * getNOutputs()]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - Whether the response ranges are per node or per layer.
+*/
+QuantizationGranularity QuantizedNetwork::getGranularity() const {
+  return m_granularity;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The integer dot-product kernel in use.
+*/
+QuantizedKernel QuantizedNetwork::getKernel() const {
+  return m_kernel;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The name of the integer dot-product kernel in use.
+*/
+std::string QuantizedNetwork::getKernelName() const {
+  switch (m_kernel) {
+  case kVNNIKernel: return "vnni";
+  case kAVX2Kernel: return "avx2";
+  default: return "scalar";
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of input variables.
+*/
+int QuantizedNetwork::getNInputs() const {
+  return m_layerSizes[0];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of output variables.
+*/
+int QuantizedNetwork::getNOutputs() const {
+  return m_layerSizes[m_nLayers-1];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score a single event. This runs a whole block of the kernels, so use
+   getBatchResponse() wherever events can be grouped.
+   @param vars - The getNInputs() input variables.
+   @param outputs - Buffer for the getNOutputs() responses of the output layer.
+*/
+void QuantizedNetwork::getNetworkResponse(const double *vars,
+					  double *outputs) {
+  getBatchResponse(vars, 1, outputs);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Normalize and activate one input variable of a block in double precision,
+   then quantize it into the input layer of the block scratch.
+   @param variableIndex - The index of the input variable.
+   @param values - The raw values (overwritten).
+   @param nEvents - The number of events in the block.
+*/
+void QuantizedNetwork::quantizeInput(int variableIndex, double *values,
+				     int nEvents) {
+  if (m_normalization.isActive()) {
+    m_normalization.transformColumn(variableIndex, values, nEvents, values);
+  }
+  Activation::evaluateLayer(m_layerFunctions[0], values, nEvents, values,
+			    NULL);
+  float minimum = m_minima[0][variableIndex];
+  float inverseStep = m_inverseSteps[0][variableIndex];
+  uint8_t *activations = &m_activations[0][(variableIndex / 4) * kBlockSize * 4
+					   + (variableIndex % 4)];
+  for (int i_e = 0; i_e < nEvents; i_e++) {
+    activations[i_e * 4] = quantize(values[i_e], minimum, inverseStep);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Choose the integer dot-product kernel, for instance to compare them. All
+   kernels give identical results. A kernel that the CPU does not support is
+   replaced by the fastest one that it does.
+   @param kernel - The kernel to use.
+*/
+void QuantizedNetwork::setKernel(QuantizedKernel kernel) {
+  QuantizedKernel supported = supportedKernel();
+  m_kernel = (kernel < supported) ? kernel : supported;
+}
@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: QuantizedNetwork.h                                                  //
+//  Class: QuantizedNetwork.cxx                                               //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef QuantizedNetwork_h
+#define QuantizedNetwork_h
+
+#include "Activation.h"
+#include "CompiledNetwork.h"
+#include "EventBlock.h"
+#include "NeuralNetwork.h"
+#include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+// Granularity of the calibrated activation ranges:
+enum QuantizationGranularity {
+  kPerLayerScales,// One range for all nodes of a layer
+  kPerNeuronScales// One range per node
+};
+
+// Integer dot-product kernels:
+enum QuantizedKernel { kScalarKernel, kAVX2Kernel, kVNNIKernel };
+
+class QuantizedNetwork
+{
+
+ public:
+
+  QuantizedNetwork(CompiledNetwork *network, const EventBlock &calibration,
+		   QuantizationGranularity granularity);
+  QuantizedNetwork(NeuralNetwork *network, const EventBlock &calibration,
+		   QuantizationGranularity granularity);
+  ~QuantizedNetwork();
+
+  // Accessors:
+  void getBatchResponse(const double *events, int nEvents, double *outputs);
+  void getBatchResponse(const EventBlock &block, double *outputs);
+  QuantizationGranularity getGranularity() const;
+  QuantizedKernel getKernel() const;
+  std::string getKernelName() const;
+  int getNInputs() const;
+  int getNOutputs() const;
+  void getNetworkResponse(const double *vars, double *outputs);
+
+  // Mutators:
+  void setKernel(QuantizedKernel kernel);
+
+ private:
+
+  // Private functions:
+  void build(CompiledNetwork *network, const EventBlock &calibration);
+  void dotProducts(int layerIndex, int nodeIndex, int32_t *products) const;
+  void forwardBlock(int nEvents, double *outputs);
+  void quantizeInput(int variableIndex, double *values, int nEvents);
+
+  // Not copyable:
+  QuantizedNetwork(const QuantizedNetwork&);
+  QuantizedNetwork& operator=(const QuantizedNetwork&);
+
+  // Events per block (the lanes of the kernels):
+  static const int kBlockSize = 64;
+
+  // Topology (index 0 is the input layer):
+  int m_nLayers;
+  std::vector<int> m_layerSizes;
+  std::vector<ActivationFunction> m_layerFunctions;
+  InputNormalization m_normalization;
+  QuantizationGranularity m_granularity;
+  QuantizedKernel m_kernel;
+
+  // The responses of node k of layer L are quantized to 8 bits over their
+  // calibrated range: a = m_minima[L][k] + q * m_steps[L][k], q in [0,255].
+  std::vector<std::vector<float> > m_minima;
+  std::vector<std::vector<float> > m_steps;
+  std::vector<std::vector<float> > m_inverseSteps;
+
+  // Layer L >= 1: int8 weights [node x group of 4 inputs x 4], with the input
+  // steps folded in, and the sum of node o is
+  //   m_offsets[L][o] + m_scales[L][o] * sum_k q_k * m_weights[L][o][k],
+  // where the offset holds the bias and the contribution of the minima.
+  std::vector<std::vector<int8_t> > m_weights;
+  std::vector<std::vector<float> > m_scales;
+  std::vector<std::vector<float> > m_offsets;
+  std::vector<int> m_nGroups;
+
+  // Lookup table of the activation function of each hidden layer, over
+  // [m_tableMinima[L], m_tableMinima[L] + (kTableSize-1) / m_tableScales[L]]:
+  static const int kTableSize = 4096;
+  std::vector<std::vector<float> > m_tables;
+  std::vector<float> m_tableMinima;
+  std::vector<float> m_tableScales;
+
+  // Block scratch: the quantized responses of layer L for event e, input k
+  // are at m_activations[L][((k/4) * kBlockSize + e) * 4 + k%4]:
+  std::vector<std::vector<uint8_t> > m_activations;
+  std::vector<double> m_column;
+  std::vector<float> m_sums;
+
+};
+
+#endif
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: ScanBenchmark.cxx                                                   //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Runs a HyperparameterScan over a grid of 1-3 hidden layers, 4-16 nodes    //
+//  per layer and three learning rates on the events of an EventFile. The     //
+//  first nTrain events train every point and the next nValidation events     //
+//  validate it; both are views of the one memory-mapped file. The inputs are //
+//  range-normalized. The ranked summary lists the points from the lowest     //
+//  validation loss down, with the points that were stopped early, the total  //
+//  number of epochs trained and the number of work steals.                   //
+//                                                                            //
+//  Usage: ScanBenchmark <eventFile> [nThreads] [nEpochs] [nTrain]            //
+//                       [nValidation]                                        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "EventFile.h"
+#include "HyperparameterScan.h"
+#include "InputNormalization.h"
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/**
+   -----------------------------------------------------------------------------
+   Main method: scan a grid of configurations.
+*/
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cout << "Usage: " << argv[0] << " <eventFile> [nThreads] [nEpochs] "
+	      << "[nTrain] [nValidation]" << std::endl;
+    exit(0);
+  }
+  EventFile eventFile(argv[1]);
+  int nThreads = (argc > 2) ? atoi(argv[2]) : 4;
+  int nEpochs = (argc > 3) ? atoi(argv[3]) : 6;
+  int nTrain = (argc > 4) ? atoi(argv[4]) : 20000;
+  int nValidation = (argc > 5) ? atoi(argv[5]) : 20000;
+  if (nTrain < 1 || nValidation < 1 ||
+      nTrain + nValidation > eventFile.getNEvents()) {
+    std::cout << "ScanBenchmark: ERROR! Bad sample sizes." << std::endl;
+    exit(0);
+  }
+  EventBlock training, validation;
+  eventFile.getBlock(0, nTrain, training);
+  eventFile.getBlock(nTrain, nValidation, validation);
+  InputNormalization normalization(training.getNVariables(),
+				   kRangeNormalization, 1);
+  normalization.fill(training);
+  normalization.finalize();
+
+  HyperparameterScan scan(training, validation, nThreads);
+  scan.setInputNormalization(normalization);
+  scan.setNEpochs(nEpochs);
+  scan.setVerbose(true);
+  std::vector<int> nHiddenLayers = {1, 2, 3};
+  std::vector<int> nNodesPerLayer = {4, 8, 16};
+  std::vector<double> learningRates = {0.005, 0.02, 0.08};
+  scan.addGrid(nHiddenLayers, nNodesPerLayer, learningRates);
+
+  std::chrono::steady_clock::time_point start
+    = std::chrono::steady_clock::now();
+  scan.run();
+  double seconds = std::chrono::duration<double>
+    (std::chrono::steady_clock::now() - start).count();
+  scan.printSummary();
+  const ScanPoint &best = scan.getBestPoint();
+  printf("ScanBenchmark: best %d x %d rate %.6g loss %.6g, scan took %.3g s\n",
+	 best.nHiddenLayers, best.nNodesPerLayer, best.learningRate,
+	 best.bestLoss, seconds);
+  return 0;
+}
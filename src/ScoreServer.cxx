@@ -0,0 +1,55 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: ScoreServer.cxx                                                     //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Serves a stored model to the processes on a node through an               //
+//  InferenceServer until it receives SIGINT or SIGTERM. Analysis jobs score  //
+//  their events with an InferenceClient on the same socket path.             //
+//                                                                            //
+//  Usage: ScoreServer <modelFile> <socketPath> [maxBatchSize]                //
+//                     [maxLatencyMicroseconds]                               //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "InferenceServer.h"
+#include "ModelFile.h"
+#include <iostream>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+   -----------------------------------------------------------------------------
+   Main method: serve a model until interrupted.
+*/
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cout << "Usage: " << argv[0] << " <modelFile> <socketPath> "
+	      << "[maxBatchSize] [maxLatencyMicroseconds]" << std::endl;
+    exit(0);
+  }
+  // Block the stop signals in all threads, so that only sigwait() sees them:
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+  ModelFile modelFile(argv[1]);
+  InferenceServer server(modelFile.getNetwork(), argv[2]);
+  if (argc > 3) server.setMaxBatchSize(atoi(argv[3]));
+  if (argc > 4) server.setMaxLatency(atof(argv[4]));
+  server.setVerbose(true);
+  server.start();
+
+  int signal = 0;
+  sigwait(&signals, &signal);
+  server.stop();
+  printf("ScoreServer: Mean batch size %.1f events\n",
+	 server.getMeanBatchSize());
+  return 0;
+}
@@ -0,0 +1,584 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: SparseNetwork.cxx                                                   //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  This class is a magnitude-pruned copy of a trained network, for smaller   //
+//  and faster deployment. It is built from a CompiledNetwork: the weights    //
+//  whose magnitude is below a threshold are removed, and the surviving      //
+//  weights of each layer are stored in compressed sparse rows (one row of   //
+//  values and input indices per node). The biases stay dense.               //
+//                                                                            //
+//  The forward and backward passes only visit the surviving connections.    //
+//  getBatchResponse() evaluates blocks of kBlockSize events node-major, so   //
+//  that each surviving weight is applied to a whole block of inputs in one   //
+//  vectorizable loop. With a threshold of 0 only exactly-zero weights are    //
+//  removed and the responses equal those of the CompiledNetwork.             //
+//                                                                            //
+//  Pruning usually costs a little accuracy, which fine-tuning recovers:      //
+//  train() runs mini-batch gradient descent on the surviving weights only,   //
+//  so the pruned connections stay removed. prune() removes more weights, for //
+//  iterative pruning. exportWeights() writes the result back into a dense    //
+//  network, with zero weights for the pruned connections.                    //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "SparseNetwork.h"
+#include <math.h>
+
+const int SparseNetwork::kBlockSize;
+
+/**
+   -----------------------------------------------------------------------------
+   SparseNetwork constructor.
+   @param network - The trained network to prune.
+   @param threshold - Weights with a magnitude below this are removed.
+*/
+SparseNetwork::SparseNetwork(CompiledNetwork *network, double threshold) {
+  build(network, threshold);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   SparseNetwork constructor.
+   @param network - The trained network to prune.
+   @param threshold - Weights with a magnitude below this are removed.
+*/
+SparseNetwork::SparseNetwork(NeuralNetwork *network, double threshold) {
+  CompiledNetwork compiledNetwork(network);
+  build(&compiledNetwork, threshold);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   SparseNetwork destructor. All storage is owned by member vectors.
+*/
+SparseNetwork::~SparseNetwork() {
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Back-propagate one weighted event and add its gradient to the gradients of
+   the surviving weights and of the biases. The loss and the deltas are those
+   of CompiledNetwork::accumulateGradient(). The gradient buffers are
+   allocated on the first call, so that scoring-only copies do not hold them.
+   @param vars - The nInputs input variables.
+   @param targets - The nOutputs target values.
+   @param weight - The weight of the event.
+   @returns - The weighted loss of the event.
+*/
+double SparseNetwork::accumulateGradient(const double *vars,
+					 const double *targets,
+					 double weight) {
+  if (m_biasGradients[m_nLayers-1].empty()) {
+    for (int i_l = 1; i_l < m_nLayers; i_l++) {
+      m_valueGradients[i_l].assign(m_values[i_l].size(), 0.0);
+      m_biasGradients[i_l].assign(m_layerSizes[i_l], 0.0);
+    }
+  }
+  forwardPass(vars, true);
+
+  // Output layer deltas:
+  double loss = 0.0;
+  int outputLayer = m_nLayers-1;
+  for (int i_o = 0; i_o < m_layerSizes[outputLayer]; i_o++) {
+    double error = m_responses[outputLayer][i_o] - targets[i_o];
+    m_deltas[outputLayer][i_o]
+      = weight * error * m_derivatives[outputLayer][i_o];
+    loss += weight * 0.5 * error * error;
+  }
+
+  // Walk backwards through the layers over the surviving connections only,
+  // accumulating dE/dW = delta_j * o_i and the deltas of the layer below:
+  for (int i_l = m_nLayers-1; i_l >= 1; i_l--) {
+    int nIn = m_layerSizes[i_l-1];
+    int nOut = m_layerSizes[i_l];
+    const int *rowOffsets = &m_rowOffsets[i_l][0];
+    const int *columns = m_columns[i_l].empty() ? NULL : &m_columns[i_l][0];
+    const double *values = m_values[i_l].empty() ? NULL : &m_values[i_l][0];
+    double *valueGradients = m_valueGradients[i_l].empty() ? NULL :
+      &m_valueGradients[i_l][0];
+    const double *input = &m_responses[i_l-1][0];
+    const double *delta = &m_deltas[i_l][0];
+    double *inputDelta = &m_deltas[i_l-1][0];
+    bool isHidden = (i_l > 1);
+    if (isHidden) {
+      for (int i_i = 0; i_i < nIn; i_i++) inputDelta[i_i] = 0.0;
+    }
+    for (int i_o = 0; i_o < nOut; i_o++) {
+      if (m_layerHasBias[i_l]) m_biasGradients[i_l][i_o] += delta[i_o];
+      for (int i_k = rowOffsets[i_o]; i_k < rowOffsets[i_o+1]; i_k++) {
+	valueGradients[i_k] += (delta[i_o] * input[columns[i_k]]);
+	if (isHidden) inputDelta[columns[i_k]] += (values[i_k] * delta[i_o]);
+      }
+    }
+    if (isHidden) {
+      const double *inputDerivative = &m_derivatives[i_l-1][0];
+      for (int i_i = 0; i_i < nIn; i_i++) {
+	inputDelta[i_i] *= inputDerivative[i_i];
+      }
+    }
+  }
+  m_nAccumulated++;
+  return loss;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Update the surviving weights and the biases with the accumulated gradient,
+   averaged over the events, and clear it.
+   @param nEvents - The number of events in the gradient.
+*/
+void SparseNetwork::applyGradient(int nEvents) {
+  if (nEvents <= 0 || m_nAccumulated == 0) return;
+  double scale = -1.0 * m_rate / ((double)nEvents);
+  for (int i_l = 1; i_l < m_nLayers; i_l++) {
+    for (int i_k = 0; i_k < (int)m_values[i_l].size(); i_k++) {
+      m_values[i_l][i_k] += scale * m_valueGradients[i_l][i_k];
+      m_valueGradients[i_l][i_k] = 0.0;
+    }
+    for (int i_o = 0; i_o < m_layerSizes[i_l]; i_o++) {
+      m_biases[i_l][i_o] += scale * m_biasGradients[i_l][i_o];
+      m_biasGradients[i_l][i_o] = 0.0;
+    }
+  }
+  m_nAccumulated = 0;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Copy the topology of a network and compress the weights of each layer,
+   dropping those below the threshold.
+   @param network - The trained network to prune.
+   @param threshold - Weights with a magnitude below this are removed.
+*/
+void SparseNetwork::build(CompiledNetwork *network, double threshold) {
+  m_nLayers = network->getNLayers();
+  m_normalization = network->getInputNormalization();
+  m_layerSizes.assign(m_nLayers, 0);
+  m_layerFunctions.assign(m_nLayers, kLinear);
+  m_layerHasBias.assign(m_nLayers, false);
+  for (int i_l = 0; i_l < m_nLayers; i_l++) {
+    m_layerSizes[i_l] = network->getLayerSize(i_l);
+    m_layerFunctions[i_l] = network->getLayerFunction(i_l);
+    if (i_l > 0) m_layerHasBias[i_l] = network->layerHasBias(i_l);
+  }
+  m_rate = 0.2;
+  m_miniBatchSize = 100;
+  m_nAccumulated = 0;
+
+  m_nDenseConnections = 0;
+  m_rowOffsets.assign(m_nLayers, std::vector<int>());
+  m_columns.assign(m_nLayers, std::vector<int>());
+  m_values.assign(m_nLayers, std::vector<double>());
+  m_biases.assign(m_nLayers, std::vector<double>());
+  m_valueGradients.assign(m_nLayers, std::vector<double>());
+  m_biasGradients.assign(m_nLayers, std::vector<double>());
+  m_responses.assign(m_nLayers, std::vector<double>());
+  m_derivatives.assign(m_nLayers, std::vector<double>());
+  m_deltas.assign(m_nLayers, std::vector<double>());
+  m_blockResponses.assign(m_nLayers, std::vector<double>());
+  std::vector<double> parameters = network->getParameters();
+  for (int i_l = 0; i_l < m_nLayers; i_l++) {
+    int nOut = m_layerSizes[i_l];
+    m_responses[i_l].assign(nOut, 0.0);
+    m_derivatives[i_l].assign(nOut, 0.0);
+    m_deltas[i_l].assign(nOut, 0.0);
+    m_blockResponses[i_l].assign(nOut * kBlockSize, 0.0);
+    if (i_l == 0) continue;
+    int nIn = m_layerSizes[i_l-1];
+    const double *weights = &parameters[network->getWeightOffset(i_l)];
+    const double *biases = &parameters[network->getBiasOffset(i_l)];
+    m_rowOffsets[i_l].assign(nOut+1, 0);
+    for (int i_o = 0; i_o < nOut; i_o++) {
+      for (int i_i = 0; i_i < nIn; i_i++) {
+	double value = weights[i_o * nIn + i_i];
+	if (value == 0.0 || fabs(value) < threshold) continue;
+	m_columns[i_l].push_back(i_i);
+	m_values[i_l].push_back(value);
+      }
+      m_rowOffsets[i_l][i_o+1] = (int)m_values[i_l].size();
+    }
+    m_columns[i_l].shrink_to_fit();
+    m_values[i_l].shrink_to_fit();
+    m_biases[i_l].assign(biases, biases + nOut);
+    m_nDenseConnections += nOut * nIn;
+  }
+  m_column.assign(kBlockSize, 0.0);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Copy the weights into a CompiledNetwork of the same topology, with zero
+   weights for the pruned connections.
+   @param network - The network to write to.
+*/
+void SparseNetwork::exportWeights(CompiledNetwork *network) {
+  bool isSame = (network->getNLayers() == m_nLayers);
+  for (int i_l = 0; isSame && i_l < m_nLayers; i_l++) {
+    isSame = (network->getLayerSize(i_l) == m_layerSizes[i_l]);
+  }
+  if (!isSame) {
+    std::cout << "SparseNetwork: ERROR! Cannot export to a different topology."
+	      << std::endl;
+    exit(0);
+  }
+  double *parameters = network->getParameterData();
+  for (int i_l = 1; i_l < m_nLayers; i_l++) {
+    int nIn = m_layerSizes[i_l-1];
+    double *weights = &parameters[network->getWeightOffset(i_l)];
+    double *biases = &parameters[network->getBiasOffset(i_l)];
+    for (int i_o = 0; i_o < m_layerSizes[i_l]; i_o++) {
+      double *row = &weights[i_o * nIn];
+      for (int i_i = 0; i_i < nIn; i_i++) row[i_i] = 0.0;
+      for (int i_k = m_rowOffsets[i_l][i_o]; i_k < m_rowOffsets[i_l][i_o+1];
+	   i_k++) {
+	row[m_columns[i_l][i_k]] = m_values[i_l][i_k];
+      }
+      biases[i_o] = m_biases[i_l][i_o];
+    }
+  }
+  network->setPrecision(network->getPrecision());
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Copy the weights into the Axons of a NeuralNetwork of the same topology.
+   The pruned connections remain in the graph with zero weight.
+   @param network - The network to write to.
+*/
+void SparseNetwork::exportWeights(NeuralNetwork *network) {
+  CompiledNetwork compiledNetwork(network);
+  exportWeights(&compiledNetwork);
+  compiledNetwork.exportWeights(network);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Propagate a block of input layer responses (stored node-major in the block
+   scratch) through all subsequent layers. For each node, every surviving
+   weight is applied to the whole block of its input node.
+   @param nEvents - The number of events in the block.
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+*/
+void SparseNetwork::forwardBlock(int nEvents, double *outputs) {
+  for (int i_l = 1; i_l < m_nLayers; i_l++) {
+    int nOut = m_layerSizes[i_l];
+    const int *rowOffsets = &m_rowOffsets[i_l][0];
+    const int *columns = m_columns[i_l].empty() ? NULL : &m_columns[i_l][0];
+    const double *values = m_values[i_l].empty() ? NULL : &m_values[i_l][0];
+    const double *input = &m_blockResponses[i_l-1][0];
+    double *output = &m_blockResponses[i_l][0];
+    for (int i_o = 0; i_o < nOut; i_o++) {
+      // Sum into a local array, which cannot alias the inputs, with a constant
+      // trip count, so that the compiler vectorizes at -O2 (as in
+      // CompiledNetwork::forwardBlock()). Lanes past nEvents are not used:
+      double sums[kBlockSize];
+      for (int i_e = 0; i_e < kBlockSize; i_e++) sums[i_e] = 0.0;
+      for (int i_k = rowOffsets[i_o]; i_k < rowOffsets[i_o+1]; i_k++) {
+	double value = values[i_k];
+	const double *column = &input[columns[i_k] * kBlockSize];
+	for (int i_e = 0; i_e < kBlockSize; i_e++) {
+	  sums[i_e] += (value * column[i_e]);
+	}
+      }
+      double *currSum = &output[i_o * kBlockSize];
+      double bias = m_biases[i_l][i_o];
+      for (int i_e = 0; i_e < nEvents; i_e++) currSum[i_e] = sums[i_e] + bias;
+      Activation::evaluateLayer(m_layerFunctions[i_l], currSum, nEvents,
+				currSum, (double*)NULL);
+    }
+  }
+  int nOutputs = getNOutputs();
+  const double *output = &m_blockResponses[m_nLayers-1][0];
+  for (int i_o = 0; i_o < nOutputs; i_o++) {
+    for (int i_e = 0; i_e < nEvents; i_e++) {
+      outputs[i_e * nOutputs + i_o] = output[i_o * kBlockSize + i_e];
+    }
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Evaluate one event into the per-event scratch.
+   @param vars - The nInputs input variables.
+   @param hasDerivatives - True to also store the activation derivatives.
+*/
+void SparseNetwork::forwardPass(const double *vars, bool hasDerivatives) {
+  for (int i_i = 0; i_i < m_layerSizes[0]; i_i++) {
+    double value = m_normalization.isActive() ?
+      m_normalization.transformValue(i_i, vars[i_i]) : vars[i_i];
+    double derivative;
+    Activation::evaluate(m_layerFunctions[0], value, value, derivative);
+    m_responses[0][i_i] = value;
+    m_derivatives[0][i_i] = derivative;
+  }
+  for (int i_l = 1; i_l < m_nLayers; i_l++) {
+    int nOut = m_layerSizes[i_l];
+    const int *rowOffsets = &m_rowOffsets[i_l][0];
+    const int *columns = m_columns[i_l].empty() ? NULL : &m_columns[i_l][0];
+    const double *values = m_values[i_l].empty() ? NULL : &m_values[i_l][0];
+    const double *input = &m_responses[i_l-1][0];
+    double *output = &m_responses[i_l][0];
+    for (int i_o = 0; i_o < nOut; i_o++) {
+      double currSum = 0.0;
+      for (int i_k = rowOffsets[i_o]; i_k < rowOffsets[i_o+1]; i_k++) {
+	currSum += (values[i_k] * input[columns[i_k]]);
+      }
+      output[i_o] = currSum + m_biases[i_l][i_o];
+    }
+    Activation::evaluateLayer(m_layerFunctions[i_l], output, nOut, output,
+			      hasDerivatives ? &m_derivatives[i_l][0] :
+			      (double*)NULL);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score a row-major block of events.
+   @param events - Row-major [nEvents x nInputs] matrix of input variables.
+   @param nEvents - The number of events.
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+*/
+void SparseNetwork::getBatchResponse(const double *events, int nEvents,
+				     double *outputs) {
+  int nInputs = getNInputs();
+  for (int i_b = 0; i_b < nEvents; i_b += kBlockSize) {
+    int nBlock = (nEvents - i_b < kBlockSize) ? (nEvents - i_b) : kBlockSize;
+    const double *blockEvents = &events[(long)i_b * nInputs];
+    for (int i_i = 0; i_i < nInputs; i_i++) {
+      for (int i_e = 0; i_e < nBlock; i_e++) {
+	m_column[i_e] = blockEvents[i_e * nInputs + i_i];
+      }
+      loadInputColumn(i_i, &m_column[0], nBlock);
+    }
+    forwardBlock(nBlock, &outputs[(long)i_b * getNOutputs()]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score all events of an EventBlock, reading the input variables column by
+   column.
+   @param block - The events.
+   @param outputs - Row-major [nEvents x nOutputs] buffer for the responses.
+*/
+void SparseNetwork::getBatchResponse(const EventBlock &block,
+				     double *outputs) {
+  if (block.getNVariables() != getNInputs()) {
+    std::cout << "SparseNetwork: ERROR! Wrong number of variables in block."
+	      << std::endl;
+    exit(0);
+  }
+  int nEvents = block.getNEvents();
+  for (int i_b = 0; i_b < nEvents; i_b += kBlockSize) {
+    int nBlock = (nEvents - i_b < kBlockSize) ? (nEvents - i_b) : kBlockSize;
+    for (int i_i = 0; i_i < getNInputs(); i_i++) {
+      block.getColumn(i_i, i_b, nBlock, &m_column[0]);
+      loadInputColumn(i_i, &m_column[0], nBlock);
+    }
+    forwardBlock(nBlock, &outputs[(long)i_b * getNOutputs()]);
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The fraction of the connections of the dense network that
+   survive.
+*/
+double SparseNetwork::getDensity() const {
+  if (m_nDenseConnections == 0) return 0.0;
+  return (getNConnections() / ((double)m_nDenseConnections));
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The fine-tuning learning rate.
+*/
+double SparseNetwork::getLearningRate() {
+  return m_rate;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The approximate number of bytes held by the network: the sparse
+   rows, the biases, and the gradient and evaluation scratch.
+*/
+size_t SparseNetwork::getMemoryFootprint() const {
+  size_t nBytes = sizeof(SparseNetwork);
+  for (int i_l = 0; i_l < m_nLayers; i_l++) {
+    nBytes += (m_rowOffsets[i_l].capacity() + m_columns[i_l].capacity())
+      * sizeof(int);
+    nBytes += (m_values[i_l].capacity() + m_biases[i_l].capacity() +
+	       m_valueGradients[i_l].capacity() +
+	       m_biasGradients[i_l].capacity() + m_responses[i_l].capacity() +
+	       m_derivatives[i_l].capacity() + m_deltas[i_l].capacity() +
+	       m_blockResponses[i_l].capacity()) * sizeof(double);
+  }
+  nBytes += m_column.capacity() * sizeof(double);
+  nBytes += m_layerSizes.capacity() * sizeof(int);
+  nBytes += m_layerFunctions.capacity() * sizeof(ActivationFunction);
+  return nBytes;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of events per fine-tuning weight update.
+*/
+int SparseNetwork::getMiniBatchSize() {
+  return m_miniBatchSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of surviving connections (excluding the biases).
+*/
+int SparseNetwork::getNConnections() const {
+  int nConnections = 0;
+  for (int i_l = 1; i_l < m_nLayers; i_l++) {
+    nConnections += (int)m_values[i_l].size();
+  }
+  return nConnections;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of input variables.
+*/
+int SparseNetwork::getNInputs() const {
+  return m_layerSizes[0];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   @returns - The number of output variables.
+*/
+int SparseNetwork::getNOutputs() const {
+  return m_layerSizes[m_nLayers-1];
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Score a single event.
+   @param vars - The getNInputs() input variables.
+   @param outputs - Buffer for the getNOutputs() responses of the output layer.
+*/
+void SparseNetwork::getNetworkResponse(const double *vars, double *outputs) {
+  forwardPass(vars, false);
+  for (int i_o = 0; i_o < getNOutputs(); i_o++) {
+    outputs[i_o] = m_responses[m_nLayers-1][i_o];
+  }
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Normalize and activate one input variable of a block into the input layer
+   of the block scratch.
+   @param variableIndex - The index of the input variable.
+   @param values - The raw values (overwritten).
+   @param nEvents - The number of events in the block.
+*/
+void SparseNetwork::loadInputColumn(int variableIndex, double *values,
+				    int nEvents) {
+  if (m_normalization.isActive()) {
+    m_normalization.transformColumn(variableIndex, values, nEvents, values);
+  }
+  Activation::evaluateLayer(m_layerFunctions[0], values, nEvents,
+			    &m_blockResponses[0][variableIndex * kBlockSize],
+			    (double*)NULL);
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Remove the surviving weights with a magnitude below a threshold, for
+   iterative pruning between rounds of fine-tuning. The gradient buffers are
+   released.
+   @param threshold - Weights with a magnitude below this are removed.
+   @returns - The number of connections removed.
+*/
+int SparseNetwork::prune(double threshold) {
+  int nRemoved = 0;
+  for (int i_l = 1; i_l < m_nLayers; i_l++) {
+    int nKept = 0;
+    for (int i_o = 0; i_o < m_layerSizes[i_l]; i_o++) {
+      int firstEntry = m_rowOffsets[i_l][i_o];
+      int lastEntry = m_rowOffsets[i_l][i_o+1];
+      m_rowOffsets[i_l][i_o] = nKept;
+      for (int i_k = firstEntry; i_k < lastEntry; i_k++) {
+	double value = m_values[i_l][i_k];
+	if (value == 0.0 || fabs(value) < threshold) {
+	  nRemoved++;
+	  continue;
+	}
+	m_columns[i_l][nKept] = m_columns[i_l][i_k];
+	m_values[i_l][nKept] = value;
+	nKept++;
+      }
+    }
+    m_rowOffsets[i_l][m_layerSizes[i_l]] = nKept;
+    m_columns[i_l].resize(nKept);
+    m_columns[i_l].shrink_to_fit();
+    m_values[i_l].resize(nKept);
+    m_values[i_l].shrink_to_fit();
+    std::vector<double>().swap(m_valueGradients[i_l]);
+    std::vector<double>().swap(m_biasGradients[i_l]);
+  }
+  m_nAccumulated = 0;
+  return nRemoved;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the fine-tuning learning rate.
+   @param rate - The learning rate.
+*/
+void SparseNetwork::setLearningRate(double rate) {
+  m_rate = rate;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Set the number of events per fine-tuning weight update.
+   @param miniBatchSize - The number of events per weight update.
+*/
+void SparseNetwork::setMiniBatchSize(int miniBatchSize) {
+  if (miniBatchSize < 1) {
+    std::cout << "SparseNetwork: ERROR! Mini-batch size must be positive."
+	      << std::endl;
+    exit(0);
+  }
+  m_miniBatchSize = miniBatchSize;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Fine-tune the surviving weights and the biases on a block of events with
+   one epoch of mini-batch gradient descent. The pruned connections stay
+   removed.
+   @param block - The events.
+   @returns - The mean (weighted) loss per event, measured before each update.
+*/
+double SparseNetwork::train(const EventBlock &block) {
+  int nEvents = block.getNEvents();
+  if (nEvents <= 0) return 0.0;
+  if (block.getNVariables() != getNInputs() ||
+      block.getNTargets() != getNOutputs()) {
+    std::cout << "SparseNetwork: ERROR! Block does not match the network."
+	      << std::endl;
+    exit(0);
+  }
+  std::vector<double> inputs(getNInputs());
+  std::vector<double> targets(getNOutputs());
+  double loss = 0.0;
+  for (int i_e = 0; i_e < nEvents; i_e++) {
+    block.getEvent(i_e, &inputs[0]);
+    block.getTargets(i_e, &targets[0]);
+    loss += accumulateGradient(&inputs[0], &targets[0], block.getWeight(i_e));
+    if (m_nAccumulated == m_miniBatchSize) applyGradient(m_nAccumulated);
+  }
+  applyGradient(m_nAccumulated);
+  return (loss / ((double)nEvents));
+}
@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: SparseNetwork.h                                                     //
+//  Class: SparseNetwork.cxx                                                  //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SparseNetwork_h
+#define SparseNetwork_h
+
+#include "Activation.h"
+#include "CompiledNetwork.h"
+#include "EventBlock.h"
+#include "InputNormalization.h"
+#include "NeuralNetwork.h"
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+class SparseNetwork
+{
+
+ public:
+
+  SparseNetwork(CompiledNetwork *network, double threshold);
+  SparseNetwork(NeuralNetwork *network, double threshold);
+  ~SparseNetwork();
+
+  // Accessors:
+  void getBatchResponse(const double *events, int nEvents, double *outputs);
+  void getBatchResponse(const EventBlock &block, double *outputs);
+  double getDensity() const;
+  double getLearningRate();
+  size_t getMemoryFootprint() const;
+  int getMiniBatchSize();
+  int getNConnections() const;
+  int getNInputs() const;
+  int getNOutputs() const;
+  void getNetworkResponse(const double *vars, double *outputs);
+
+  // Mutators:
+  double accumulateGradient(const double *vars, const double *targets,
+			    double weight);
+  void applyGradient(int nEvents);
+  void exportWeights(CompiledNetwork *network);
+  void exportWeights(NeuralNetwork *network);
+  int prune(double threshold);
+  void setLearningRate(double rate);
+  void setMiniBatchSize(int miniBatchSize);
+  double train(const EventBlock &block);
+
+ private:
+
+  // Private functions:
+  void build(CompiledNetwork *network, double threshold);
+  void forwardBlock(int nEvents, double *outputs);
+  void forwardPass(const double *vars, bool hasDerivatives);
+  void loadInputColumn(int variableIndex, double *values, int nEvents);
+
+  // Not copyable:
+  SparseNetwork(const SparseNetwork&);
+  SparseNetwork& operator=(const SparseNetwork&);
+
+  // Events per block of getBatchResponse():
+  static const int kBlockSize = 64;
+
+  // Topology (index 0 is the input layer):
+  int m_nLayers;
+  std::vector<int> m_layerSizes;
+  std::vector<ActivationFunction> m_layerFunctions;
+  std::vector<bool> m_layerHasBias;
+  InputNormalization m_normalization;
+  int m_nDenseConnections;
+
+  // Layer L >= 1 in compressed sparse rows: the surviving weights of node o
+  // are m_values[L][k] from input node m_columns[L][k], for k in
+  // [m_rowOffsets[L][o], m_rowOffsets[L][o+1]). Biases stay dense.
+  std::vector<std::vector<int> > m_rowOffsets;
+  std::vector<std::vector<int> > m_columns;
+  std::vector<std::vector<double> > m_values;
+  std::vector<std::vector<double> > m_biases;
+
+  // Fine-tuning: gradients parallel to m_values and m_biases:
+  std::vector<std::vector<double> > m_valueGradients;
+  std::vector<std::vector<double> > m_biasGradients;
+  double m_rate;
+  int m_miniBatchSize;
+  int m_nAccumulated;
+
+  // Per-event scratch of each layer:
+  std::vector<std::vector<double> > m_responses;
+  std::vector<std::vector<double> > m_derivatives;
+  std::vector<std::vector<double> > m_deltas;
+
+  // Node-major block scratch: node k of layer L, event e is at
+  // m_blockResponses[L][k * kBlockSize + e]:
+  std::vector<std::vector<double> > m_blockResponses;
+  std::vector<double> m_column;
+
+};
+
+#endif
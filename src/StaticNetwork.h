@@ -0,0 +1,251 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: StaticNetwork.h                                                     //
+//                                                                            //
+//  Author: Andrew Hard                                                       //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  A network with a topology that is fixed at compile time, for deployment.  //
+//  The layer sizes and the hidden activation function are template           //
+//  parameters, so all of the weights live in fixed-size std::arrays and the  //
+//  compiler can fully unroll and specialize the loops for each shape:        //
+//                                                                            //
+//    StaticNetwork<8, kSigmoid, 1, 16, 16> network(trainedNetwork);          //
+//                                                                            //
+//  is 8 inputs, two hidden sigmoid layers of 16 nodes and 1 linear output.   //
+//  The weights and the InputNormalization are loaded from a trained          //
+//  NeuralNetwork or CompiledNetwork with the same topology, and the          //
+//  responses are identical to theirs.                                        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef StaticNetwork_h
+#define StaticNetwork_h
+
+#include "Activation.h"
+#include "CompiledNetwork.h"
+#include "InputNormalization.h"
+#include "NeuralNetwork.h"
+#include <array>
+#include <iostream>
+#include <stdlib.h>
+
+/**
+   -----------------------------------------------------------------------------
+   Clamp a linear response to [-1,+1], exactly as Activation does for kLinear.
+*/
+inline double staticLinear(double sum) {
+  double value = (sum < 1.0) ? sum : 1.0;
+  return (value > -1.0) ? value : -1.0;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   The layers of a StaticNetwork after the input layer. Each StaticLayer holds
+   the weights of one hidden layer of N nodes fed by NPrev nodes, and the rest
+   of the network in m_next. The specialization below is the output layer.
+*/
+template <ActivationFunction HiddenFunction, int NPrev, int N, int... NRest>
+class StaticLayer
+{
+
+ public:
+
+  static const int kNParameters = N * NPrev + N
+    + StaticLayer<HiddenFunction, N, NRest...>::kNParameters;
+
+  StaticLayer() {
+    m_weights.fill(0.0);
+    m_biases.fill(0.0);
+  }
+
+  /**
+     ---------------------------------------------------------------------------
+     Copy the weights of this layer and all following layers.
+     @param network - The compiled network with a matching topology.
+     @param layerIndex - The index of this layer in the network.
+  */
+  void load(CompiledNetwork *network, int layerIndex) {
+    if (network->getLayerSize(layerIndex) != N ||
+	network->getLayerFunction(layerIndex) != HiddenFunction) {
+      std::cout << "StaticNetwork: ERROR! Layer " << layerIndex
+		<< " does not match the template." << std::endl;
+      exit(0);
+    }
+    const double *parameters = network->getParameterData();
+    const double *weights = &parameters[network->getWeightOffset(layerIndex)];
+    const double *biases = &parameters[network->getBiasOffset(layerIndex)];
+    for (int i_w = 0; i_w < N * NPrev; i_w++) m_weights[i_w] = weights[i_w];
+    for (int i_n = 0; i_n < N; i_n++) m_biases[i_n] = biases[i_n];
+    m_next.load(network, layerIndex + 1);
+  }
+
+  /**
+     ---------------------------------------------------------------------------
+     Propagate the responses of the previous layer to the output layer.
+     @param input - The NPrev responses of the previous layer.
+     @param output - Buffer for the responses of the output layer.
+  */
+  void evaluate(const double *input, double *output) const {
+    double response[N];
+    for (int i_n = 0; i_n < N; i_n++) {
+      double currSum = 0.0;
+      for (int i_p = 0; i_p < NPrev; i_p++) {
+	currSum += (m_weights[i_n * NPrev + i_p] * input[i_p]);
+      }
+      response[i_n] = currSum + m_biases[i_n];
+    }
+    Activation::evaluateLayer(HiddenFunction, response, N, response, NULL);
+    m_next.evaluate(response, output);
+  }
+
+ private:
+
+  // Row-major [N x NPrev] weights and N biases, as in CompiledNetwork:
+  std::array<double, N * NPrev> m_weights;
+  std::array<double, N> m_biases;
+  StaticLayer<HiddenFunction, N, NRest...> m_next;
+
+};
+
+/**
+   -----------------------------------------------------------------------------
+   The linear output layer of a StaticNetwork.
+*/
+template <ActivationFunction HiddenFunction, int NPrev, int N>
+class StaticLayer<HiddenFunction, NPrev, N>
+{
+
+ public:
+
+  static const int kNParameters = N * NPrev + N;
+
+  StaticLayer() {
+    m_weights.fill(0.0);
+    m_biases.fill(0.0);
+  }
+
+  void load(CompiledNetwork *network, int layerIndex) {
+    if (network->getLayerSize(layerIndex) != N ||
+	network->getLayerFunction(layerIndex) != kLinear) {
+      std::cout << "StaticNetwork: ERROR! Output layer does not match the "
+		<< "template." << std::endl;
+      exit(0);
+    }
+    const double *parameters = network->getParameterData();
+    const double *weights = &parameters[network->getWeightOffset(layerIndex)];
+    const double *biases = &parameters[network->getBiasOffset(layerIndex)];
+    for (int i_w = 0; i_w < N * NPrev; i_w++) m_weights[i_w] = weights[i_w];
+    for (int i_n = 0; i_n < N; i_n++) m_biases[i_n] = biases[i_n];
+  }
+
+  void evaluate(const double *input, double *output) const {
+    for (int i_n = 0; i_n < N; i_n++) {
+      double currSum = 0.0;
+      for (int i_p = 0; i_p < NPrev; i_p++) {
+	currSum += (m_weights[i_n * NPrev + i_p] * input[i_p]);
+      }
+      output[i_n] = staticLinear(currSum + m_biases[i_n]);
+    }
+  }
+
+ private:
+
+  std::array<double, N * NPrev> m_weights;
+  std::array<double, N> m_biases;
+
+};
+
+/**
+   -----------------------------------------------------------------------------
+   A network with NIn linear inputs, hidden layers of NHidden... nodes with the
+   HiddenFunction activation, and NOut linear outputs.
+*/
+template <int NIn, ActivationFunction HiddenFunction, int NOut, int... NHidden>
+class StaticNetwork
+{
+
+ public:
+
+  static const int kNInputs = NIn;
+  static const int kNOutputs = NOut;
+  static const int kNLayers = (int)sizeof...(NHidden) + 2;
+  static const int kNParameters
+    = StaticLayer<HiddenFunction, NIn, NHidden..., NOut>::kNParameters;
+
+  StaticNetwork() {}
+
+  StaticNetwork(NeuralNetwork *network) {
+    load(network);
+  }
+
+  StaticNetwork(CompiledNetwork *network) {
+    load(network);
+  }
+
+  /**
+     ---------------------------------------------------------------------------
+     Copy the weights and the input normalization of a trained network with
+     the same topology.
+     @param network - The compiled network.
+  */
+  void load(CompiledNetwork *network) {
+    if (network->getNLayers() != kNLayers || network->getNInputs() != NIn ||
+	network->getLayerFunction(0) != kLinear) {
+      std::cout << "StaticNetwork: ERROR! Network topology does not match the "
+		<< "template." << std::endl;
+      exit(0);
+    }
+    m_normalization = network->getInputNormalization();
+    m_layers.load(network, 1);
+  }
+
+  /**
+     ---------------------------------------------------------------------------
+     Copy the weights of a trained network with the same topology.
+     @param network - The network.
+  */
+  void load(NeuralNetwork *network) {
+    CompiledNetwork compiledNetwork(network);
+    load(&compiledNetwork);
+  }
+
+  /**
+     ---------------------------------------------------------------------------
+     Retrieve the network response. The raw variables are normalized (if the
+     network has an InputNormalization) before the input layer. No memory is
+     allocated.
+     @param vars - The NIn input variables.
+     @param outputs - Buffer for the NOut responses of the output layer.
+  */
+  void getNetworkResponse(const double *vars, double *outputs) const {
+    double input[NIn];
+    for (int i_i = 0; i_i < NIn; i_i++) {
+      double value = m_normalization.isActive() ?
+	m_normalization.transformValue(i_i, vars[i_i]) : vars[i_i];
+      input[i_i] = staticLinear(value);
+    }
+    m_layers.evaluate(input, outputs);
+  }
+
+  /**
+     ---------------------------------------------------------------------------
+     @param vars - The NIn input variables.
+     @returns - The NOut responses of the output layer.
+  */
+  std::array<double, NOut> getNetworkResponse(const std::array<double, NIn>
+					      &vars) const {
+    std::array<double, NOut> outputs;
+    getNetworkResponse(vars.data(), outputs.data());
+    return outputs;
+  }
+
+ private:
+
+  InputNormalization m_normalization;
+  StaticLayer<HiddenFunction, NIn, NHidden..., NOut> m_layers;
+
+};
+
+#endif
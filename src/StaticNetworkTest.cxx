@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+//  Name: StaticNetworkTest.cxx                                               //
+//                                                                            //
+//  Created: Andrew Hard                                                      //
+//  Email: ahard@cern.ch                                                      //
+//  Date: 17/10/2026                                                          //
+//                                                                            //
+//  Checks that a StaticNetwork gives exactly the responses of the            //
+//  CompiledNetwork it was loaded from, for a network without an              //
+//  InputNormalization and for networks with range and quantile               //
+//  normalizations of inputs far outside [-1,+1]. The program prints one line //
+//  per normalization and exits with status 1 if any response differs.        //
+//                                                                            //
+//  Usage: make test                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CompiledNetwork.h"
+#include "InputNormalization.h"
+#include "NeuralNetwork.h"
+#include "StaticNetwork.h"
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+const int nInputs = 10;
+
+/**
+   -----------------------------------------------------------------------------
+   Count the events for which a StaticNetwork and a CompiledNetwork differ.
+   @param type - The input normalization of the network.
+   @param events - Row-major [nEvents x nInputs] raw input variables.
+   @param nEvents - The number of events.
+   @returns - The number of events with a different response.
+*/
+int countDifferences(NormalizationType type, std::vector<double> &events,
+		     int nEvents) {
+  NeuralNetwork network(nInputs, 1, 2, 16);
+  network.randomizeNetworkWeights(1);
+  if (type != kNoNormalization) {
+    InputNormalization normalization(nInputs, type, 10);
+    for (int i_e = 0; i_e < nEvents; i_e++) {
+      normalization.fill(&events[i_e * nInputs]);
+    }
+    normalization.finalize();
+    network.setInputNormalization(normalization);
+  }
+  CompiledNetwork compiled(&network);
+  StaticNetwork<nInputs, kSigmoid, 1, 16, 16> staticNetwork(&compiled);
+  int nDifferent = 0;
+  for (int i_e = 0; i_e < nEvents; i_e++) {
+    double compiledOutput, staticOutput;
+    compiled.getNetworkResponse(&events[i_e * nInputs], &compiledOutput);
+    staticNetwork.getNetworkResponse(&events[i_e * nInputs], &staticOutput);
+    if (staticOutput != compiledOutput) nDifferent++;
+  }
+  return nDifferent;
+}
+
+/**
+   -----------------------------------------------------------------------------
+   Main method: compare the responses for each normalization.
+*/
+int main() {
+  const int nEvents = 1000;
+  std::vector<double> events(nEvents * nInputs);
+  srand(1);
+  for (int i_v = 0; i_v < nEvents * nInputs; i_v++) {
+    events[i_v] = (double)(rand() % 10000) / 100.0;
+  }
+  const NormalizationType types[] = {kNoNormalization, kRangeNormalization,
+				     kQuantileNormalization};
+  const char *names[] = {"none", "range", "quantile"};
+  bool passed = true;
+  for (int i_t = 0; i_t < 3; i_t++) {
+    int nDifferent = countDifferences(types[i_t], events, nEvents);
+    printf("StaticNetworkTest: normalization %s %d of %d events differ\n",
+	   names[i_t], nDifferent, nEvents);
+    if (nDifferent > 0) passed = false;
+  }
+  if (!passed) {
+    std::cout << "StaticNetworkTest: FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "StaticNetworkTest: passed" << std::endl;
+  return 0;
+}